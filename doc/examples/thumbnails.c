@@ -0,0 +1,285 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Seek-based thumbnail extraction example.
+ *
+ * Extracts one picture for each of a list of timestamps. For each timestamp
+ * the demuxer seeks to the preceding keyframe, and only the frames needed to
+ * reconstruct the target are decoded: non-reference frames before it are
+ * skipped. The pictures are scaled with a single reused SwsContext and saved
+ * as PPM files.
+ * @example thumbnails.c
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/parseutils.h>
+#include <libavutil/timestamp.h>
+#include <libswscale/swscale.h>
+
+static AVFormatContext *fmt_ctx;
+static AVCodecContext *dec_ctx;
+static AVStream *video_stream;
+static int keyframes_only;
+
+static int open_input(const char *filename)
+{
+    AVCodec *dec;
+    int ret;
+
+    if ((ret = avformat_open_input(&fmt_ctx, filename, NULL, NULL)) < 0) {
+        fprintf(stderr, "Could not open source file %s\n", filename);
+        return ret;
+    }
+    if ((ret = avformat_find_stream_info(fmt_ctx, NULL)) < 0) {
+        fprintf(stderr, "Could not find stream information\n");
+        return ret;
+    }
+
+    ret = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, &dec, 0);
+    if (ret < 0) {
+        fprintf(stderr, "Could not find a video stream in %s\n", filename);
+        return ret;
+    }
+    video_stream = fmt_ctx->streams[ret];
+
+    dec_ctx = avcodec_alloc_context3(dec);
+    if (!dec_ctx)
+        return AVERROR(ENOMEM);
+    if ((ret = avcodec_parameters_to_context(dec_ctx, video_stream->codecpar)) < 0)
+        return ret;
+    dec_ctx->pkt_timebase = video_stream->time_base;
+    if ((ret = avcodec_open2(dec_ctx, dec, NULL)) < 0) {
+        fprintf(stderr, "Could not open %s decoder\n", dec->name);
+        return ret;
+    }
+
+    /* discard the packets of all other streams in the demuxer already */
+    for (unsigned i = 0; i < fmt_ctx->nb_streams; i++)
+        if (fmt_ctx->streams[i] != video_stream)
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+
+    return 0;
+}
+
+/* Keep the frame if it reaches the target, otherwise remember it in last. */
+static int check_frame(AVFrame *frame, AVFrame *last, int64_t target)
+{
+    if (keyframes_only || frame->best_effort_timestamp >= target)
+        return 1;
+    av_frame_unref(last);
+    av_frame_move_ref(last, frame);
+    return 0;
+}
+
+/**
+ * Decode the first frame at or after target, in video stream time base,
+ * into frame. At the end of the stream the last decoded frame is used.
+ */
+static int decode_frame_at(AVFrame *frame, AVFrame *last, int64_t target)
+{
+    AVPacket pkt;
+    int ret;
+
+    av_frame_unref(last);
+
+    /* land on the last keyframe at or before the target, or, when there is
+     * none (e.g. the video starts after the container), on the first one
+     * after it; the frames before the target are skipped anyway */
+    ret = avformat_seek_file(fmt_ctx, video_stream->index, INT64_MIN, target, target, 0);
+    if (ret < 0)
+        ret = avformat_seek_file(fmt_ctx, video_stream->index, INT64_MIN, target, INT64_MAX, 0);
+    if (ret < 0)
+        return ret;
+    avcodec_flush_buffers(dec_ctx);
+
+    while ((ret = av_read_frame(fmt_ctx, &pkt)) >= 0) {
+        if (pkt.stream_index != video_stream->index) {
+            av_packet_unref(&pkt);
+            continue;
+        }
+
+        /* nothing refers to non-reference frames, so those before the
+         * target need not be decoded */
+        if (keyframes_only)
+            dec_ctx->skip_frame = AVDISCARD_NONKEY;
+        else if (pkt.pts != AV_NOPTS_VALUE && pkt.pts < target)
+            dec_ctx->skip_frame = AVDISCARD_NONREF;
+        else
+            dec_ctx->skip_frame = AVDISCARD_DEFAULT;
+
+        ret = avcodec_send_packet(dec_ctx, &pkt);
+        av_packet_unref(&pkt);
+        if (ret < 0 && ret != AVERROR_INVALIDDATA)
+            return ret;
+
+        while ((ret = avcodec_receive_frame(dec_ctx, frame)) >= 0)
+            if (check_frame(frame, last, target))
+                return 0;
+        if (ret != AVERROR(EAGAIN))
+            return ret;
+    }
+    if (ret != AVERROR_EOF)
+        return ret;
+
+    /* drain the decoder */
+    avcodec_send_packet(dec_ctx, NULL);
+    while ((ret = avcodec_receive_frame(dec_ctx, frame)) >= 0)
+        if (check_frame(frame, last, target))
+            return 0;
+    if (!last->buf[0])
+        return AVERROR_EOF;
+    av_frame_move_ref(frame, last);
+    return 0;
+}
+
+static int save_ppm(const char *filename, uint8_t *data, int linesize, int w, int h)
+{
+    FILE *f = fopen(filename, "wb");
+
+    if (!f) {
+        fprintf(stderr, "Could not open %s\n", filename);
+        return AVERROR(errno);
+    }
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    for (int y = 0; y < h; y++)
+        fwrite(data + y * linesize, 1, w * 3, f);
+    fclose(f);
+    return 0;
+}
+
+static int compare_ts(const void *a, const void *b)
+{
+    int64_t ta = *(const int64_t *)a, tb = *(const int64_t *)b;
+    return (ta > tb) - (ta < tb);
+}
+
+int main(int argc, char **argv)
+{
+    struct SwsContext *sws_ctx = NULL;
+    AVFrame *frame = NULL, *last = NULL;
+    uint8_t *dst_data[4] = { NULL };
+    int dst_linesize[4];
+    int dst_w, dst_h, nb_times, i, ret;
+    int64_t *times = NULL, start_time;
+    const char *src_filename, *dst_prefix;
+    char dst_filename[1024];
+
+    if (argc > 1 && !strcmp(argv[1], "-k")) {
+        keyframes_only = 1;
+        argv++;
+        argc--;
+    }
+    if (argc < 5) {
+        fprintf(stderr, "usage: %s [-k] input_file output_prefix WxH time [time...]\n"
+                "Save a picture of input_file at each time, in any ffmpeg duration\n"
+                "syntax, to output_prefix-<n>.ppm, scaled to WxH.\n"
+                "With -k, the keyframe preceding each time is used instead,\n"
+                "which needs a single frame to be decoded per picture.\n",
+                argv[0]);
+        return 1;
+    }
+    src_filename = argv[1];
+    dst_prefix   = argv[2];
+    if (av_parse_video_size(&dst_w, &dst_h, argv[3]) < 0) {
+        fprintf(stderr, "Invalid size '%s', must be in the form WxH or a valid size abbreviation\n",
+                argv[3]);
+        return 1;
+    }
+
+    nb_times = argc - 4;
+    times = av_malloc_array(nb_times, sizeof(*times));
+    if (!times)
+        return 1;
+    for (i = 0; i < nb_times; i++) {
+        if (av_parse_time(&times[i], argv[i + 4], 1) < 0) {
+            fprintf(stderr, "Invalid time '%s'\n", argv[i + 4]);
+            ret = 1;
+            goto end;
+        }
+    }
+    /* visiting the times in order keeps the seeks going forward */
+    qsort(times, nb_times, sizeof(*times), compare_ts);
+
+    if ((ret = open_input(src_filename)) < 0)
+        goto end;
+
+    frame = av_frame_alloc();
+    last  = av_frame_alloc();
+    if (!frame || !last) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = av_image_alloc(dst_data, dst_linesize, dst_w, dst_h, AV_PIX_FMT_RGB24, 1)) < 0)
+        goto end;
+
+    start_time = fmt_ctx->start_time != AV_NOPTS_VALUE ? fmt_ctx->start_time : 0;
+    for (i = 0; i < nb_times; i++) {
+        int64_t target = av_rescale_q(start_time + times[i], AV_TIME_BASE_Q,
+                                      video_stream->time_base);
+
+        if ((ret = decode_frame_at(frame, last, target)) < 0) {
+            fprintf(stderr, "Could not decode a frame at %s\n",
+                    av_ts2timestr(target, &video_stream->time_base));
+            goto end;
+        }
+
+        /* the context is only recreated if the source properties change */
+        sws_ctx = sws_getCachedContext(sws_ctx, frame->width, frame->height, frame->format,
+                                       dst_w, dst_h, AV_PIX_FMT_RGB24,
+                                       SWS_BICUBIC, NULL, NULL, NULL);
+        if (!sws_ctx) {
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+        sws_scale(sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
+                  0, frame->height, dst_data, dst_linesize);
+
+        snprintf(dst_filename, sizeof(dst_filename), "%s-%d.ppm", dst_prefix, i + 1);
+        if ((ret = save_ppm(dst_filename, dst_data[0], dst_linesize[0], dst_w, dst_h)) < 0)
+            goto end;
+        printf("%s: pts %s\n", dst_filename,
+               av_ts2timestr(frame->best_effort_timestamp, &video_stream->time_base));
+        av_frame_unref(frame);
+    }
+
+end:
+    sws_freeContext(sws_ctx);
+    av_freep(&dst_data[0]);
+    av_frame_free(&frame);
+    av_frame_free(&last);
+    avcodec_free_context(&dec_ctx);
+    avformat_close_input(&fmt_ctx);
+    av_free(times);
+
+    if (ret < 0) {
+        fprintf(stderr, "Error occurred: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return ret;
+}
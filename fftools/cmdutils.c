@@ -124,12 +124,20 @@ void init_dynload(void)
 }
 
 static void (*program_exit)(int ret);
+static jmp_buf *program_exit_jmp;
+static int *program_exit_ret;
 
 void register_exit(void (*cb)(int ret))
 {
     program_exit = cb;
 }
 
+void register_exit_jmp(jmp_buf *env, int *ret)
+{
+    program_exit_jmp = env;
+    program_exit_ret = ret;
+}
+
 void exit_program(int ret)
 {
     if (program_exit)
@@ -141,6 +149,11 @@ void exit_program(int ret)
      */
     printf("FFMPEG_END\n");
 
+    if (program_exit_jmp) {
+        *program_exit_ret = ret;
+        longjmp(*program_exit_jmp, 1);
+    }
+
     exit(ret);
 }
 
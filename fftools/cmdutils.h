@@ -22,6 +22,7 @@
 #ifndef FFTOOLS_CMDUTILS_H
 #define FFTOOLS_CMDUTILS_H
 
+#include <setjmp.h>
 #include <stdint.h>
 
 #include "config.h"
@@ -61,6 +62,13 @@ void register_exit(void (*cb)(int ret));
  */
 void exit_program(int ret) av_noreturn;
 
+/**
+ * Make exit_program() jump back to env instead of terminating the process.
+ * The exit code is stored in *ret before the jump. Pass NULL to restore the
+ * default behaviour.
+ */
+void register_exit_jmp(jmp_buf *env, int *ret);
+
 /**
  * Initialize dynamic library loading
  */
@@ -63,6 +63,7 @@
 #include "libavutil/time.h"
 #include "libavutil/thread.h"
 #include "libavutil/threadmessage.h"
+#include "libavutil/threadpool.h"
 #include "libavcodec/mathops.h"
 #include "libavformat/os_support.h"
 
@@ -142,6 +143,16 @@ static int want_sdp = 1;
 static BenchmarkTimeStamps current_time;
 AVIOContext *progress_avio = NULL;
 
+static int64_t report_last_time = -1;
+static int qp_histogram[52];
+
+static void (*progress_cb)(const FFmpegProgress *progress, void *opaque);
+static void *progress_cb_opaque;
+static int64_t progress_cb_interval = 500000;
+static int64_t progress_cb_last_time = -1;
+static FFmpegStreamProgress *progress_streams;
+static int *progress_demux_queue;
+
 static uint8_t *subtitle_out;
 
 InputStream **input_streams = NULL;
@@ -166,6 +177,9 @@ static int restore_tty;
 
 #if HAVE_THREADS
 static void free_input_threads(void);
+static void free_encoder_thread(OutputStream *ost);
+static void free_filter_thread(FilterGraph *fg);
+static void free_decoder_thread(InputStream *ist);
 #endif
 
 /* sub2video hack:
@@ -499,6 +513,9 @@ static void ffmpeg_cleanup(int ret)
 
     for (i = 0; i < nb_filtergraphs; i++) {
         FilterGraph *fg = filtergraphs[i];
+#if HAVE_THREADS
+        free_filter_thread(fg);
+#endif
         avfilter_graph_free(&fg->graph);
         for (j = 0; j < fg->nb_inputs; j++) {
             InputFilter *ifilter = fg->inputs[j];
@@ -563,6 +580,9 @@ static void ffmpeg_cleanup(int ret)
         if (!ost)
             continue;
 
+#if HAVE_THREADS
+        free_encoder_thread(ost);
+#endif
         av_bsf_free(&ost->bsf_ctx);
 
         av_frame_free(&ost->filtered_frame);
@@ -604,6 +624,9 @@ static void ffmpeg_cleanup(int ret)
     for (i = 0; i < nb_input_streams; i++) {
         InputStream *ist = input_streams[i];
 
+#if HAVE_THREADS
+        free_decoder_thread(ist);
+#endif
         av_frame_free(&ist->decoded_frame);
         av_frame_free(&ist->filter_frame);
         av_dict_free(&ist->decoder_opts);
@@ -623,8 +646,13 @@ static void ffmpeg_cleanup(int ret)
             av_log(NULL, AV_LOG_ERROR,
                    "Error closing vstats file, loss of information possible: %s\n",
                    av_err2str(AVERROR(errno)));
+        vstats_file = NULL;
     }
+    avio_closep(&progress_avio);
     av_freep(&vstats_filename);
+    av_freep(&progress_streams);
+    av_freep(&progress_demux_queue);
+    av_thread_pool_uninit();
 
     av_freep(&input_streams);
     av_freep(&input_files);
@@ -896,6 +924,377 @@ static int check_recording_time(OutputStream *ost)
     return 1;
 }
 
+#if HAVE_THREADS
+static void *encoder_thread(void *arg)
+{
+    OutputStream *ost = arg;
+    AVCodecContext *enc = ost->enc_ctx;
+    int64_t last_pts = AV_NOPTS_VALUE;
+    AVFrame *frame;
+    int ret;
+
+    while ((ret = av_thread_message_queue_recv(ost->enc_queue, &frame, 0)) >= 0) {
+        /* a NULL frame flushes the encoder */
+        if (frame)
+            last_pts = frame->pts;
+        ret = avcodec_send_frame(enc, frame);
+        av_frame_free(&frame);
+
+        while (ret >= 0) {
+            AVPacket pkt;
+
+            av_init_packet(&pkt);
+            pkt.data = NULL;
+            pkt.size = 0;
+
+            ret = avcodec_receive_packet(enc, &pkt);
+            if (ret < 0)
+                break;
+
+            /* if two pass, output log */
+            if (ost->logfile && enc->stats_out)
+                fprintf(ost->logfile, "%s", enc->stats_out);
+
+            if (enc->codec_type == AVMEDIA_TYPE_VIDEO &&
+                pkt.pts == AV_NOPTS_VALUE && !(enc->codec->capabilities & AV_CODEC_CAP_DELAY))
+                pkt.pts = last_pts;
+
+            pthread_mutex_lock(&ost->enc_pkt_lock);
+            if (!av_fifo_space(ost->enc_pkt_fifo))
+                ret = av_fifo_realloc2(ost->enc_pkt_fifo,
+                                       2 * av_fifo_size(ost->enc_pkt_fifo));
+            if (ret >= 0)
+                av_fifo_generic_write(ost->enc_pkt_fifo, &pkt, sizeof(pkt), NULL);
+            pthread_mutex_unlock(&ost->enc_pkt_lock);
+            if (ret < 0)
+                av_packet_unref(&pkt);
+        }
+        if (ret != AVERROR(EAGAIN))
+            break;
+    }
+
+    ost->enc_thread_ret = ret;
+    av_thread_message_queue_set_err_send(ost->enc_queue, ret < 0 ? ret : AVERROR_EOF);
+    return NULL;
+}
+
+static void free_encoder_frame(void *msg)
+{
+    av_frame_free(msg);
+}
+
+static int init_encoder_thread(OutputStream *ost)
+{
+    int ret;
+
+    ret = av_thread_message_queue_alloc(&ost->enc_queue, 8, sizeof(AVFrame *));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(ost->enc_queue, free_encoder_frame);
+
+    ost->enc_pkt_fifo = av_fifo_alloc(8 * sizeof(AVPacket));
+    if (!ost->enc_pkt_fifo) {
+        av_thread_message_queue_free(&ost->enc_queue);
+        return AVERROR(ENOMEM);
+    }
+    pthread_mutex_init(&ost->enc_pkt_lock, NULL);
+
+    if ((ret = pthread_create(&ost->enc_thread, NULL, encoder_thread, ost))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        pthread_mutex_destroy(&ost->enc_pkt_lock);
+        av_fifo_freep(&ost->enc_pkt_fifo);
+        av_thread_message_queue_free(&ost->enc_queue);
+        return AVERROR(ret);
+    }
+
+    return 0;
+}
+
+/*
+ * Stop the encoder thread of ost. If flush is set, the encoder is drained
+ * first and its remaining packets are kept for reap_encoder_thread(),
+ * otherwise pending frames and packets are discarded.
+ */
+static int stop_encoder_thread(OutputStream *ost, int flush)
+{
+    AVFrame *frame = NULL;
+
+    if (flush) {
+        av_thread_message_queue_send(ost->enc_queue, &frame, 0);
+    } else {
+        av_thread_message_flush(ost->enc_queue);
+        av_thread_message_queue_set_err_recv(ost->enc_queue, AVERROR_EOF);
+    }
+    pthread_join(ost->enc_thread, NULL);
+    av_thread_message_queue_free(&ost->enc_queue);
+
+    return ost->enc_thread_ret == AVERROR_EOF ? 0 : ost->enc_thread_ret;
+}
+
+static void free_encoder_thread(OutputStream *ost)
+{
+    AVPacket pkt;
+
+    if (ost->enc_queue)
+        stop_encoder_thread(ost, 0);
+    if (!ost->enc_pkt_fifo)
+        return;
+
+    while (av_fifo_size(ost->enc_pkt_fifo)) {
+        av_fifo_generic_read(ost->enc_pkt_fifo, &pkt, sizeof(pkt), NULL);
+        av_packet_unref(&pkt);
+    }
+    av_fifo_freep(&ost->enc_pkt_fifo);
+    pthread_mutex_destroy(&ost->enc_pkt_lock);
+}
+
+static int send_frame_to_encoder_thread(OutputStream *ost, AVFrame *frame)
+{
+    AVFrame *clone = av_frame_clone(frame);
+    int ret;
+
+    if (!clone)
+        return AVERROR(ENOMEM);
+    ret = av_thread_message_queue_send(ost->enc_queue, &clone, 0);
+    if (ret < 0) {
+        av_frame_free(&clone);
+        return ost->enc_thread_ret < 0 ? ost->enc_thread_ret : ret;
+    }
+    return 0;
+}
+
+/*
+ * Send the packets returned so far by the encoder thread of ost to the
+ * output.
+ */
+static void reap_encoder_thread(OutputFile *of, OutputStream *ost)
+{
+    AVCodecContext *enc = ost->enc_ctx;
+    AVPacket pkt;
+    int pkt_size;
+
+    while (1) {
+        pthread_mutex_lock(&ost->enc_pkt_lock);
+        if (!av_fifo_size(ost->enc_pkt_fifo)) {
+            pthread_mutex_unlock(&ost->enc_pkt_lock);
+            break;
+        }
+        av_fifo_generic_read(ost->enc_pkt_fifo, &pkt, sizeof(pkt), NULL);
+        pthread_mutex_unlock(&ost->enc_pkt_lock);
+
+        if (ost->finished & MUXER_FINISHED) {
+            av_packet_unref(&pkt);
+            continue;
+        }
+
+        if (debug_ts) {
+            av_log(NULL, AV_LOG_INFO, "encoder -> type:%s "
+                   "pkt_pts:%s pkt_pts_time:%s pkt_dts:%s pkt_dts_time:%s\n",
+                   av_get_media_type_string(enc->codec_type),
+                   av_ts2str(pkt.pts), av_ts2timestr(pkt.pts, &enc->time_base),
+                   av_ts2str(pkt.dts), av_ts2timestr(pkt.dts, &enc->time_base));
+        }
+
+        av_packet_rescale_ts(&pkt, enc->time_base, ost->mux_timebase);
+        pkt_size = pkt.size;
+        output_packet(of, &pkt, ost, 0);
+        if (enc->codec_type == AVMEDIA_TYPE_VIDEO && vstats_filename)
+            do_video_stats(ost, pkt_size);
+    }
+}
+#endif
+
+#if HAVE_THREADS
+/* A message to the filter thread: a frame, or with frame NULL the EOF of
+ * the graph input at pts. */
+typedef struct FilterThreadMessage {
+    AVFrame *frame;
+    int64_t  pts;
+} FilterThreadMessage;
+
+static void *filter_thread(void *arg)
+{
+    FilterGraph *fg = arg;
+    FilterThreadMessage msg;
+    AVFrame *frame;
+    int ret, err;
+
+    while (av_thread_message_queue_recv(fg->filter_queue, &msg, 0) >= 0) {
+        /* the graph may have been reconfigured since the previous message */
+        AVFilterContext *src  = fg->inputs[0]->filter;
+        AVFilterContext *sink = fg->outputs[0]->filter;
+        int eof = !msg.frame;
+
+        if (msg.frame)
+            ret = av_buffersrc_add_frame_flags(src, msg.frame, AV_BUFFERSRC_FLAG_PUSH);
+        else
+            ret = av_buffersrc_close(src, msg.pts, AV_BUFFERSRC_FLAG_PUSH);
+        av_frame_free(&msg.frame);
+
+        while (1) {
+            if (!(frame = av_frame_alloc())) {
+                err = AVERROR(ENOMEM);
+                break;
+            }
+            err = av_buffersink_get_frame_flags(sink, frame, 0);
+            if (err < 0) {
+                av_frame_free(&frame);
+                break;
+            }
+
+            pthread_mutex_lock(&fg->filter_frame_lock);
+            if (!av_fifo_space(fg->filter_frame_fifo))
+                err = av_fifo_realloc2(fg->filter_frame_fifo,
+                                       2 * av_fifo_size(fg->filter_frame_fifo));
+            if (err >= 0)
+                av_fifo_generic_write(fg->filter_frame_fifo, &frame, sizeof(frame), NULL);
+            pthread_cond_signal(&fg->filter_frame_cond);
+            pthread_mutex_unlock(&fg->filter_frame_lock);
+            if (err < 0)
+                av_frame_free(&frame);
+        }
+        if (err != AVERROR(EAGAIN) && err != AVERROR_EOF)
+            av_log(NULL, AV_LOG_WARNING,
+                   "Error in av_buffersink_get_frame_flags(): %s\n", av_err2str(err));
+
+        pthread_mutex_lock(&fg->filter_frame_lock);
+        if (ret < 0 && ret != AVERROR_EOF && !fg->filter_thread_ret)
+            fg->filter_thread_ret = ret;
+        /* the input EOF always finishes the output, even if closing failed */
+        if (err == AVERROR_EOF || eof)
+            fg->filter_out_eof = 1;
+        fg->filter_done++;
+        pthread_cond_signal(&fg->filter_frame_cond);
+        pthread_mutex_unlock(&fg->filter_frame_lock);
+    }
+
+    return NULL;
+}
+
+static void free_filter_message(void *msg)
+{
+    av_frame_free(&((FilterThreadMessage *)msg)->frame);
+}
+
+static int init_filter_thread(FilterGraph *fg)
+{
+    int ret;
+
+    ret = av_thread_message_queue_alloc(&fg->filter_queue, 8, sizeof(FilterThreadMessage));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(fg->filter_queue, free_filter_message);
+
+    fg->filter_frame_fifo = av_fifo_alloc(8 * sizeof(AVFrame *));
+    if (!fg->filter_frame_fifo) {
+        av_thread_message_queue_free(&fg->filter_queue);
+        return AVERROR(ENOMEM);
+    }
+    pthread_mutex_init(&fg->filter_frame_lock, NULL);
+    pthread_cond_init(&fg->filter_frame_cond, NULL);
+    fg->filter_thread_ret = 0;
+    fg->filter_sent = fg->filter_done = 0;
+    fg->filter_out_eof = 0;
+
+    if ((ret = pthread_create(&fg->filter_thread, NULL, filter_thread, fg))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        pthread_cond_destroy(&fg->filter_frame_cond);
+        pthread_mutex_destroy(&fg->filter_frame_lock);
+        av_fifo_freep(&fg->filter_frame_fifo);
+        av_thread_message_queue_free(&fg->filter_queue);
+        return AVERROR(ret);
+    }
+
+    return 0;
+}
+
+static void free_filter_thread(FilterGraph *fg)
+{
+    AVFrame *frame;
+
+    if (!fg->filter_queue)
+        return;
+
+    av_thread_message_flush(fg->filter_queue);
+    av_thread_message_queue_set_err_recv(fg->filter_queue, AVERROR_EOF);
+    pthread_join(fg->filter_thread, NULL);
+    av_thread_message_queue_free(&fg->filter_queue);
+
+    while (av_fifo_size(fg->filter_frame_fifo)) {
+        av_fifo_generic_read(fg->filter_frame_fifo, &frame, sizeof(frame), NULL);
+        av_frame_free(&frame);
+    }
+    av_fifo_freep(&fg->filter_frame_fifo);
+    pthread_cond_destroy(&fg->filter_frame_cond);
+    pthread_mutex_destroy(&fg->filter_frame_lock);
+}
+
+/*
+ * Wait until the filter thread of fg has processed everything sent to it,
+ * after which the main thread may touch the graph until the next message.
+ */
+static void sync_filter_thread(FilterGraph *fg)
+{
+    pthread_mutex_lock(&fg->filter_frame_lock);
+    while (fg->filter_done < fg->filter_sent)
+        pthread_cond_wait(&fg->filter_frame_cond, &fg->filter_frame_lock);
+    pthread_mutex_unlock(&fg->filter_frame_lock);
+}
+
+/*
+ * Send frame to the filter thread of fg, taking its reference. A NULL frame
+ * closes the graph input at pts.
+ */
+static int send_frame_to_filter_thread(FilterGraph *fg, AVFrame *frame, int64_t pts)
+{
+    FilterThreadMessage msg = { NULL, pts };
+    int ret;
+
+    pthread_mutex_lock(&fg->filter_frame_lock);
+    ret = fg->filter_thread_ret;
+    pthread_mutex_unlock(&fg->filter_frame_lock);
+    if (ret < 0)
+        return ret;
+
+    if (frame) {
+        if (!(msg.frame = av_frame_alloc()))
+            return AVERROR(ENOMEM);
+        av_frame_move_ref(msg.frame, frame);
+    }
+    ret = av_thread_message_queue_send(fg->filter_queue, &msg, 0);
+    if (ret < 0) {
+        av_frame_free(&msg.frame);
+        return ret;
+    }
+    fg->filter_sent++;
+
+    return 0;
+}
+
+/*
+ * Get a frame returned by the filter thread of fg, like
+ * av_buffersink_get_frame_flags() with AV_BUFFERSINK_FLAG_NO_REQUEST.
+ */
+static int reap_filter_thread(FilterGraph *fg, AVFrame *frame)
+{
+    AVFrame *tmp;
+    int ret = 0;
+
+    pthread_mutex_lock(&fg->filter_frame_lock);
+    if (av_fifo_size(fg->filter_frame_fifo))
+        av_fifo_generic_read(fg->filter_frame_fifo, &tmp, sizeof(tmp), NULL);
+    else
+        ret = fg->filter_out_eof ? AVERROR_EOF : AVERROR(EAGAIN);
+    pthread_mutex_unlock(&fg->filter_frame_lock);
+    if (ret < 0)
+        return ret;
+
+    av_frame_move_ref(frame, tmp);
+    av_frame_free(&tmp);
+    return 0;
+}
+#endif
+
 static void do_audio_out(OutputFile *of, OutputStream *ost,
                          AVFrame *frame)
 {
@@ -925,6 +1324,16 @@ static void do_audio_out(OutputFile *of, OutputStream *ost,
                enc->time_base.num, enc->time_base.den);
     }
 
+#if HAVE_THREADS
+    if (ost->enc_queue) {
+        ret = send_frame_to_encoder_thread(ost, frame);
+        if (ret < 0)
+            goto error;
+        reap_encoder_thread(of, ost);
+        return;
+    }
+#endif
+
     ret = avcodec_send_frame(enc, frame);
     if (ret < 0)
         goto error;
@@ -1274,6 +1683,19 @@ static void do_video_out(OutputFile *of,
 
         ost->frames_encoded++;
 
+#if HAVE_THREADS
+        if (ost->enc_queue) {
+            ret = send_frame_to_encoder_thread(ost, in_picture);
+            if (ret < 0)
+                goto error;
+            av_frame_remove_side_data(in_picture, AV_FRAME_DATA_A53_CC);
+            reap_encoder_thread(of, ost);
+            ost->sync_opts++;
+            ost->frame_number++;
+            continue;
+        }
+#endif
+
         ret = avcodec_send_frame(enc, in_picture);
         if (ret < 0)
             goto error;
@@ -1444,6 +1866,11 @@ static int reap_filters(int flush)
 
         while (1) {
             double float_pts = AV_NOPTS_VALUE; // this is identical to filtered_frame.pts but with higher precision
+#if HAVE_THREADS
+            if (ost->filter->graph->filter_queue)
+                ret = reap_filter_thread(ost->filter->graph, filtered_frame);
+            else
+#endif
             ret = av_buffersink_get_frame_flags(filter, filtered_frame,
                                                AV_BUFFERSINK_FLAG_NO_REQUEST);
             if (ret < 0) {
@@ -1631,6 +2058,105 @@ static void print_final_stats(int64_t total_size)
     }
 }
 
+void ffmpeg_set_progress_callback(void (*cb)(const FFmpegProgress *progress, void *opaque),
+                                  void *opaque, int interval_ms)
+{
+    progress_cb          = cb;
+    progress_cb_opaque   = opaque;
+    progress_cb_interval = FFMAX(interval_ms, 0) * 1000LL;
+}
+
+static void report_progress(int is_last_report, int64_t timer_start, int64_t cur_time)
+{
+    FFmpegProgress p = { 0 };
+    AVFormatContext *oc;
+    int64_t pts = INT64_MIN + 1;
+    int i, vid = 0, nb_frames_drop_pending = 0;
+    float t;
+
+    if (!progress_cb)
+        return;
+
+    if (!is_last_report) {
+        if (progress_cb_last_time == -1) {
+            progress_cb_last_time = cur_time;
+            return;
+        }
+        if (cur_time - progress_cb_last_time < progress_cb_interval)
+            return;
+        progress_cb_last_time = cur_time;
+    }
+
+    if (av_reallocp_array(&progress_streams, nb_output_streams, sizeof(*progress_streams)) < 0 ||
+        av_reallocp_array(&progress_demux_queue, nb_input_files, sizeof(*progress_demux_queue)) < 0)
+        return;
+
+    t  = (cur_time - timer_start) / 1000000.0;
+    oc = output_files[0]->ctx;
+
+    p.frame = p.q = p.fps = -1;
+    p.total_size = avio_size(oc->pb);
+    if (p.total_size <= 0)
+        p.total_size = avio_tell(oc->pb);
+
+    for (i = 0; i < nb_output_streams; i++) {
+        OutputStream *ost = output_streams[i];
+        FFmpegStreamProgress *sp = &progress_streams[i];
+
+        sp->file_index = ost->file_index;
+        sp->index      = ost->index;
+        sp->frames     = ost->frame_number;
+        sp->q          = ost->stream_copy ? -1 : ost->quality / (float)FF_QP2LAMBDA;
+        sp->mux_queue  = ost->muxing_queue ? av_fifo_size(ost->muxing_queue) / sizeof(AVPacket) : 0;
+        sp->enc_queue  = 0;
+#if HAVE_THREADS
+        if (ost->enc_queue)
+            sp->enc_queue = av_thread_message_queue_nb_elems(ost->enc_queue);
+#endif
+
+        if (!vid && ost->enc_ctx->codec_type == AVMEDIA_TYPE_VIDEO) {
+            p.frame = ost->frame_number;
+            p.fps   = t > 1 ? p.frame / t : 0;
+            p.q     = sp->q;
+            vid     = 1;
+        }
+        if (av_stream_get_end_pts(ost->st) != AV_NOPTS_VALUE)
+            pts = FFMAX(pts, av_rescale_q(av_stream_get_end_pts(ost->st),
+                                          ost->st->time_base, AV_TIME_BASE_Q));
+        /* print_report() only adds these to nb_frames_drop after us */
+        if (is_last_report)
+            nb_frames_drop_pending += ost->last_dropped;
+    }
+
+    for (i = 0; i < nb_input_files; i++) {
+        progress_demux_queue[i] = 0;
+#if HAVE_THREADS
+        if (input_files[i]->in_thread_queue)
+            progress_demux_queue[i] = av_thread_message_queue_nb_elems(input_files[i]->in_thread_queue);
+#endif
+    }
+
+    if (p.total_size < 0)
+        p.total_size = -1;
+    if (pts == INT64_MIN + 1) {
+        p.out_time_us = p.bitrate = p.speed = -1;
+    } else {
+        p.out_time_us = pts;
+        p.bitrate     = pts && p.total_size >= 0 ? p.total_size * 8 / (pts / 1000.0) : -1;
+        p.speed       = t != 0.0 ? (double)pts / AV_TIME_BASE / t : -1;
+    }
+    p.dup_frames  = nb_frames_dup;
+    p.drop_frames = nb_frames_drop + nb_frames_drop_pending;
+    p.maxrss      = getmaxrss();
+    p.is_last     = is_last_report;
+    p.nb_inputs   = nb_input_files;
+    p.demux_queue = progress_demux_queue;
+    p.nb_streams  = nb_output_streams;
+    p.streams     = progress_streams;
+
+    progress_cb(&p, progress_cb_opaque);
+}
+
 static void print_report(int is_last_report, int64_t timer_start, int64_t cur_time)
 {
     AVBPrint buf, buf_script;
@@ -1642,24 +2168,24 @@ static void print_report(int is_last_report, int64_t timer_start, int64_t cur_ti
     double bitrate;
     double speed;
     int64_t pts = INT64_MIN + 1;
-    static int64_t last_time = -1;
-    static int qp_histogram[52];
     int hours, mins, secs, us;
     const char *hours_sign;
     int ret;
     float t;
 
+    report_progress(is_last_report, timer_start, cur_time);
+
     if (!print_stats && !is_last_report && !progress_avio)
         return;
 
     if (!is_last_report) {
-        if (last_time == -1) {
-            last_time = cur_time;
+        if (report_last_time == -1) {
+            report_last_time = cur_time;
             return;
         }
-        if ((cur_time - last_time) < 500000)
+        if ((cur_time - report_last_time) < 500000)
             return;
-        last_time = cur_time;
+        report_last_time = cur_time;
     }
 
     t = (cur_time-timer_start) / 1000000.0;
@@ -1896,6 +2422,23 @@ static void flush_encoders(void)
         if (enc->codec_type != AVMEDIA_TYPE_VIDEO && enc->codec_type != AVMEDIA_TYPE_AUDIO)
             continue;
 
+#if HAVE_THREADS
+        if (ost->enc_queue) {
+            AVPacket pkt = { 0 };
+
+            ret = stop_encoder_thread(ost, 1);
+            if (ret < 0) {
+                av_log(NULL, AV_LOG_FATAL, "%s encoding failed: %s\n",
+                       av_get_media_type_string(enc->codec_type),
+                       av_err2str(ret));
+                exit_program(1);
+            }
+            reap_encoder_thread(of, ost);
+            output_packet(of, &pkt, ost, 1);
+            continue;
+        }
+#endif
+
         for (;;) {
             const char *desc = NULL;
             AVPacket pkt;
@@ -2157,6 +2700,10 @@ static int ifilter_send_frame(InputFilter *ifilter, AVFrame *frame)
             }
         }
 
+#if HAVE_THREADS
+        if (fg->filter_queue)
+            sync_filter_thread(fg);
+#endif
         ret = reap_filters(1);
         if (ret < 0 && ret != AVERROR_EOF) {
             av_log(NULL, AV_LOG_ERROR, "Error while filtering: %s\n", av_err2str(ret));
@@ -2170,6 +2717,33 @@ static int ifilter_send_frame(InputFilter *ifilter, AVFrame *frame)
         }
     }
 
+#if HAVE_THREADS
+    if (pipeline_filter && filtergraph_is_simple(fg)) {
+        if (!fg->filter_queue) {
+            OutputStream *ost = fg->outputs[0]->ost;
+
+            /* the encoder may set the audio frame size of the buffersink,
+             * which must happen before the thread pulls any frame */
+            if (!ost->initialized) {
+                char error[1024] = "";
+                ret = init_output_stream(ost, error, sizeof(error));
+                if (ret < 0) {
+                    av_log(NULL, AV_LOG_ERROR, "Error initializing output stream %d:%d -- %s\n",
+                           ost->file_index, ost->index, error);
+                    exit_program(1);
+                }
+            }
+            ret = init_filter_thread(fg);
+            if (ret < 0)
+                return ret;
+        }
+        ret = send_frame_to_filter_thread(fg, frame, AV_NOPTS_VALUE);
+        if (ret < 0)
+            av_log(NULL, AV_LOG_ERROR, "Error while filtering: %s\n", av_err2str(ret));
+        return ret;
+    }
+#endif
+
     ret = av_buffersrc_add_frame_flags(ifilter->filter, frame, AV_BUFFERSRC_FLAG_PUSH);
     if (ret < 0) {
         if (ret != AVERROR_EOF)
@@ -2187,6 +2761,10 @@ static int ifilter_send_eof(InputFilter *ifilter, int64_t pts)
     ifilter->eof = 1;
 
     if (ifilter->filter) {
+#if HAVE_THREADS
+        if (ifilter->graph->filter_queue)
+            return send_frame_to_filter_thread(ifilter->graph, NULL, pts);
+#endif
         ret = av_buffersrc_close(ifilter->filter, pts, AV_BUFFERSRC_FLAG_PUSH);
         if (ret < 0)
             return ret;
@@ -2230,6 +2808,248 @@ static int decode(AVCodecContext *avctx, AVFrame *frame, int *got_frame, AVPacke
     return 0;
 }
 
+#if HAVE_THREADS
+/* An entry of dec_frame_fifo: a decoded frame, or the error the decoder
+ * returned instead of one. */
+typedef struct DecodedFrame {
+    AVFrame *frame;
+    int      ret;
+    int      flushed;   /* returned while draining the decoder */
+} DecodedFrame;
+
+static void decoder_thread_output(InputStream *ist, AVFrame *frame, int ret, int flushed)
+{
+    DecodedFrame df = { frame, ret, flushed };
+    int err = 0;
+
+    pthread_mutex_lock(&ist->dec_frame_lock);
+    if (!av_fifo_space(ist->dec_frame_fifo))
+        err = av_fifo_realloc2(ist->dec_frame_fifo, 2 * av_fifo_size(ist->dec_frame_fifo));
+    if (err >= 0)
+        av_fifo_generic_write(ist->dec_frame_fifo, &df, sizeof(df), NULL);
+    pthread_cond_signal(&ist->dec_frame_cond);
+    pthread_mutex_unlock(&ist->dec_frame_lock);
+    if (err < 0)
+        av_frame_free(&frame);
+}
+
+static void *decoder_thread(void *arg)
+{
+    InputStream *ist = arg;
+    AVCodecContext *dec = ist->dec_ctx;
+    AVFrame *frame;
+    AVPacket pkt;
+    int ret;
+
+    while (av_thread_message_queue_recv(ist->dec_queue, &pkt, 0) >= 0) {
+        /* an empty packet drains the decoder */
+        int flush = !pkt.data && !pkt.size;
+
+        ret = avcodec_send_packet(dec, &pkt);
+        av_packet_unref(&pkt);
+        if (ret == AVERROR_EOF)
+            ret = 0;
+
+        while (ret >= 0) {
+            if (!(frame = av_frame_alloc())) {
+                ret = AVERROR(ENOMEM);
+                break;
+            }
+            ret = avcodec_receive_frame(dec, frame);
+            if (ret < 0) {
+                av_frame_free(&frame);
+                /* keep draining past a broken frame, as decode() callers do */
+                if (flush && ret != AVERROR_EOF) {
+                    decoder_thread_output(ist, NULL, ret, flush);
+                    ret = 0;
+                }
+                break;
+            }
+            decoder_thread_output(ist, frame, 0, flush);
+        }
+        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            decoder_thread_output(ist, NULL, ret, flush);
+
+        pthread_mutex_lock(&ist->dec_frame_lock);
+        ist->dec_has_b_frames    = dec->has_b_frames;
+        ist->dec_framerate       = dec->framerate;
+        ist->dec_ticks_per_frame = dec->ticks_per_frame;
+        ist->dec_done++;
+        pthread_cond_signal(&ist->dec_frame_cond);
+        pthread_mutex_unlock(&ist->dec_frame_lock);
+    }
+
+    return NULL;
+}
+
+static void free_decoder_packet(void *msg)
+{
+    av_packet_unref(msg);
+}
+
+static int init_decoder_thread(InputStream *ist)
+{
+    int ret;
+
+    ret = av_thread_message_queue_alloc(&ist->dec_queue, 8, sizeof(AVPacket));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(ist->dec_queue, free_decoder_packet);
+
+    ist->dec_frame_fifo = av_fifo_alloc(8 * sizeof(DecodedFrame));
+    if (!ist->dec_frame_fifo) {
+        av_thread_message_queue_free(&ist->dec_queue);
+        return AVERROR(ENOMEM);
+    }
+    pthread_mutex_init(&ist->dec_frame_lock, NULL);
+    pthread_cond_init(&ist->dec_frame_cond, NULL);
+    ist->dec_sent = ist->dec_done = 0;
+    ist->dec_draining = 0;
+    ist->dec_has_b_frames    = ist->dec_ctx->has_b_frames;
+    ist->dec_framerate       = ist->dec_ctx->framerate;
+    ist->dec_ticks_per_frame = ist->dec_ctx->ticks_per_frame;
+
+    if ((ret = pthread_create(&ist->dec_thread, NULL, decoder_thread, ist))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        pthread_cond_destroy(&ist->dec_frame_cond);
+        pthread_mutex_destroy(&ist->dec_frame_lock);
+        av_fifo_freep(&ist->dec_frame_fifo);
+        av_thread_message_queue_free(&ist->dec_queue);
+        return AVERROR(ret);
+    }
+
+    return 0;
+}
+
+static void free_decoder_thread(InputStream *ist)
+{
+    DecodedFrame df;
+
+    if (!ist->dec_queue)
+        return;
+
+    av_thread_message_flush(ist->dec_queue);
+    av_thread_message_queue_set_err_recv(ist->dec_queue, AVERROR_EOF);
+    pthread_join(ist->dec_thread, NULL);
+    av_thread_message_queue_free(&ist->dec_queue);
+
+    while (av_fifo_size(ist->dec_frame_fifo)) {
+        av_fifo_generic_read(ist->dec_frame_fifo, &df, sizeof(df), NULL);
+        av_frame_free(&df.frame);
+    }
+    av_fifo_freep(&ist->dec_frame_fifo);
+    pthread_cond_destroy(&ist->dec_frame_cond);
+    pthread_mutex_destroy(&ist->dec_frame_lock);
+}
+
+/*
+ * decode() for a decoder running on its own thread. pkt is queued, and the
+ * frame returned, if any, may come from an earlier packet. Once a flush
+ * packet was sent, this waits for the remaining frames and then returns
+ * AVERROR_EOF, until the decoder is flushed with avcodec_flush_buffers().
+ */
+static int decode_on_thread(InputStream *ist, AVFrame *frame, int *got_frame, AVPacket *pkt)
+{
+    DecodedFrame df;
+    int ret;
+
+    *got_frame = 0;
+    ist->dec_backlog = 0;
+
+    if (pkt && !ist->dec_draining) {
+        int flush = !pkt->data && !pkt->size;
+        AVPacket ref;
+
+        if (flush) {
+            av_init_packet(&ref);
+            ref.data = NULL;
+            ref.size = 0;
+        } else if ((ret = av_packet_ref(&ref, pkt)) < 0) {
+            return ret;
+        }
+        ret = av_thread_message_queue_send(ist->dec_queue, &ref, 0);
+        if (ret < 0) {
+            av_packet_unref(&ref);
+            return ret;
+        }
+        ist->dec_sent++;
+        ist->dec_draining = flush;
+
+        /* packet durations are derived from the decoder frame rate when the
+         * demuxer does not set them, so until the decoder knows it, wait for
+         * every packet like decode() does */
+        if (!flush && !pkt->duration) {
+            pthread_mutex_lock(&ist->dec_frame_lock);
+            while (!ist->dec_framerate.num && ist->dec_done < ist->dec_sent)
+                pthread_cond_wait(&ist->dec_frame_cond, &ist->dec_frame_lock);
+            pthread_mutex_unlock(&ist->dec_frame_lock);
+        }
+    }
+
+    pthread_mutex_lock(&ist->dec_frame_lock);
+    while (ist->dec_draining && !av_fifo_size(ist->dec_frame_fifo) &&
+           ist->dec_done < ist->dec_sent)
+        pthread_cond_wait(&ist->dec_frame_cond, &ist->dec_frame_lock);
+    if (!av_fifo_size(ist->dec_frame_fifo)) {
+        pthread_mutex_unlock(&ist->dec_frame_lock);
+        return ist->dec_draining ? AVERROR_EOF : 0;
+    }
+    av_fifo_generic_read(ist->dec_frame_fifo, &df, sizeof(df), NULL);
+    pthread_mutex_unlock(&ist->dec_frame_lock);
+
+    if (df.ret < 0)
+        return df.ret;
+    av_frame_move_ref(frame, df.frame);
+    av_frame_free(&df.frame);
+    *got_frame = 1;
+    ist->dec_backlog = ist->dec_draining && !df.flushed;
+
+    return 0;
+}
+#endif
+
+static int decoder_on_thread(InputStream *ist)
+{
+#if HAVE_THREADS
+    return !!ist->dec_queue;
+#else
+    return 0;
+#endif
+}
+
+/* whether the frame just returned was decoded before the flush packet */
+static int decoder_backlog(InputStream *ist)
+{
+#if HAVE_THREADS
+    return ist->dec_backlog;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Get the decoder context fields the main loop depends on. With
+ * -pipeline_decode the context belongs to the decoder thread, so the values
+ * it published last are returned instead.
+ */
+static void get_decoder_params(InputStream *ist, int *has_b_frames,
+                               AVRational *framerate, int *ticks_per_frame)
+{
+#if HAVE_THREADS
+    if (ist->dec_queue) {
+        pthread_mutex_lock(&ist->dec_frame_lock);
+        *has_b_frames    = ist->dec_has_b_frames;
+        *framerate       = ist->dec_framerate;
+        *ticks_per_frame = ist->dec_ticks_per_frame;
+        pthread_mutex_unlock(&ist->dec_frame_lock);
+        return;
+    }
+#endif
+    *has_b_frames    = ist->dec_ctx->has_b_frames;
+    *framerate       = ist->dec_ctx->framerate;
+    *ticks_per_frame = ist->dec_ctx->ticks_per_frame;
+}
+
 static int send_frame_to_filters(InputStream *ist, AVFrame *decoded_frame)
 {
     int i, ret;
@@ -2326,6 +3146,8 @@ static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output, int64_
     int64_t best_effort_timestamp;
     int64_t dts = AV_NOPTS_VALUE;
     AVPacket avpkt;
+    int has_b_frames, ticks_per_frame;
+    AVRational framerate;
 
     // With fate-indeo3-2, we're getting 0-sized packets before EOF for some
     // reason. This seems like a semi-critical bug. Don't trigger EOF, and
@@ -2356,6 +3178,11 @@ static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output, int64_
     }
 
     update_benchmark(NULL);
+#if HAVE_THREADS
+    if (ist->dec_queue)
+        ret = decode_on_thread(ist, decoded_frame, got_output, pkt ? &avpkt : NULL);
+    else
+#endif
     ret = decode(ist->dec_ctx, decoded_frame, got_output, pkt ? &avpkt : NULL);
     update_benchmark("decode_video %d.%d", ist->file_index, ist->st->index);
     if (ret < 0)
@@ -2363,23 +3190,25 @@ static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output, int64_
 
     // The following line may be required in some cases where there is no parser
     // or the parser does not has_b_frames correctly
-    if (ist->st->codecpar->video_delay < ist->dec_ctx->has_b_frames) {
+    get_decoder_params(ist, &has_b_frames, &framerate, &ticks_per_frame);
+    if (ist->st->codecpar->video_delay < has_b_frames) {
         if (ist->dec_ctx->codec_id == AV_CODEC_ID_H264) {
-            ist->st->codecpar->video_delay = ist->dec_ctx->has_b_frames;
+            ist->st->codecpar->video_delay = has_b_frames;
         } else
             av_log(ist->dec_ctx, AV_LOG_WARNING,
                    "video_delay is larger in decoder than demuxer %d > %d.\n"
                    "If you want to help, upload a sample "
                    "of this file to https://streams.videolan.org/upload/ "
                    "and contact the ffmpeg-devel mailing list. (ffmpeg-devel@ffmpeg.org)\n",
-                   ist->dec_ctx->has_b_frames,
+                   has_b_frames,
                    ist->st->codecpar->video_delay);
     }
 
     if (ret != AVERROR_EOF)
         check_decode_result(ist, got_output, ret);
 
-    if (*got_output && ret >= 0) {
+    /* the decoder thread may already be past this frame */
+    if (*got_output && ret >= 0 && !decoder_on_thread(ist)) {
         if (ist->dec_ctx->width  != decoded_frame->width ||
             ist->dec_ctx->height != decoded_frame->height ||
             ist->dec_ctx->pix_fmt != decoded_frame->format) {
@@ -2587,6 +3416,8 @@ static int process_input_packet(InputStream *ist, const AVPacket *pkt, int no_eo
         int64_t duration_pts = 0;
         int got_output = 0;
         int decode_failed = 0;
+        int has_b_frames, ticks_per_frame;
+        AVRational framerate;
 
         ist->pts = ist->next_pts;
         ist->dts = ist->next_dts;
@@ -2599,14 +3430,19 @@ static int process_input_packet(InputStream *ist, const AVPacket *pkt, int no_eo
         case AVMEDIA_TYPE_VIDEO:
             ret = decode_video    (ist, repeating ? NULL : &avpkt, &got_output, &duration_pts, !pkt,
                                    &decode_failed);
-            if (!repeating || !pkt || got_output) {
+            /* the frames of a decoder thread cannot be matched to packets,
+             * so only the packets and what draining the decoder returned
+             * advance the dts then */
+            if (decoder_on_thread(ist) ? (pkt ? !repeating : !decoder_backlog(ist)) :
+                                         (!repeating || !pkt || got_output)) {
+                get_decoder_params(ist, &has_b_frames, &framerate, &ticks_per_frame);
                 if (pkt && pkt->duration) {
                     duration_dts = av_rescale_q(pkt->duration, ist->st->time_base, AV_TIME_BASE_Q);
-                } else if(ist->dec_ctx->framerate.num != 0 && ist->dec_ctx->framerate.den != 0) {
-                    int ticks= av_stream_get_parser(ist->st) ? av_stream_get_parser(ist->st)->repeat_pict+1 : ist->dec_ctx->ticks_per_frame;
+                } else if(framerate.num != 0 && framerate.den != 0) {
+                    int ticks= av_stream_get_parser(ist->st) ? av_stream_get_parser(ist->st)->repeat_pict+1 : ticks_per_frame;
                     duration_dts = ((int64_t)AV_TIME_BASE *
-                                    ist->dec_ctx->framerate.den * ticks) /
-                                    ist->dec_ctx->framerate.num / ist->dec_ctx->ticks_per_frame;
+                                    framerate.den * ticks) /
+                                    framerate.num / ticks_per_frame;
                 }
 
                 if(ist->dts != AV_NOPTS_VALUE && duration_dts) {
@@ -2924,6 +3760,20 @@ static int init_input_stream(int ist_index, char *error, int error_len)
             return ret;
         }
         assert_avoptions(ist->decoder_opts);
+#if HAVE_THREADS
+        /* hwaccel frames are retrieved through the context on the main
+         * thread, and attached pictures are too sparse to pipeline */
+        if (pipeline_decode && ist->dec_ctx->codec_type == AVMEDIA_TYPE_VIDEO &&
+            ist->hwaccel_id == HWACCEL_NONE &&
+            !(ist->st->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+            ret = init_decoder_thread(ist);
+            if (ret < 0) {
+                snprintf(error, error_len, "Could not start decoder thread "
+                         "for input stream #%d:%d", ist->file_index, ist->st->index);
+                return ret;
+            }
+        }
+#endif
     }
 
     ist->next_pts = AV_NOPTS_VALUE;
@@ -3487,6 +4337,17 @@ static int init_output_stream(OutputStream *ost, char *error, int error_len)
             av_buffersink_set_frame_size(ost->filter->filter,
                                             ost->enc_ctx->frame_size);
         assert_avoptions(ost->encoder_opts);
+#if HAVE_THREADS
+        if (pipeline_encode &&
+            (ost->enc->type == AVMEDIA_TYPE_VIDEO || ost->enc->type == AVMEDIA_TYPE_AUDIO)) {
+            ret = init_encoder_thread(ost);
+            if (ret < 0) {
+                snprintf(error, error_len, "Could not start encoder thread "
+                         "for output stream #%d:%d", ost->file_index, ost->index);
+                return ret;
+            }
+        }
+#endif
         if (ost->enc_ctx->bit_rate && ost->enc_ctx->bit_rate < 1000 &&
             ost->enc_ctx->codec_id != AV_CODEC_ID_CODEC2 /* don't complain about 700 bit/s modes */)
             av_log(NULL, AV_LOG_WARNING, "The bitrate parameter is set too low."
@@ -3909,6 +4770,10 @@ static int check_keyboard_interaction(int64_t cur_time)
             for (i = 0; i < nb_filtergraphs; i++) {
                 FilterGraph *fg = filtergraphs[i];
                 if (fg->graph) {
+#if HAVE_THREADS
+                    if (fg->filter_queue)
+                        sync_filter_thread(fg);
+#endif
                     if (time < 0) {
                         ret = avfilter_graph_send_command(fg->graph, target, command, arg, buf, sizeof(buf),
                                                           key == 'c' ? AVFILTER_CMD_FLAG_ONE : 0);
@@ -3981,6 +4846,49 @@ static int check_keyboard_interaction(int64_t cur_time)
 }
 
 #if HAVE_THREADS
+#define THREAD_QUEUE_SIZE_MIN 8
+#define THREAD_QUEUE_SIZE_MAX 1024
+
+/*
+ * Resize the adaptive packet queue of f: grow it when the main thread had
+ * to wait for the demuxer, shrink it again once the demuxer has stayed
+ * far ahead for a while. Must be called with thread_queue_lock held.
+ */
+static void adapt_thread_queue_size(InputFile *f, int stalled)
+{
+    int size = f->thread_queue_size;
+
+    if (stalled) {
+        f->thread_queue_full = 0;
+        size = FFMIN(2 * size, THREAD_QUEUE_SIZE_MAX);
+    } else if (++f->thread_queue_full >= 4 * size) {
+        f->thread_queue_full = 0;
+        size = FFMAX(size / 2, THREAD_QUEUE_SIZE_MIN);
+    }
+
+    if (size != f->thread_queue_size) {
+        av_log(f->ctx, AV_LOG_DEBUG, "Thread message queue size %d -> %d\n",
+               f->thread_queue_size, size);
+        f->thread_queue_size = size;
+        pthread_cond_signal(&f->thread_queue_cond);
+    }
+}
+
+static void input_thread_wait(InputFile *f)
+{
+    pthread_mutex_lock(&f->thread_queue_lock);
+    while (!f->thread_queue_exit &&
+           av_thread_message_queue_nb_elems(f->in_thread_queue) >= f->thread_queue_size) {
+        /* live inputs must not block, give them more room instead */
+        if (f->non_blocking && f->thread_queue_size < THREAD_QUEUE_SIZE_MAX) {
+            adapt_thread_queue_size(f, 1);
+            break;
+        }
+        pthread_cond_wait(&f->thread_queue_cond, &f->thread_queue_lock);
+    }
+    pthread_mutex_unlock(&f->thread_queue_lock);
+}
+
 static void *input_thread(void *arg)
 {
     InputFile *f = arg;
@@ -3999,6 +4907,8 @@ static void *input_thread(void *arg)
             av_thread_message_queue_set_err_recv(f->in_thread_queue, ret);
             break;
         }
+        if (f->thread_queue_adaptive)
+            input_thread_wait(f);
         ret = av_thread_message_queue_send(f->in_thread_queue, &pkt, flags);
         if (flags && ret == AVERROR(EAGAIN)) {
             flags = 0;
@@ -4030,12 +4940,29 @@ static void free_input_thread(int i)
     if (!f || !f->in_thread_queue)
         return;
     av_thread_message_queue_set_err_send(f->in_thread_queue, AVERROR_EOF);
-    while (av_thread_message_queue_recv(f->in_thread_queue, &pkt, 0) >= 0)
+    if (f->thread_queue_adaptive) {
+        /* wake up the thread if it waits for the queue to drain */
+        pthread_mutex_lock(&f->thread_queue_lock);
+        f->thread_queue_exit = 1;
+        pthread_cond_signal(&f->thread_queue_cond);
+        pthread_mutex_unlock(&f->thread_queue_lock);
+    }
+    while (av_thread_message_queue_recv(f->in_thread_queue, &pkt, 0) >= 0) {
         av_packet_unref(&pkt);
+        if (f->thread_queue_adaptive) {
+            pthread_mutex_lock(&f->thread_queue_lock);
+            pthread_cond_signal(&f->thread_queue_cond);
+            pthread_mutex_unlock(&f->thread_queue_lock);
+        }
+    }
 
     pthread_join(f->thread, NULL);
     f->joined = 1;
     av_thread_message_queue_free(&f->in_thread_queue);
+    if (f->thread_queue_adaptive) {
+        pthread_mutex_destroy(&f->thread_queue_lock);
+        pthread_cond_destroy(&f->thread_queue_cond);
+    }
 }
 
 static void free_input_threads(void)
@@ -4051,20 +4978,34 @@ static int init_input_thread(int i)
     int ret;
     InputFile *f = input_files[i];
 
-    if (nb_input_files == 1)
+    if (nb_input_files == 1 && !demux_thread)
         return 0;
 
     if (f->ctx->pb ? !f->ctx->pb->seekable :
         strcmp(f->ctx->iformat->name, "lavfi"))
         f->non_blocking = 1;
     ret = av_thread_message_queue_alloc(&f->in_thread_queue,
-                                        f->thread_queue_size, sizeof(AVPacket));
+                                        f->thread_queue_adaptive ?
+                                        THREAD_QUEUE_SIZE_MAX : f->thread_queue_size,
+                                        sizeof(AVPacket));
     if (ret < 0)
         return ret;
 
+    if (f->thread_queue_adaptive) {
+        pthread_mutex_init(&f->thread_queue_lock, NULL);
+        pthread_cond_init(&f->thread_queue_cond, NULL);
+        f->thread_queue_size = FFMAX(f->thread_queue_size, THREAD_QUEUE_SIZE_MIN);
+        f->thread_queue_full = 0;
+        f->thread_queue_exit = 0;
+    }
+
     if ((ret = pthread_create(&f->thread, NULL, input_thread, f))) {
         av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
         av_thread_message_queue_free(&f->in_thread_queue);
+        if (f->thread_queue_adaptive) {
+            pthread_mutex_destroy(&f->thread_queue_lock);
+            pthread_cond_destroy(&f->thread_queue_cond);
+        }
         return AVERROR(ret);
     }
 
@@ -4085,9 +5026,30 @@ static int init_input_threads(void)
 
 static int get_input_packet_mt(InputFile *f, AVPacket *pkt)
 {
-    return av_thread_message_queue_recv(f->in_thread_queue, pkt,
-                                        f->non_blocking ?
-                                        AV_THREAD_MESSAGE_NONBLOCK : 0);
+    int ret, stalled = 0;
+
+    if (!f->thread_queue_adaptive)
+        return av_thread_message_queue_recv(f->in_thread_queue, pkt,
+                                            f->non_blocking ?
+                                            AV_THREAD_MESSAGE_NONBLOCK : 0);
+
+    ret = av_thread_message_queue_recv(f->in_thread_queue, pkt,
+                                       AV_THREAD_MESSAGE_NONBLOCK);
+    if (ret == AVERROR(EAGAIN) && !f->non_blocking) {
+        stalled = 1;
+        ret = av_thread_message_queue_recv(f->in_thread_queue, pkt, 0);
+    }
+    if (ret < 0 && !stalled)
+        return ret;
+
+    pthread_mutex_lock(&f->thread_queue_lock);
+    if (stalled ||
+        av_thread_message_queue_nb_elems(f->in_thread_queue) >= f->thread_queue_size - 1)
+        adapt_thread_queue_size(f, stalled);
+    pthread_cond_signal(&f->thread_queue_cond);
+    pthread_mutex_unlock(&f->thread_queue_lock);
+
+    return ret;
 }
 #endif
 
@@ -4105,7 +5067,7 @@ static int get_input_packet(InputFile *f, AVPacket *pkt)
     }
 
 #if HAVE_THREADS
-    if (nb_input_files > 1)
+    if (f->in_thread_queue)
         return get_input_packet_mt(f, pkt);
 #endif
     return av_read_frame(f->ctx, pkt);
@@ -4242,7 +5204,11 @@ static int process_input(int file_index)
                 ret = process_input_packet(ist, NULL, 1);
                 if (ret>0)
                     return 0;
+                /* a decoder thread is idle once it returned EOF */
                 avcodec_flush_buffers(avctx);
+#if HAVE_THREADS
+                ist->dec_draining = 0;
+#endif
             }
         }
 #if HAVE_THREADS
@@ -4496,6 +5462,47 @@ discard_packet:
     return 0;
 }
 
+#if HAVE_THREADS
+/**
+ * transcode_from_filter() for a graph running on its own thread. The thread
+ * pulls from the graph by itself, so only its output is reaped here.
+ */
+static int transcode_from_filter_thread(FilterGraph *graph, InputStream **best_ist)
+{
+    InputFilter *ifilter = graph->inputs[0];
+    InputFile *ifile = input_files[ifilter->ist->file_index];
+    int i, ret, eof;
+
+    /* nothing else can make progress on this graph, so wait for the thread */
+    pthread_mutex_lock(&graph->filter_frame_lock);
+    while (ifilter->eof && !graph->filter_out_eof &&
+           !av_fifo_size(graph->filter_frame_fifo))
+        pthread_cond_wait(&graph->filter_frame_cond, &graph->filter_frame_lock);
+    eof = graph->filter_out_eof;
+    pthread_mutex_unlock(&graph->filter_frame_lock);
+
+    if (eof) {
+        ret = reap_filters(1);
+        for (i = 0; i < graph->nb_outputs; i++)
+            close_output_stream(graph->outputs[i]->ost);
+        return ret;
+    }
+
+    ret = reap_filters(0);
+    if (ret < 0 || ifilter->eof)
+        return ret;
+
+    if (ifile->eagain || ifile->eof_reached) {
+        for (i = 0; i < graph->nb_outputs; i++)
+            graph->outputs[i]->ost->unavailable = 1;
+        return 0;
+    }
+    *best_ist = ifilter->ist;
+
+    return 0;
+}
+#endif
+
 /**
  * Perform a step of transcoding for the specified filter graph.
  *
@@ -4511,6 +5518,10 @@ static int transcode_from_filter(FilterGraph *graph, InputStream **best_ist)
     InputStream *ist;
 
     *best_ist = NULL;
+#if HAVE_THREADS
+    if (graph->filter_queue)
+        return transcode_from_filter_thread(graph, best_ist);
+#endif
     ret = avfilter_graph_request_oldest(graph->graph);
     if (ret >= 0)
         return reap_filters(0);
@@ -4728,6 +5739,9 @@ static int transcode(void)
     for (i = 0; i < nb_input_streams; i++) {
         ist = input_streams[i];
         if (ist->decoding_needed) {
+#if HAVE_THREADS
+            free_decoder_thread(ist);
+#endif
             avcodec_close(ist->dec_ctx);
             if (ist->hwaccel_uninit)
                 ist->hwaccel_uninit(ist->dec_ctx);
@@ -4742,6 +5756,13 @@ static int transcode(void)
  fail:
 #if HAVE_THREADS
     free_input_threads();
+    for (i = 0; i < nb_input_streams; i++)
+        free_decoder_thread(input_streams[i]);
+    for (i = 0; i < nb_filtergraphs; i++)
+        free_filter_thread(filtergraphs[i]);
+    for (i = 0; i < nb_output_streams; i++)
+        if (output_streams[i])
+            free_encoder_thread(output_streams[i]);
 #endif
 
     if (output_streams) {
@@ -4828,9 +5849,30 @@ static void init_variables() {
   filtergraphs      = NULL;
   nb_filtergraphs   = 0;
   ffmpeg_exited     = 0;
+
+  /* state left over from a previous command run in this process */
+  vstats_file       = NULL;
+  progress_avio     = NULL;
+  subtitle_out      = NULL;
+  run_as_daemon     = 0;
+  nb_frames_dup     = 0;
+  dup_warning       = 1000;
+  nb_frames_drop    = 0;
+  decode_error_stat[0] = decode_error_stat[1] = 0;
+  want_sdp          = 1;
+  report_last_time  = -1;
+  progress_cb_last_time = -1;
+  memset(qp_histogram, 0, sizeof(qp_histogram));
+  received_sigterm    = 0;
+  received_nb_signals = 0;
+  atomic_store(&transcode_init_done, 0);
+  main_return_code  = 0;
+  hide_banner       = 0;
+
+  reset_global_options();
 }
 
-int main(int argc, char **argv)
+static av_noreturn void run_command(int argc, char **argv)
 {
     int i, ret;
     BenchmarkTimeStamps ti;
@@ -4900,5 +5942,28 @@ int main(int argc, char **argv)
         exit_program(69);
 
     exit_program(received_nb_signals ? 255 : main_return_code);
-    return main_return_code;
+}
+
+int ffmpeg_exec(int argc, char **argv)
+{
+    static jmp_buf env;
+    static int ret, log_level;
+
+    log_level = av_log_get_level();
+    if (!setjmp(env)) {
+        register_exit_jmp(&env, &ret);
+        run_command(argc, argv);
+    }
+    register_exit_jmp(NULL, NULL);
+
+    if (run_as_daemon)
+        av_log_set_callback(av_log_default_callback);
+    av_log_set_level(log_level);
+
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    run_command(argc, argv);
 }
@@ -289,6 +289,19 @@ typedef struct FilterGraph {
     int          nb_inputs;
     OutputFilter **outputs;
     int         nb_outputs;
+
+#if HAVE_THREADS
+    /* simple graph running on its own thread, see -pipeline_filter */
+    AVThreadMessageQueue *filter_queue; /* frames sent to the filter thread */
+    AVFifoBuffer *filter_frame_fifo;    /* frames returned by the filter thread */
+    pthread_mutex_t filter_frame_lock;
+    pthread_cond_t filter_frame_cond;
+    pthread_t filter_thread;
+    int filter_thread_ret;              /* first error of the filter thread */
+    int filter_sent;                    /* messages sent to the filter thread */
+    int filter_done;                    /* messages processed by the filter thread */
+    int filter_out_eof;                 /* the output of the thread is finished */
+#endif
 } FilterGraph;
 
 typedef struct InputStream {
@@ -388,6 +401,24 @@ typedef struct InputStream {
     int nb_dts_buffer;
 
     int got_output;
+
+#if HAVE_THREADS
+    /* decoder running on its own thread, see -pipeline_decode */
+    AVThreadMessageQueue *dec_queue;    /* packets sent to the decoder thread */
+    AVFifoBuffer *dec_frame_fifo;       /* frames returned by the decoder thread */
+    pthread_mutex_t dec_frame_lock;
+    pthread_cond_t dec_frame_cond;
+    pthread_t dec_thread;
+    int dec_sent;                       /* packets sent to the decoder thread */
+    int dec_done;                       /* packets processed by the decoder thread */
+    int dec_draining;                   /* a flush packet was sent */
+    int dec_backlog;                    /* the last frame predates the flush packet */
+    /* decoder context fields read by the main thread, updated by the
+     * decoder thread under dec_frame_lock */
+    int dec_has_b_frames;
+    AVRational dec_framerate;
+    int dec_ticks_per_frame;
+#endif
 } InputStream;
 
 typedef struct InputFile {
@@ -418,6 +449,11 @@ typedef struct InputFile {
     int non_blocking;           /* reading packets from the thread should not block */
     int joined;                 /* the thread has been joined */
     int thread_queue_size;      /* maximum number of queued packets */
+    int thread_queue_adaptive;  /* thread_queue_size follows the consumer, see adapt_thread_queue_size() */
+    int thread_queue_full;      /* packets taken from a full queue since the last stall */
+    int thread_queue_exit;      /* the thread must stop waiting for room in the queue */
+    pthread_mutex_t thread_queue_lock;
+    pthread_cond_t thread_queue_cond;
 #endif
 } InputFile;
 
@@ -549,6 +585,15 @@ typedef struct OutputStream {
 
     /* frame encode sum of squared error values */
     int64_t error[4];
+
+#if HAVE_THREADS
+    /* encoder running on its own thread, see -pipeline_encode */
+    AVThreadMessageQueue *enc_queue;    /* frames sent to the encoder thread */
+    AVFifoBuffer *enc_pkt_fifo;         /* packets returned by the encoder thread */
+    pthread_mutex_t enc_pkt_lock;
+    pthread_t enc_thread;
+    int enc_thread_ret;                 /* exit status of the encoder thread */
+#endif
 } OutputStream;
 
 typedef struct OutputFile {
@@ -610,6 +655,10 @@ extern char *videotoolbox_pixfmt;
 extern int filter_nbthreads;
 extern int filter_complex_nbthreads;
 extern int vstats_version;
+extern int pipeline_decode;
+extern int pipeline_filter;
+extern int pipeline_encode;
+extern int demux_thread;
 
 extern const AVIOInterruptCB int_cb;
 
@@ -625,6 +674,7 @@ void term_init(void);
 void term_exit(void);
 
 void reset_options(OptionsContext *o, int is_input);
+void reset_global_options(void);
 void show_usage(void);
 
 void opt_output_file(void *optctx, const char *filename);
@@ -651,6 +701,55 @@ int ifilter_parameters_from_frame(InputFilter *ifilter, const AVFrame *frame);
 
 int ffmpeg_parse_options(int argc, char **argv);
 
+/**
+ * Run one command line like main() does, but return its exit code instead
+ * of terminating the process. Global state is reset on entry, so this can be
+ * called repeatedly from the same process.
+ */
+int ffmpeg_exec(int argc, char **argv);
+
+typedef struct FFmpegStreamProgress {
+    int     file_index;     ///< output file index
+    int     index;          ///< stream index in the output file
+    int     frames;         ///< frames encoded, or packets copied
+    float   q;              ///< last encoder quality, -1 for stream copy
+    int     mux_queue;      ///< packets waiting for the muxer to be initialized
+    int     enc_queue;      ///< frames waiting for the encoder thread (-pipeline_encode)
+} FFmpegStreamProgress;
+
+/**
+ * Transcoding progress, with the values -progress writes as text.
+ * All fields that are not available are set to -1.
+ */
+typedef struct FFmpegProgress {
+    int     frame;          ///< frames output for the first video stream
+    float   fps;
+    float   q;              ///< quality of the first video stream
+    int64_t total_size;     ///< bytes written to the first output file
+    int64_t out_time_us;
+    double  bitrate;        ///< kbit/s
+    double  speed;          ///< ratio of out_time to the elapsed wall-clock time
+    int     dup_frames;
+    int     drop_frames;
+    int64_t maxrss;         ///< peak resident set size in bytes, 0 if unknown
+    int     is_last;        ///< 1 for the final report of a run
+
+    int     nb_inputs;
+    const int *demux_queue; ///< packets queued by each input file's demuxer thread
+    int     nb_streams;
+    const FFmpegStreamProgress *streams; ///< one entry per output stream
+} FFmpegProgress;
+
+/**
+ * Have ffmpeg_exec() and main() report progress through cb instead of
+ * having the caller parse the text statistics. cb is called from the
+ * transcoding loop at most every interval_ms milliseconds, and once more
+ * when transcoding finishes. The report and its arrays are only valid
+ * during the call. Pass a NULL cb to stop reporting.
+ */
+void ffmpeg_set_progress_callback(void (*cb)(const FFmpegProgress *progress, void *opaque),
+                                  void *opaque, int interval_ms);
+
 int videotoolbox_init(AVCodecContext *s);
 int qsv_init(AVCodecContext *s);
 
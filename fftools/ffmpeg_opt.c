@@ -41,6 +41,7 @@
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/threadpool.h"
 
 #define DEFAULT_PASS_LOGFILENAME_PREFIX "ffmpeg2pass"
 
@@ -171,6 +172,10 @@ float max_error_rate  = 2.0/3;
 int filter_nbthreads = 0;
 int filter_complex_nbthreads = 0;
 int vstats_version = 2;
+int pipeline_decode = 0;
+int pipeline_filter = 0;
+int pipeline_encode = 0;
+int demux_thread = 0;
 
 
 static int intra_only         = 0;
@@ -183,6 +188,55 @@ static int ignore_unknown_streams = 0;
 static int copy_unknown_streams = 0;
 static int find_stream_info = 1;
 
+void reset_global_options(void)
+{
+    av_freep(&vstats_filename);
+    av_freep(&sdp_filename);
+    filter_hw_device = NULL;
+
+    audio_drift_threshold = 0.1;
+    dts_delta_threshold   = 10;
+    dts_error_threshold   = 3600*30;
+
+    audio_volume      = 256;
+    audio_sync_method = 0;
+    video_sync_method = VSYNC_AUTO;
+    frame_drop_threshold = 0;
+    do_deinterlace    = 0;
+    do_benchmark      = 0;
+    do_benchmark_all  = 0;
+    do_hex_dump       = 0;
+    do_pkt_dump       = 0;
+    copy_ts           = 0;
+    start_at_zero     = 0;
+    copy_tb           = -1;
+    debug_ts          = 0;
+    exit_on_error     = 0;
+    abort_on_flags    = 0;
+    print_stats       = -1;
+    qp_hist           = 0;
+    stdin_interaction = 1;
+    frame_bits_per_raw_sample = 0;
+    max_error_rate  = 2.0/3;
+    filter_nbthreads = 0;
+    filter_complex_nbthreads = 0;
+    vstats_version = 2;
+    pipeline_decode = 0;
+    pipeline_filter = 0;
+    pipeline_encode = 0;
+    demux_thread = 0;
+
+    intra_only         = 0;
+    file_overwrite     = 0;
+    no_file_overwrite  = 0;
+    do_psnr            = 0;
+    input_sync         = 0;
+    input_stream_potentially_available = 0;
+    ignore_unknown_streams = 0;
+    copy_unknown_streams = 0;
+    find_stream_info = 1;
+}
+
 static void uninit_options(OptionsContext *o)
 {
     const OptionDef *po = options;
@@ -533,6 +587,17 @@ static int opt_sdp_file(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_shared_threads(void *optctx, const char *opt, const char *arg)
+{
+    int ret = av_thread_pool_init(parse_number_or_die(opt, arg, OPT_INT, 0, INT_MAX));
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_FATAL, "Could not create the shared thread pool: %s\n",
+               av_err2str(ret));
+        exit_program(1);
+    }
+    return 0;
+}
+
 #if CONFIG_VAAPI
 static int opt_vaapi_device(void *optctx, const char *opt, const char *arg)
 {
@@ -1270,6 +1335,7 @@ static int open_input_file(OptionsContext *o, const char *filename)
     f->time_base = (AVRational){ 1, 1 };
 #if HAVE_THREADS
     f->thread_queue_size = o->thread_queue_size > 0 ? o->thread_queue_size : 8;
+    f->thread_queue_adaptive = o->thread_queue_size <= 0;
 #endif
 
     /* check if all codec options have been used */
@@ -3529,6 +3595,8 @@ const OptionDef options[] = {
         "set stream filtergraph", "filter_graph" },
     { "filter_threads",  HAS_ARG | OPT_INT,                          { &filter_nbthreads },
         "number of non-complex filter threads" },
+    { "shared_threads",  HAS_ARG | OPT_EXPERT,                       { .func_arg = opt_shared_threads },
+        "run the slice threads of all codecs and filters on one pool of this many threads", "count" },
     { "filter_script",  HAS_ARG | OPT_STRING | OPT_SPEC | OPT_OUTPUT, { .off = OFFSET(filter_scripts) },
         "read stream filtergraph description from a file", "filename" },
     { "reinit_filter",  HAS_ARG | OPT_INT | OPT_SPEC | OPT_INPUT,    { .off = OFFSET(reinit_filters) },
@@ -3537,6 +3605,14 @@ const OptionDef options[] = {
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_threads", HAS_ARG | OPT_INT,                   { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "pipeline_decode", OPT_BOOL | OPT_EXPERT,                      { &pipeline_decode },
+        "run each video decoder on its own thread" },
+    { "pipeline_filter", OPT_BOOL | OPT_EXPERT,                      { &pipeline_filter },
+        "run each simple audio/video filtergraph on its own thread" },
+    { "pipeline_encode", OPT_BOOL | OPT_EXPERT,                      { &pipeline_encode },
+        "run each audio/video encoder on its own thread" },
+    { "demux_thread",   OPT_BOOL | OPT_EXPERT,                       { &demux_thread },
+        "demux each input on its own thread, even with a single input" },
     { "lavfi",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_script", HAS_ARG | OPT_EXPERT,                 { .func_arg = opt_filter_complex_script },
@@ -37,8 +37,10 @@
 typedef struct{
     void *indata;
     void *outdata;
+    void *prevdata;
     int64_t return_code;
     unsigned index;
+    int frame_number;
 } Task;
 
 typedef struct{
@@ -56,6 +58,9 @@ typedef struct{
     unsigned task_index;
     unsigned finished_task_index;
 
+    AVFrame *prev_frame;    ///< last submitted frame, for FF_CODEC_CAP_ENCODE_PREV_FRAME
+    AVFrame *first_frame;
+
     pthread_t worker[MAX_THREADS];
     atomic_int exit;
 } ThreadContext;
@@ -67,7 +72,7 @@ static void * attribute_align_arg worker(void *v){
 
     while (!atomic_load(&c->exit)) {
         int got_packet = 0, ret;
-        AVFrame *frame;
+        AVFrame *frame, *prev;
         Task task;
 
         if(!pkt) pkt = av_packet_alloc();
@@ -85,8 +90,15 @@ static void * attribute_align_arg worker(void *v){
         av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
         pthread_mutex_unlock(&c->task_fifo_mutex);
         frame = task.indata;
+        prev  = task.prevdata;
 
+        if (avctx->codec->caps_internal & FF_CODEC_CAP_ENCODE_PREV_FRAME) {
+            avctx->internal->prev_frame  = prev;
+            avctx->internal->first_frame = c->first_frame;
+            avctx->frame_number          = task.frame_number;
+        }
         ret = avctx->codec->encode2(avctx, pkt, frame, &got_packet);
+        avctx->internal->prev_frame = NULL;
         if(got_packet) {
             int ret2 = av_packet_make_refcounted(pkt);
             if (ret >= 0 && ret2 < 0)
@@ -98,8 +110,11 @@ static void * attribute_align_arg worker(void *v){
         }
         pthread_mutex_lock(&c->buffer_mutex);
         av_frame_unref(frame);
+        if (prev)
+            av_frame_unref(prev);
         pthread_mutex_unlock(&c->buffer_mutex);
         av_frame_free(&frame);
+        av_frame_free(&prev);
         pthread_mutex_lock(&c->finished_task_mutex);
         c->finished_tasks[task.index].outdata = pkt; pkt = NULL;
         c->finished_tasks[task.index].return_code = ret;
@@ -260,7 +275,12 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
         frame = task.indata;
         av_frame_free(&frame);
         task.indata = NULL;
+        frame = task.prevdata;
+        av_frame_free(&frame);
+        task.prevdata = NULL;
     }
+    av_frame_free(&c->prev_frame);
+    av_frame_free(&c->first_frame);
 
     for (i=0; i<BUFFER_SIZE; i++) {
         if (c->finished_tasks[i].outdata != NULL) {
@@ -279,6 +299,26 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
     av_freep(&avctx->internal->frame_thread_encoder);
 }
 
+static int ref_prev_frames(ThreadContext *c, const AVFrame *frame, Task *task)
+{
+    int ret;
+
+    if (c->prev_frame) {
+        AVFrame *prev = av_frame_clone(c->prev_frame);
+        if (!prev)
+            return AVERROR(ENOMEM);
+        task->prevdata = prev;
+        av_frame_unref(c->prev_frame);
+    } else {
+        if (!(c->prev_frame  = av_frame_alloc()) ||
+            !(c->first_frame = av_frame_alloc()))
+            return AVERROR(ENOMEM);
+        if ((ret = av_frame_ref(c->first_frame, frame)) < 0)
+            return ret;
+    }
+    return av_frame_ref(c->prev_frame, frame);
+}
+
 int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet_ptr){
     ThreadContext *c = avctx->internal->frame_thread_encoder;
     Task task;
@@ -298,6 +338,18 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
 
         task.index = c->task_index;
         task.indata = (void*)new;
+        task.prevdata = NULL;
+        task.frame_number = avctx->frame_number;
+
+        if (avctx->codec->caps_internal & FF_CODEC_CAP_ENCODE_PREV_FRAME) {
+            if ((ret = ref_prev_frames(c, frame, &task)) < 0) {
+                AVFrame *prev = task.prevdata;
+                av_frame_free(&prev);
+                av_frame_free(&new);
+                return ret;
+            }
+        }
+
         pthread_mutex_lock(&c->task_fifo_mutex);
         av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
         pthread_cond_signal(&c->task_fifo_cond);
@@ -30,7 +30,6 @@
  * @see http://www.w3.org/Graphics/GIF/spec-gif89a.txt
  */
 
-#define BITSTREAM_WRITER_LE
 #include "libavutil/opt.h"
 #include "libavutil/imgutils.h"
 #include "avcodec.h"
@@ -39,8 +38,6 @@
 #include "lzw.h"
 #include "gif.h"
 
-#include "put_bits.h"
-
 #define DEFAULT_TRANSPARENCY_INDEX 0x1f
 
 typedef struct GIFContext {
@@ -197,16 +194,16 @@ static void gif_crop_translucent(AVCodecContext *avctx,
 }
 
 static void gif_crop_opaque(AVCodecContext *avctx,
-                            const uint32_t *palette,
+                            const uint32_t *palette, const AVFrame *last_frame,
                             const uint8_t *buf, const int linesize,
                             int *width, int *height, int *x_start, int *y_start)
 {
     GIFContext *s = avctx->priv_data;
 
     /* Crop image */
-    if ((s->flags & GF_OFFSETTING) && s->last_frame && !palette) {
-        const uint8_t *ref = s->last_frame->data[0];
-        const int ref_linesize = s->last_frame->linesize[0];
+    if ((s->flags & GF_OFFSETTING) && last_frame && !palette) {
+        const uint8_t *ref = last_frame->data[0];
+        const int ref_linesize = last_frame->linesize[0];
         int x_end = avctx->width  - 1,
             y_end = avctx->height - 1;
 
@@ -257,14 +254,14 @@ static void gif_crop_opaque(AVCodecContext *avctx,
 
 static int gif_image_write_image(AVCodecContext *avctx,
                                  uint8_t **bytestream, uint8_t *end,
-                                 const uint32_t *palette,
+                                 const uint32_t *palette, const AVFrame *last_frame,
                                  const uint8_t *buf, const int linesize,
                                  AVPacket *pkt)
 {
     GIFContext *s = avctx->priv_data;
     int disposal, len = 0, height = avctx->height, width = avctx->width, x, y;
     int x_start = 0, y_start = 0, trans = s->transparent_index;
-    int bcid = -1, honor_transparency = (s->flags & GF_TRANSDIFF) && s->last_frame && !palette;
+    int bcid = -1, honor_transparency = (s->flags & GF_TRANSDIFF) && last_frame && !palette;
     const uint8_t *ptr;
 
     if (!s->image && avctx->frame_number && is_image_translucent(avctx, buf, linesize)) {
@@ -272,7 +269,7 @@ static int gif_image_write_image(AVCodecContext *avctx,
         honor_transparency = 0;
         disposal = GCE_DISPOSAL_BACKGROUND;
     } else {
-        gif_crop_opaque(avctx, palette, buf, linesize, &width, &height, &x_start, &y_start);
+        gif_crop_opaque(avctx, palette, last_frame, buf, linesize, &width, &height, &x_start, &y_start);
         disposal = GCE_DISPOSAL_INPLACE;
     }
 
@@ -344,12 +341,12 @@ static int gif_image_write_image(AVCodecContext *avctx,
     bytestream_put_byte(bytestream, 0x08);
 
     ff_lzw_encode_init(s->lzw, s->buf, s->buf_size,
-                       12, FF_LZW_GIF, put_bits);
+                       12, FF_LZW_GIF);
 
     ptr = buf + y_start*linesize + x_start;
     if (honor_transparency) {
-        const int ref_linesize = s->last_frame->linesize[0];
-        const uint8_t *ref = s->last_frame->data[0] + y_start*ref_linesize + x_start;
+        const int ref_linesize = last_frame->linesize[0];
+        const uint8_t *ref = last_frame->data[0] + y_start*ref_linesize + x_start;
 
         for (y = 0; y < height; y++) {
             memcpy(s->tmpl, ptr, width);
@@ -366,7 +363,7 @@ static int gif_image_write_image(AVCodecContext *avctx,
             ptr += linesize;
         }
     }
-    len += ff_lzw_encode_flush(s->lzw, flush_put_bits);
+    len += ff_lzw_encode_flush(s->lzw);
 
     ptr = s->buf;
     while (len > 0) {
@@ -406,14 +403,31 @@ static av_cold int gif_encode_init(AVCodecContext *avctx)
     return 0;
 }
 
+static void gif_load_palette(GIFContext *s, const uint32_t *palette)
+{
+    memcpy(s->palette, palette, AVPALETTE_SIZE);
+    s->transparent_index = get_palette_transparency_index(palette);
+    s->palette_loaded = 1;
+}
+
 static int gif_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                             const AVFrame *pict, int *got_packet)
 {
     GIFContext *s = avctx->priv_data;
+    const int frame_thread = !!avctx->internal->frame_thread_encoder;
+    const AVFrame *last_frame = s->last_frame;
     uint8_t *outbuf_ptr, *end;
     const uint32_t *palette = NULL;
     int ret;
 
+    /* with frame threading, this context may not have seen the previous
+     * frames; the generic code passes those the encoding depends on */
+    if (frame_thread) {
+        last_frame = s->image ? NULL : avctx->internal->prev_frame;
+        if (avctx->pix_fmt == AV_PIX_FMT_PAL8 && avctx->frame_number && !s->palette_loaded)
+            gif_load_palette(s, (uint32_t*)avctx->internal->first_frame->data[1]);
+    }
+
     if ((ret = ff_alloc_packet2(avctx, pkt, avctx->width*avctx->height*7/5 + AV_INPUT_BUFFER_MIN_SIZE, 0)) < 0)
         return ret;
     outbuf_ptr = pkt->data;
@@ -423,23 +437,21 @@ static int gif_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         palette = (uint32_t*)pict->data[1];
 
         if (!s->palette_loaded) {
-            memcpy(s->palette, palette, AVPALETTE_SIZE);
-            s->transparent_index = get_palette_transparency_index(palette);
-            s->palette_loaded = 1;
+            gif_load_palette(s, palette);
         } else if (!memcmp(s->palette, palette, AVPALETTE_SIZE)) {
             palette = NULL;
         }
     }
 
-    gif_image_write_image(avctx, &outbuf_ptr, end, palette,
+    gif_image_write_image(avctx, &outbuf_ptr, end, palette, last_frame,
                           pict->data[0], pict->linesize[0], pkt);
-    if (!s->last_frame && !s->image) {
+    if (!s->last_frame && !s->image && !frame_thread) {
         s->last_frame = av_frame_alloc();
         if (!s->last_frame)
             return AVERROR(ENOMEM);
     }
 
-    if (!s->image) {
+    if (!s->image && !frame_thread) {
         av_frame_unref(s->last_frame);
         ret = av_frame_ref(s->last_frame, (AVFrame*)pict);
         if (ret < 0)
@@ -492,6 +504,8 @@ AVCodec ff_gif_encoder = {
     .init           = gif_encode_init,
     .encode2        = gif_encode_frame,
     .close          = gif_encode_close,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS,
+    .caps_internal  = FF_CODEC_CAP_ENCODE_PREV_FRAME,
     .pix_fmts       = (const enum AVPixelFormat[]){
         AV_PIX_FMT_RGB8, AV_PIX_FMT_BGR8, AV_PIX_FMT_RGB4_BYTE, AV_PIX_FMT_BGR4_BYTE,
         AV_PIX_FMT_GRAY8, AV_PIX_FMT_PAL8, AV_PIX_FMT_NONE
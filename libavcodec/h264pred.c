@@ -600,4 +600,6 @@ av_cold void ff_h264_pred_init(H264PredContext *h, int codec_id,
         ff_h264_pred_init_x86(h, codec_id, bit_depth, chroma_format_idc);
     if (ARCH_MIPS)
         ff_h264_pred_init_mips(h, codec_id, bit_depth, chroma_format_idc);
+    if (ARCH_WASM)
+        ff_h264_pred_init_wasm(h, codec_id, bit_depth, chroma_format_idc);
 }
@@ -24,7 +24,7 @@
 
 #include "hevcdsp.h"
 
-static const int8_t transform[32][32] = {
+const int8_t ff_hevc_transform[32][32] = {
     { 64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,
       64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64,  64 },
     { 90,  90,  88,  85,  82,  78,  73,  67,  61,  54,  46,  38,  31,  22,  13,   4,
@@ -265,4 +265,6 @@ int i = 0;
         ff_hevc_dsp_init_x86(hevcdsp, bit_depth);
     if (ARCH_MIPS)
         ff_hevc_dsp_init_mips(hevcdsp, bit_depth);
+    if (ARCH_WASM)
+        ff_hevc_dsp_init_wasm(hevcdsp, bit_depth);
 }
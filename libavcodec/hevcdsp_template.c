@@ -188,7 +188,7 @@ static void FUNC(transform_4x4_luma)(int16_t *coeffs)
         int o_8[4] = { 0 };                                       \
         for (i = 0; i < 4; i++)                                   \
             for (j = 1; j < end; j += 2)                          \
-                o_8[i] += transform[4 * j][i] * src[j * sstep];   \
+                o_8[i] += ff_hevc_transform[4 * j][i] * src[j * sstep]; \
         TR_4(e_8, src, 1, 2 * sstep, SET, 4);                     \
                                                                   \
         for (i = 0; i < 4; i++) {                                 \
@@ -204,7 +204,7 @@ static void FUNC(transform_4x4_luma)(int16_t *coeffs)
         int o_16[8] = { 0 };                                      \
         for (i = 0; i < 8; i++)                                   \
             for (j = 1; j < end; j += 2)                          \
-                o_16[i] += transform[2 * j][i] * src[j * sstep];  \
+                o_16[i] += ff_hevc_transform[2 * j][i] * src[j * sstep]; \
         TR_8(e_16, src, 1, 2 * sstep, SET, 8);                    \
                                                                   \
         for (i = 0; i < 8; i++) {                                 \
@@ -220,7 +220,7 @@ static void FUNC(transform_4x4_luma)(int16_t *coeffs)
         int o_32[16] = { 0 };                                     \
         for (i = 0; i < 16; i++)                                  \
             for (j = 1; j < end; j += 2)                          \
-                o_32[i] += transform[j][i] * src[j * sstep];      \
+                o_32[i] += ff_hevc_transform[j][i] * src[j * sstep]; \
         TR_16(e_32, src, 1, 2 * sstep, SET, end / 2);             \
                                                                   \
         for (i = 0; i < 16; i++) {                                \
@@ -73,6 +73,13 @@
  * uses ff_thread_report/await_progress().
  */
 #define FF_CODEC_CAP_ALLOCATE_PROGRESS      (1 << 6)
+/**
+ * The encoder depends on the previous input frame and on the first input
+ * frame of the stream. With frame threading, they are passed with each
+ * frame in AVCodecInternal.prev_frame and AVCodecInternal.first_frame, and
+ * AVCodecContext.frame_number is the index of the frame being encoded.
+ */
+#define FF_CODEC_CAP_ENCODE_PREV_FRAME      (1 << 7)
 
 /**
  * AVCodec.codec_tags termination value
@@ -151,6 +158,14 @@ typedef struct AVCodecInternal {
 
     void *frame_thread_encoder;
 
+    /**
+     * Frame-threaded encoding with FF_CODEC_CAP_ENCODE_PREV_FRAME: the input
+     * frame submitted before the one being encoded (NULL for the first one),
+     * and the first input frame of the stream.
+     */
+    const AVFrame *prev_frame;
+    const AVFrame *first_frame;
+
     /**
      * Number of audio samples to skip at the start of the next decoded frame
      */
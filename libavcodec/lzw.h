@@ -32,8 +32,6 @@
 
 #include <stdint.h>
 
-struct PutBitContext;
-
 enum FF_LZW_MODES{
     FF_LZW_GIF,
     FF_LZW_TIFF
@@ -54,10 +52,8 @@ struct LZWEncodeState;
 extern const int ff_lzw_encode_state_size;
 
 void ff_lzw_encode_init(struct LZWEncodeState *s, uint8_t *outbuf, int outsize,
-                        int maxbits, enum FF_LZW_MODES mode,
-                        void (*lzw_put_bits)(struct PutBitContext *, int, unsigned int));
+                        int maxbits, enum FF_LZW_MODES mode);
 int ff_lzw_encode(struct LZWEncodeState * s, const uint8_t * inbuf, int insize);
-int ff_lzw_encode_flush(struct LZWEncodeState *s,
-                        void (*lzw_flush_put_bits)(struct PutBitContext *));
+int ff_lzw_encode_flush(struct LZWEncodeState *s);
 
 #endif /* AVCODEC_LZW_H */
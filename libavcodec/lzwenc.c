@@ -25,137 +25,112 @@
  * @author Bartlomiej Wolowiec
  */
 
+#include "libavutil/avassert.h"
+#include "libavutil/intreadwrite.h"
 #include "avcodec.h"
 #include "lzw.h"
-#include "mathops.h"
-#include "put_bits.h"
 
 #define LZW_MAXBITS 12
 #define LZW_SIZTABLE (1<<LZW_MAXBITS)
-#define LZW_HASH_SIZE 16411
-#define LZW_HASH_SHIFT 6
+#define LZW_HASH_BITS 13
+#define LZW_HASH_SIZE (1<<LZW_HASH_BITS) ///< twice the number of codes, so probe chains stay short
 
 #define LZW_PREFIX_EMPTY -1
-#define LZW_PREFIX_FREE -2
 
-/** One code in hash table */
-typedef struct Code{
-    /// Hash code of prefix, LZW_PREFIX_EMPTY if empty prefix, or LZW_PREFIX_FREE if no code
-    int hash_prefix;
-    int code;               ///< LZW code
-    uint8_t suffix;         ///< Last character in code block
-}Code;
+/**
+ * One code in the hash table, packed in 32 bits so that a probe touches a
+ * single word: the prefix code and the last character of the block in the
+ * upper 20 bits, the LZW code in the lower 12. Single characters are not
+ * stored, so the code of a used entry is never 0 and 0 marks a free one.
+ */
+#define CODE_KEY(prefix, suffix) ((uint32_t)(prefix) << 8 | (suffix))
+#define ENTRY(key, code)         ((key) << LZW_MAXBITS | (code))
+#define ENTRY_KEY(e)             ((e) >> LZW_MAXBITS)
+#define ENTRY_CODE(e)            ((e) & (LZW_SIZTABLE - 1))
 
 /** LZW encode state */
 typedef struct LZWEncodeState {
     int clear_code;          ///< Value of clear code
     int end_code;            ///< Value of end code
-    Code tab[LZW_HASH_SIZE]; ///< Hash table
+    uint32_t tab[LZW_HASH_SIZE]; ///< Hash table
     int tabsize;             ///< Number of values in hash table
     int bits;                ///< Actual bits code
     int bufsize;             ///< Size of output buffer
-    PutBitContext pb;        ///< Put bit context for output
+    uint8_t *buf;            ///< Output buffer
+    uint8_t *buf_ptr;        ///< Current position in the output buffer
+    uint8_t *buf_end;
+    uint64_t bit_buf;        ///< Bits not written to the output buffer yet
+    int bit_count;           ///< Number of bits in bit_buf
     int maxbits;             ///< Max bits code
     int maxcode;             ///< Max value of code
     int output_bytes;        ///< Number of written bytes
     int last_code;           ///< Value of last output code or LZW_PREFIX_EMPTY
     enum FF_LZW_MODES mode;  ///< TIFF or GIF
-    void (*put_bits)(PutBitContext *, int, unsigned); ///< GIF is LE while TIFF is BE
 }LZWEncodeState;
 
 
 const int ff_lzw_encode_state_size = sizeof(LZWEncodeState);
 
 /**
- * Hash function adding character
- * @param head LZW code for prefix
- * @param add Character to add
- * @return New hash value
- */
-static inline int hash(int head, const int add)
-{
-    head ^= (add << LZW_HASH_SHIFT);
-    if (head >= LZW_HASH_SIZE)
-        head -= LZW_HASH_SIZE;
-    av_assert2(head >= 0 && head < LZW_HASH_SIZE);
-    return head;
-}
-
-/**
- * Hash function calculates next hash value
- * @param head Actual hash code
- * @param offset Offset calculated by hashOffset
- * @return New hash value
- */
-static inline int hashNext(int head, const int offset)
-{
-    head -= offset;
-    if(head < 0)
-        head += LZW_HASH_SIZE;
-    return head;
-}
-
-/**
- * Hash function calculates hash offset
- * @param head Actual hash code
- * @return Hash offset
+ * Hash function
+ * @param key Prefix code and character, as packed by CODE_KEY()
+ * @return Hash value
  */
-static inline int hashOffset(const int head)
+static inline unsigned hash(uint32_t key)
 {
-    return head ? LZW_HASH_SIZE - head : 1;
+    return (key * 0x9E3779B1U) >> (32 - LZW_HASH_BITS);
 }
 
 /**
- * Write one code to stream
+ * Write one code to stream, 32 bits at a time; GIF is LE while TIFF is BE
  * @param s LZW state
  * @param c code to write
  */
-static inline void writeCode(LZWEncodeState * s, int c)
+static av_always_inline void writeCode(LZWEncodeState *s, int c, int bits)
 {
-    av_assert2(0 <= c && c < 1 << s->bits);
-    s->put_bits(&s->pb, s->bits, c);
-}
-
-
-/**
- * Find LZW code for block
- * @param s LZW state
- * @param c Last character in block
- * @param hash_prefix LZW code for prefix
- * @return LZW code for block or -1 if not found in table
- */
-static inline int findCode(LZWEncodeState * s, uint8_t c, int hash_prefix)
-{
-    int h = hash(FFMAX(hash_prefix, 0), c);
-    int hash_offset = hashOffset(h);
+    av_assert2(0 <= c && c < 1 << bits);
+    if (s->mode == FF_LZW_GIF)
+        s->bit_buf |= (uint64_t)c << s->bit_count;
+    else
+        s->bit_buf = s->bit_buf << bits | c;
+    s->bit_count += bits;
 
-    while (s->tab[h].hash_prefix != LZW_PREFIX_FREE) {
-        if ((s->tab[h].suffix == c)
-            && (s->tab[h].hash_prefix == hash_prefix))
-            return h;
-        h = hashNext(h, hash_offset);
+    if (s->bit_count >= 32) {
+        s->bit_count -= 32;
+        if (s->buf_end - s->buf_ptr >= 4) {
+            if (s->mode == FF_LZW_GIF) {
+                AV_WL32(s->buf_ptr, s->bit_buf);
+                s->bit_buf >>= 32;
+            } else {
+                AV_WB32(s->buf_ptr, s->bit_buf >> s->bit_count);
+            }
+            s->buf_ptr += 4;
+        } else {
+            av_log(NULL, AV_LOG_ERROR, "LZW output buffer too small\n");
+            s->bit_buf = 0;
+            s->bit_count = 0;
+        }
     }
-
-    return h;
 }
 
 /**
- * Add block to LZW code table
+ * Write the bits left in the bit buffer, padding the last byte with zeros
  * @param s LZW state
- * @param c Last character in block
- * @param hash_prefix LZW code for prefix
- * @param hash_code LZW code for bytes block
  */
-static inline void addCode(LZWEncodeState * s, uint8_t c, int hash_prefix, int hash_code)
+static void flushBits(LZWEncodeState *s)
 {
-    s->tab[hash_code].code = s->tabsize;
-    s->tab[hash_code].suffix = c;
-    s->tab[hash_code].hash_prefix = hash_prefix;
-
-    s->tabsize++;
-
-    if (s->tabsize >= (1 << s->bits) + (s->mode == FF_LZW_GIF))
-        s->bits++;
+    while (s->bit_count > 0 && s->buf_ptr < s->buf_end) {
+        if (s->mode == FF_LZW_GIF) {
+            *s->buf_ptr++ = s->bit_buf;
+            s->bit_buf >>= 8;
+        } else {
+            *s->buf_ptr++ = s->bit_count >= 8 ? s->bit_buf >> (s->bit_count - 8)
+                                              : s->bit_buf << (8 - s->bit_count);
+        }
+        s->bit_count -= 8;
+    }
+    s->bit_buf = 0;
+    s->bit_count = 0;
 }
 
 /**
@@ -164,19 +139,9 @@ static inline void addCode(LZWEncodeState * s, uint8_t c, int hash_prefix, int h
  */
 static void clearTable(LZWEncodeState * s)
 {
-    int i, h;
-
-    writeCode(s, s->clear_code);
+    writeCode(s, s->clear_code, s->bits);
     s->bits = 9;
-    for (i = 0; i < LZW_HASH_SIZE; i++) {
-        s->tab[i].hash_prefix = LZW_PREFIX_FREE;
-    }
-    for (i = 0; i < 256; i++) {
-        h = hash(0, i);
-        s->tab[h].code = i;
-        s->tab[h].suffix = i;
-        s->tab[h].hash_prefix = LZW_PREFIX_EMPTY;
-    }
+    memset(s->tab, 0, sizeof(s->tab));
     s->tabsize = 258;
 }
 
@@ -186,7 +151,7 @@ static void clearTable(LZWEncodeState * s)
  * @return Number of bytes written
  */
 static int writtenBytes(LZWEncodeState *s){
-    int ret = put_bits_count(&s->pb) >> 3;
+    int ret = ((s->buf_ptr - s->buf) * 8 + s->bit_count) >> 3;
     ret -= s->output_bytes;
     s->output_bytes += ret;
     return ret;
@@ -200,13 +165,15 @@ static int writtenBytes(LZWEncodeState *s){
  * @param maxbits Maximum length of code
  */
 void ff_lzw_encode_init(LZWEncodeState *s, uint8_t *outbuf, int outsize,
-                        int maxbits, enum FF_LZW_MODES mode,
-                        void (*lzw_put_bits)(PutBitContext *, int, unsigned))
+                        int maxbits, enum FF_LZW_MODES mode)
 {
     s->clear_code = 256;
     s->end_code = 257;
     s->maxbits = maxbits;
-    init_put_bits(&s->pb, outbuf, outsize);
+    s->buf = s->buf_ptr = outbuf;
+    s->buf_end = outbuf + outsize;
+    s->bit_buf = 0;
+    s->bit_count = 0;
     s->bufsize = outsize;
     av_assert0(s->maxbits >= 9 && s->maxbits <= LZW_MAXBITS);
     s->maxcode = 1 << s->maxbits;
@@ -214,7 +181,6 @@ void ff_lzw_encode_init(LZWEncodeState *s, uint8_t *outbuf, int outsize,
     s->last_code = LZW_PREFIX_EMPTY;
     s->bits = 9;
     s->mode = mode;
-    s->put_bits = lzw_put_bits;
 }
 
 /**
@@ -226,29 +192,56 @@ void ff_lzw_encode_init(LZWEncodeState *s, uint8_t *outbuf, int outsize,
  */
 int ff_lzw_encode(LZWEncodeState * s, const uint8_t * inbuf, int insize)
 {
-    int i;
+    const uint8_t *end = inbuf + insize;
+    const int gif = s->mode == FF_LZW_GIF;
+    int code = s->last_code, bits = s->bits, tabsize = s->tabsize;
 
     if(insize * 3 > (s->bufsize - s->output_bytes) * 2){
         return -1;
     }
 
-    if (s->last_code == LZW_PREFIX_EMPTY)
+    if (code == LZW_PREFIX_EMPTY) {
         clearTable(s);
+        bits = s->bits;
+        tabsize = s->tabsize;
+        if (!insize)
+            return writtenBytes(s);
+        code = *inbuf++;
+    }
+
+    while (inbuf < end) {
+        const uint8_t c = *inbuf++;
+        const uint32_t key = CODE_KEY(code, c);
+        unsigned h = hash(key);
+        uint32_t e;
 
-    for (i = 0; i < insize; i++) {
-        uint8_t c = *inbuf++;
-        int code = findCode(s, c, s->last_code);
-        if (s->tab[code].hash_prefix == LZW_PREFIX_FREE) {
-            writeCode(s, s->last_code);
-            addCode(s, c, s->last_code, code);
-            code= hash(0, c);
+        while ((e = s->tab[h]) && ENTRY_KEY(e) != key)
+            h = (h + 1) & (LZW_HASH_SIZE - 1);
+
+        if (e) {
+            code = ENTRY_CODE(e);
+            continue;
         }
-        s->last_code = s->tab[code].code;
-        if (s->tabsize >= s->maxcode - 1) {
+
+        writeCode(s, code, bits);
+        s->tab[h] = ENTRY(key, tabsize);
+        tabsize++;
+        if (tabsize >= (1 << bits) + gif)
+            bits++;
+        code = c;
+
+        if (tabsize >= s->maxcode - 1) {
+            s->bits = bits;
             clearTable(s);
+            bits = s->bits;
+            tabsize = s->tabsize;
         }
     }
 
+    s->last_code = code;
+    s->bits = bits;
+    s->tabsize = tabsize;
+
     return writtenBytes(s);
 }
 
@@ -257,16 +250,15 @@ int ff_lzw_encode(LZWEncodeState * s, const uint8_t * inbuf, int insize)
  * @param s LZW state
  * @return Number of bytes written or -1 on error
  */
-int ff_lzw_encode_flush(LZWEncodeState *s,
-                        void (*lzw_flush_put_bits)(PutBitContext *))
+int ff_lzw_encode_flush(LZWEncodeState *s)
 {
     if (s->last_code != -1)
-        writeCode(s, s->last_code);
-    writeCode(s, s->end_code);
+        writeCode(s, s->last_code, s->bits);
+    writeCode(s, s->end_code, s->bits);
     if (s->mode == FF_LZW_GIF)
-        s->put_bits(&s->pb, 1, 0);
+        writeCode(s, 0, 1);
 
-    lzw_flush_put_bits(&s->pb);
+    flushBits(s);
     s->last_code = -1;
 
     return writtenBytes(s);
@@ -0,0 +1,130 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Prints the size and CRC of the LZW coded output of a set of synthetic
+ * images. With -b, times the encoder on each of them instead.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/crc.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavcodec/lzw.h"
+
+#define WIDTH  640
+#define HEIGHT 480
+
+static const char *const pattern_names[] = {
+    "flat", "gradient", "stripes", "dither", "noise16", "noise256",
+};
+
+static void fill_pattern(uint8_t *buf, int pattern, AVLFG *lfg)
+{
+    int x, y;
+
+    for (y = 0; y < HEIGHT; y++) {
+        for (x = 0; x < WIDTH; x++) {
+            uint8_t *p = &buf[y * WIDTH + x];
+
+            switch (pattern) {
+            case 0: *p = 42;                                          break;
+            case 1: *p = (x + y) >> 2;                                break;
+            case 2: *p = (x / 7 + y / 5) & 15;                        break;
+            case 3: *p = ((x + y) >> 3) + (av_lfg_get(lfg) & 3);      break;
+            case 4: *p = av_lfg_get(lfg) & 15;                        break;
+            case 5: *p = av_lfg_get(lfg);                             break;
+            }
+        }
+    }
+}
+
+/* code the image a line at a time, as the GIF and TIFF encoders do */
+static int encode(struct LZWEncodeState *s, uint8_t *out, int out_size,
+                  const uint8_t *in, int maxbits, enum FF_LZW_MODES mode)
+{
+    int y, ret, len = 0;
+
+    ff_lzw_encode_init(s, out, out_size, maxbits, mode);
+    for (y = 0; y < HEIGHT; y++) {
+        if ((ret = ff_lzw_encode(s, in + y * WIDTH, WIDTH)) < 0)
+            return ret;
+        len += ret;
+    }
+    return len + ff_lzw_encode_flush(s);
+}
+
+int main(int argc, char **argv)
+{
+    static const int maxbits[] = { 9, 12 };
+    const int out_size = WIDTH * HEIGHT * 2;
+    const AVCRC *crc_table = av_crc_get_table(AV_CRC_32_IEEE_LE);
+    struct LZWEncodeState *s = av_malloc(ff_lzw_encode_state_size);
+    uint8_t *in  = av_malloc(WIDTH * HEIGHT);
+    uint8_t *out = av_malloc(out_size);
+    int bench = argc > 1 && !strcmp(argv[1], "-b");
+    int pattern, mode, i, j, ret = 0;
+    AVLFG lfg;
+
+    if (!s || !in || !out) {
+        ret = 1;
+        goto end;
+    }
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+    for (pattern = 0; pattern < FF_ARRAY_ELEMS(pattern_names); pattern++) {
+        fill_pattern(in, pattern, &lfg);
+        for (mode = FF_LZW_GIF; mode <= FF_LZW_TIFF; mode++) {
+            for (i = 0; i < FF_ARRAY_ELEMS(maxbits); i++) {
+                int len = encode(s, out, out_size, in, maxbits[i], mode);
+
+                if (len < 0) {
+                    fprintf(stderr, "%s: encoding failed\n", pattern_names[pattern]);
+                    ret = 1;
+                    goto end;
+                }
+
+                if (bench) {
+                    const int runs = 50;
+                    int64_t t = av_gettime_relative();
+                    for (j = 0; j < runs; j++)
+                        encode(s, out, out_size, in, maxbits[i], mode);
+                    t = av_gettime_relative() - t;
+                    printf("%-8s %s %2d bits: %7.1f MB/s\n", pattern_names[pattern],
+                           mode == FF_LZW_GIF ? "gif " : "tiff", maxbits[i],
+                           (double)WIDTH * HEIGHT * runs / FFMAX(t, 1));
+                } else {
+                    printf("%-8s %s %2d bits: %6d bytes, crc %08x\n", pattern_names[pattern],
+                           mode == FF_LZW_GIF ? "gif " : "tiff", maxbits[i], len,
+                           av_crc(crc_table, 0, out, len));
+                }
+            }
+        }
+    }
+
+end:
+    av_free(s);
+    av_free(in);
+    av_free(out);
+    return ret;
+}
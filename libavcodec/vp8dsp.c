@@ -681,6 +681,8 @@ av_cold void ff_vp78dsp_init(VP8DSPContext *dsp)
         ff_vp78dsp_init_ppc(dsp);
     if (ARCH_X86)
         ff_vp78dsp_init_x86(dsp);
+    if (ARCH_WASM)
+        ff_vp78dsp_init_wasm(dsp);
 }
 
 #if CONFIG_VP7_DECODER
@@ -743,5 +745,7 @@ av_cold void ff_vp8dsp_init(VP8DSPContext *dsp)
         ff_vp8dsp_init_x86(dsp);
     if (ARCH_MIPS)
         ff_vp8dsp_init_mips(dsp);
+    if (ARCH_WASM)
+        ff_vp8dsp_init_wasm(dsp);
 }
 #endif /* CONFIG_VP8_DECODER */
@@ -0,0 +1,39 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/wasm/cpu.h"
+#include "libavcodec/h264chroma.h"
+#include "h264dsp_wasm.h"
+
+av_cold void ff_h264chroma_init_wasm(H264ChromaContext *c, int bit_depth)
+{
+#if HAVE_SIMD128
+    int cpu_flags = av_get_cpu_flags();
+
+    if (!have_simd128(cpu_flags) || bit_depth > 8)
+        return;
+
+    c->put_h264_chroma_pixels_tab[0] = ff_put_h264_chroma_mc8_8_simd128;
+    c->put_h264_chroma_pixels_tab[1] = ff_put_h264_chroma_mc4_8_simd128;
+    c->avg_h264_chroma_pixels_tab[0] = ff_avg_h264_chroma_mc8_8_simd128;
+    c->avg_h264_chroma_pixels_tab[1] = ff_avg_h264_chroma_mc4_8_simd128;
+#endif /* HAVE_SIMD128 */
+}
@@ -0,0 +1,114 @@
+/*
+ * H.264 chroma motion compensation, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/avassert.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "h264dsp_wasm.h"
+
+static av_always_inline vec_s16 load(const uint8_t *src, int w)
+{
+    return w == 8 ? vec_ld_u8_s16(src) : vec_ld4_u8_s16(src);
+}
+
+static av_always_inline void store(uint8_t *dst, vec_s16 v, int w, int avg)
+{
+    v = (v + 32) >> 6;
+    if (avg)
+        v = (v + load(dst, w) + 1) >> 1;
+    if (w == 8)
+        vec_st8_u8(dst, vec_packus_s16(v, v));
+    else
+        vec_st4_u8(dst, vec_packus_s16(v, v));
+}
+
+/*
+ * All intermediates stay below 64 * 255, so 16-bit lanes are exact. The
+ * branches follow the C code so that no more source pixels are read.
+ */
+static av_always_inline void chroma_mc(uint8_t *dst, const uint8_t *src,
+                                       ptrdiff_t stride, int h, int x, int y,
+                                       int w, int avg)
+{
+    const int A = (8 - x) * (8 - y);
+    const int B = (    x) * (8 - y);
+    const int C = (8 - x) * (    y);
+    const int D = (    x) * (    y);
+    vec_s16 va = vec_splat_s16(A);
+    int i;
+
+    av_assert2(x < 8 && y < 8 && x >= 0 && y >= 0);
+
+    if (D) {
+        vec_s16 vb = vec_splat_s16(B);
+        vec_s16 vc = vec_splat_s16(C);
+        vec_s16 vd = vec_splat_s16(D);
+        vec_s16 s0 = load(src,     w);
+        vec_s16 s1 = load(src + 1, w);
+
+        for (i = 0; i < h; i++) {
+            vec_s16 t0 = load(src + stride,     w);
+            vec_s16 t1 = load(src + stride + 1, w);
+            store(dst, va * s0 + vb * s1 + vc * t0 + vd * t1, w, avg);
+            s0 = t0;
+            s1 = t1;
+            dst += stride;
+            src += stride;
+        }
+    } else if (B + C) {
+        vec_s16 ve = vec_splat_s16(B + C);
+        const ptrdiff_t step = C ? stride : 1;
+
+        for (i = 0; i < h; i++) {
+            store(dst, va * load(src, w) + ve * load(src + step, w), w, avg);
+            dst += stride;
+            src += stride;
+        }
+    } else {
+        for (i = 0; i < h; i++) {
+            store(dst, va * load(src, w), w, avg);
+            dst += stride;
+            src += stride;
+        }
+    }
+}
+
+void ff_put_h264_chroma_mc8_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y)
+{
+    chroma_mc(dst, src, stride, h, x, y, 8, 0);
+}
+
+void ff_put_h264_chroma_mc4_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y)
+{
+    chroma_mc(dst, src, stride, h, x, y, 4, 0);
+}
+
+void ff_avg_h264_chroma_mc8_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y)
+{
+    chroma_mc(dst, src, stride, h, x, y, 8, 1);
+}
+
+void ff_avg_h264_chroma_mc4_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y)
+{
+    chroma_mc(dst, src, stride, h, x, y, 4, 1);
+}
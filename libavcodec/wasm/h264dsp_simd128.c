@@ -0,0 +1,490 @@
+/*
+ * H.264 weighted prediction and loop filter, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "h264dsp_wasm.h"
+
+/***********************************************************************
+ * Weighted prediction
+ **********************************************************************/
+
+/*
+ * The offset is a multiple of 1 << log2_denom plus the rounding term, so
+ * (x * weight + offset) >> log2_denom is computed as
+ * ((x * weight + round) >> log2_denom) + (offset >> log2_denom), which stays
+ * within 16 bits.
+ */
+static av_always_inline vec_s16 weight8(vec_s16 pix, vec_s16 weight,
+                                        vec_s16 round, vec_s16 offset,
+                                        int log2_denom)
+{
+    return ((pix * weight + round) >> log2_denom) + offset;
+}
+
+static av_always_inline void weight_h264(uint8_t *block, ptrdiff_t stride,
+                                         int height, int log2_denom,
+                                         int weight, int offset, int w)
+{
+    const vec_s16 wv = vec_splat_s16(weight);
+    const vec_s16 rv = vec_splat_s16(log2_denom ? 1 << (log2_denom - 1) : 0);
+    const vec_s16 ov = vec_splat_s16(offset);
+    int y;
+
+    for (y = 0; y < height; y++, block += stride) {
+        if (w == 16) {
+            vec_u8 pix = vec_ld_u8(block);
+            vec_s16 lo = weight8(vec_lo_u8_s16(pix), wv, rv, ov, log2_denom);
+            vec_s16 hi = weight8(vec_hi_u8_s16(pix), wv, rv, ov, log2_denom);
+            vec_st_u8(block, vec_packus_s16(lo, hi));
+        } else if (w == 8) {
+            vec_s16 lo = weight8(vec_ld_u8_s16(block), wv, rv, ov, log2_denom);
+            vec_st8_u8(block, vec_packus_s16(lo, lo));
+        } else {
+            vec_s16 lo = weight8(vec_ld4_u8_s16(block), wv, rv, ov, log2_denom);
+            vec_st4_u8(block, vec_packus_s16(lo, lo));
+        }
+    }
+}
+
+/* The sum of both weighted pixels can exceed 16 bits, use 32-bit lanes. */
+static av_always_inline vec_s16 biweight8(vec_s16 d, vec_s16 s,
+                                          vec_s32 wd, vec_s32 ws,
+                                          vec_s32 offset, int shift)
+{
+    vec_s32 lo = vec_lo_s16_s32(d) * wd + vec_lo_s16_s32(s) * ws + offset;
+    vec_s32 hi = vec_hi_s16_s32(d) * wd + vec_hi_s16_s32(s) * ws + offset;
+    return vec_packs_s32(lo >> shift, hi >> shift);
+}
+
+static av_always_inline void biweight_h264(uint8_t *dst, uint8_t *src,
+                                           ptrdiff_t stride, int height,
+                                           int log2_denom, int weightd,
+                                           int weights, int offset, int w)
+{
+    const vec_s32 wd = vec_splat_s32(weightd);
+    const vec_s32 ws = vec_splat_s32(weights);
+    const vec_s32 ov = vec_splat_s32((unsigned)((offset + 1) | 1) << log2_denom);
+    const int shift  = log2_denom + 1;
+    int y;
+
+    for (y = 0; y < height; y++, dst += stride, src += stride) {
+        if (w == 16) {
+            vec_u8 d = vec_ld_u8(dst), s = vec_ld_u8(src);
+            vec_s16 lo = biweight8(vec_lo_u8_s16(d), vec_lo_u8_s16(s), wd, ws, ov, shift);
+            vec_s16 hi = biweight8(vec_hi_u8_s16(d), vec_hi_u8_s16(s), wd, ws, ov, shift);
+            vec_st_u8(dst, vec_packus_s16(lo, hi));
+        } else if (w == 8) {
+            vec_s16 lo = biweight8(vec_ld_u8_s16(dst), vec_ld_u8_s16(src), wd, ws, ov, shift);
+            vec_st8_u8(dst, vec_packus_s16(lo, lo));
+        } else {
+            vec_s16 lo = biweight8(vec_ld4_u8_s16(dst), vec_ld4_u8_s16(src), wd, ws, ov, shift);
+            vec_st4_u8(dst, vec_packus_s16(lo, lo));
+        }
+    }
+}
+
+#define H264_WEIGHT(W)                                                          \
+void ff_h264_weight_pixels ## W ## _8_simd128(uint8_t *block, ptrdiff_t stride, \
+                                              int height, int log2_denom,       \
+                                              int weight, int offset)           \
+{                                                                               \
+    weight_h264(block, stride, height, log2_denom, weight, offset, W);          \
+}                                                                               \
+                                                                                \
+void ff_h264_biweight_pixels ## W ## _8_simd128(uint8_t *dst, uint8_t *src,     \
+                                                ptrdiff_t stride, int height,   \
+                                                int log2_denom, int weightd,    \
+                                                int weights, int offset)        \
+{                                                                               \
+    biweight_h264(dst, src, stride, height, log2_denom,                         \
+                  weightd, weights, offset, W);                                 \
+}
+
+H264_WEIGHT(16)
+H264_WEIGHT(8)
+H264_WEIGHT(4)
+
+/***********************************************************************
+ * Loop filter
+ **********************************************************************/
+
+/* Expand the 4 tc0 values to one per lane, each covering n lanes. */
+static av_always_inline vec_s16 expand_tc(const int8_t *tc0, int n)
+{
+    vec_s16 tc;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        tc[i] = tc0[i / n];
+    return tc;
+}
+
+/*
+ * Normal luma filter on 8 lanes of 16-bit pixels.
+ * tc holds tc0 per lane, lanes with a negative tc0 are left untouched.
+ */
+static av_always_inline void luma_filter(vec_s16 *p2, vec_s16 *p1, vec_s16 *p0,
+                                         vec_s16 *q0, vec_s16 *q1, vec_s16 *q2,
+                                         vec_s16 alpha, vec_s16 beta, vec_s16 tc0)
+{
+    const vec_s16 zero = { 0 }, max = zero + 255;
+    vec_s16 mask = (vec_abs_s16(*p0 - *q0) < alpha) &
+                   (vec_abs_s16(*p1 - *p0) < beta)  &
+                   (vec_abs_s16(*q1 - *q0) < beta)  &
+                   (tc0 >= 0);
+    vec_s16 ap   = (vec_abs_s16(*p2 - *p0) < beta) & mask;
+    vec_s16 aq   = (vec_abs_s16(*q2 - *q0) < beta) & mask;
+    vec_s16 avg  = (*p0 + *q0 + 1) >> 1;
+    vec_s16 p1n  = *p1 + vec_clip_s16(((*p2 + avg) >> 1) - *p1, -tc0, tc0);
+    vec_s16 q1n  = *q1 + vec_clip_s16(((*q2 + avg) >> 1) - *q1, -tc0, tc0);
+    /* the masks are -1 where set */
+    vec_s16 tc   = tc0 - ap - aq;
+    vec_s16 delta = vec_clip_s16((((*q0 - *p0) * 4) + (*p1 - *q1) + 4) >> 3, -tc, tc);
+    vec_s16 p0n  = vec_clip_s16(*p0 + delta, zero, max);
+    vec_s16 q0n  = vec_clip_s16(*q0 - delta, zero, max);
+
+    *p1 = vec_sel(ap,   p1n, *p1);
+    *q1 = vec_sel(aq,   q1n, *q1);
+    *p0 = vec_sel(mask, p0n, *p0);
+    *q0 = vec_sel(mask, q0n, *q0);
+}
+
+/* Strong luma filter for intra edges on 8 lanes of 16-bit pixels. */
+static av_always_inline void luma_intra_filter(vec_s16 *p3, vec_s16 *p2, vec_s16 *p1,
+                                               vec_s16 *p0, vec_s16 *q0, vec_s16 *q1,
+                                               vec_s16 *q2, vec_s16 *q3,
+                                               vec_s16 alpha, vec_s16 beta)
+{
+    vec_s16 d0     = vec_abs_s16(*p0 - *q0);
+    vec_s16 mask   = (d0 < alpha) &
+                     (vec_abs_s16(*p1 - *p0) < beta) &
+                     (vec_abs_s16(*q1 - *q0) < beta);
+    vec_s16 strong = (d0 < (alpha >> 2) + 2) & mask;
+    vec_s16 ap     = (vec_abs_s16(*p2 - *p0) < beta) & strong;
+    vec_s16 aq     = (vec_abs_s16(*q2 - *q0) < beta) & strong;
+    vec_s16 pq     = *p0 + *q0;
+    vec_s16 p0s = (*p2 + 2 * *p1 + 2 * pq + *q1 + 4) >> 3;
+    vec_s16 p1s = (*p2 + *p1 + pq + 2) >> 2;
+    vec_s16 p2s = (2 * *p3 + 3 * *p2 + *p1 + pq + 4) >> 3;
+    vec_s16 q0s = (*q2 + 2 * *q1 + 2 * pq + *p1 + 4) >> 3;
+    vec_s16 q1s = (*q2 + *q1 + pq + 2) >> 2;
+    vec_s16 q2s = (2 * *q3 + 3 * *q2 + *q1 + pq + 4) >> 3;
+    vec_s16 p0w = (2 * *p1 + *p0 + *q1 + 2) >> 2;
+    vec_s16 q0w = (2 * *q1 + *q0 + *p1 + 2) >> 2;
+
+    *p2 = vec_sel(ap, p2s, *p2);
+    *p1 = vec_sel(ap, p1s, *p1);
+    *p0 = vec_sel(mask, vec_sel(ap, p0s, p0w), *p0);
+    *q0 = vec_sel(mask, vec_sel(aq, q0s, q0w), *q0);
+    *q1 = vec_sel(aq, q1s, *q1);
+    *q2 = vec_sel(aq, q2s, *q2);
+}
+
+/* Chroma filter on 8 lanes, lanes with a tc0 <= 0 are left untouched. */
+static av_always_inline void chroma_filter(vec_s16 *p1, vec_s16 *p0,
+                                           vec_s16 *q0, vec_s16 *q1,
+                                           vec_s16 alpha, vec_s16 beta, vec_s16 tc)
+{
+    const vec_s16 zero = { 0 }, max = zero + 255;
+    vec_s16 mask = (vec_abs_s16(*p0 - *q0) < alpha) &
+                   (vec_abs_s16(*p1 - *p0) < beta)  &
+                   (vec_abs_s16(*q1 - *q0) < beta)  &
+                   (tc > 0);
+    vec_s16 delta = vec_clip_s16((((*q0 - *p0) * 4) + (*p1 - *q1) + 4) >> 3, -tc, tc);
+
+    *p0 = vec_sel(mask, vec_clip_s16(*p0 + delta, zero, max), *p0);
+    *q0 = vec_sel(mask, vec_clip_s16(*q0 - delta, zero, max), *q0);
+}
+
+static av_always_inline void chroma_intra_filter(vec_s16 *p1, vec_s16 *p0,
+                                                 vec_s16 *q0, vec_s16 *q1,
+                                                 vec_s16 alpha, vec_s16 beta)
+{
+    vec_s16 mask = (vec_abs_s16(*p0 - *q0) < alpha) &
+                   (vec_abs_s16(*p1 - *p0) < beta)  &
+                   (vec_abs_s16(*q1 - *q0) < beta);
+
+    *p0 = vec_sel(mask, (2 * *p1 + *p0 + *q1 + 2) >> 2, *p0);
+    *q0 = vec_sel(mask, (2 * *q1 + *q0 + *p1 + 2) >> 2, *q0);
+}
+
+/*
+ * Transpose 16 rows of 8 pixels, starting 4 pixels left of the edge, into
+ * 8 vectors of 16 pixels, p3 to q3, and back.
+ */
+static av_always_inline void load_transpose_16x8(const uint8_t *pix, ptrdiff_t stride,
+                                                 vec_u8 r[8])
+{
+    vec_s16 t[8];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        vec_u8 a = { 0 }, b = { 0 };
+        memcpy(&a, pix + (2 * i)     * stride - 4, 8);
+        memcpy(&b, pix + (2 * i + 1) * stride - 4, 8);
+        /* row pairs interleaved, bytes 2k and 2k + 1 are column k */
+        t[i] = (vec_s16)vec_mergel_u8(a, b);
+    }
+    /* transposing the 16-bit row pairs leaves each column in order */
+    VEC_TRANSPOSE8_S16(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7]);
+    for (i = 0; i < 8; i++)
+        r[i] = (vec_u8)t[i];
+}
+
+static av_always_inline void transpose_store_16x8(uint8_t *pix, ptrdiff_t stride,
+                                                  const vec_u8 r[8])
+{
+    vec_s16 t[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        t[i] = (vec_s16)r[i];
+    VEC_TRANSPOSE8_S16(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7]);
+    for (i = 0; i < 8; i++) {
+        vec_u8 v = vec_shuffle((vec_u8)t[i], (vec_u8)t[i],
+                               0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+        memcpy(pix + (2 * i)     * stride - 4, &v, 8);
+        memcpy(pix + (2 * i + 1) * stride - 4, (uint8_t *)&v + 8, 8);
+    }
+}
+
+static av_always_inline void luma_filter16(vec_u8 *p2, vec_u8 *p1, vec_u8 *p0,
+                                           vec_u8 *q0, vec_u8 *q1, vec_u8 *q2,
+                                           int alpha, int beta, const int8_t *tc0)
+{
+    const vec_s16 av = vec_splat_s16(alpha), bv = vec_splat_s16(beta);
+    vec_s16 p2l = vec_lo_u8_s16(*p2), p2h = vec_hi_u8_s16(*p2);
+    vec_s16 p1l = vec_lo_u8_s16(*p1), p1h = vec_hi_u8_s16(*p1);
+    vec_s16 p0l = vec_lo_u8_s16(*p0), p0h = vec_hi_u8_s16(*p0);
+    vec_s16 q0l = vec_lo_u8_s16(*q0), q0h = vec_hi_u8_s16(*q0);
+    vec_s16 q1l = vec_lo_u8_s16(*q1), q1h = vec_hi_u8_s16(*q1);
+    vec_s16 q2l = vec_lo_u8_s16(*q2), q2h = vec_hi_u8_s16(*q2);
+
+    luma_filter(&p2l, &p1l, &p0l, &q0l, &q1l, &q2l, av, bv, expand_tc(tc0,     4));
+    luma_filter(&p2h, &p1h, &p0h, &q0h, &q1h, &q2h, av, bv, expand_tc(tc0 + 2, 4));
+
+    *p1 = vec_packus_s16(p1l, p1h);
+    *p0 = vec_packus_s16(p0l, p0h);
+    *q0 = vec_packus_s16(q0l, q0h);
+    *q1 = vec_packus_s16(q1l, q1h);
+}
+
+static av_always_inline void luma_intra_filter16(vec_u8 *p3, vec_u8 *p2, vec_u8 *p1,
+                                                 vec_u8 *p0, vec_u8 *q0, vec_u8 *q1,
+                                                 vec_u8 *q2, vec_u8 *q3,
+                                                 int alpha, int beta)
+{
+    const vec_s16 av = vec_splat_s16(alpha), bv = vec_splat_s16(beta);
+    vec_s16 p3l = vec_lo_u8_s16(*p3), p3h = vec_hi_u8_s16(*p3);
+    vec_s16 p2l = vec_lo_u8_s16(*p2), p2h = vec_hi_u8_s16(*p2);
+    vec_s16 p1l = vec_lo_u8_s16(*p1), p1h = vec_hi_u8_s16(*p1);
+    vec_s16 p0l = vec_lo_u8_s16(*p0), p0h = vec_hi_u8_s16(*p0);
+    vec_s16 q0l = vec_lo_u8_s16(*q0), q0h = vec_hi_u8_s16(*q0);
+    vec_s16 q1l = vec_lo_u8_s16(*q1), q1h = vec_hi_u8_s16(*q1);
+    vec_s16 q2l = vec_lo_u8_s16(*q2), q2h = vec_hi_u8_s16(*q2);
+    vec_s16 q3l = vec_lo_u8_s16(*q3), q3h = vec_hi_u8_s16(*q3);
+
+    luma_intra_filter(&p3l, &p2l, &p1l, &p0l, &q0l, &q1l, &q2l, &q3l, av, bv);
+    luma_intra_filter(&p3h, &p2h, &p1h, &p0h, &q0h, &q1h, &q2h, &q3h, av, bv);
+
+    *p2 = vec_packus_s16(p2l, p2h);
+    *p1 = vec_packus_s16(p1l, p1h);
+    *p0 = vec_packus_s16(p0l, p0h);
+    *q0 = vec_packus_s16(q0l, q0h);
+    *q1 = vec_packus_s16(q1l, q1h);
+    *q2 = vec_packus_s16(q2l, q2h);
+}
+
+void ff_h264_v_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int alpha, int beta, int8_t *tc0)
+{
+    vec_u8 p2 = vec_ld_u8(pix - 3 * stride);
+    vec_u8 p1 = vec_ld_u8(pix - 2 * stride);
+    vec_u8 p0 = vec_ld_u8(pix - 1 * stride);
+    vec_u8 q0 = vec_ld_u8(pix);
+    vec_u8 q1 = vec_ld_u8(pix + 1 * stride);
+    vec_u8 q2 = vec_ld_u8(pix + 2 * stride);
+
+    luma_filter16(&p2, &p1, &p0, &q0, &q1, &q2, alpha, beta, tc0);
+
+    vec_st_u8(pix - 2 * stride, p1);
+    vec_st_u8(pix - 1 * stride, p0);
+    vec_st_u8(pix,              q0);
+    vec_st_u8(pix + 1 * stride, q1);
+}
+
+void ff_h264_h_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int alpha, int beta, int8_t *tc0)
+{
+    vec_u8 r[8];
+
+    load_transpose_16x8(pix, stride, r);
+    luma_filter16(&r[1], &r[2], &r[3], &r[4], &r[5], &r[6], alpha, beta, tc0);
+    transpose_store_16x8(pix, stride, r);
+}
+
+void ff_h264_v_loop_filter_luma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                int alpha, int beta)
+{
+    vec_u8 p3 = vec_ld_u8(pix - 4 * stride);
+    vec_u8 p2 = vec_ld_u8(pix - 3 * stride);
+    vec_u8 p1 = vec_ld_u8(pix - 2 * stride);
+    vec_u8 p0 = vec_ld_u8(pix - 1 * stride);
+    vec_u8 q0 = vec_ld_u8(pix);
+    vec_u8 q1 = vec_ld_u8(pix + 1 * stride);
+    vec_u8 q2 = vec_ld_u8(pix + 2 * stride);
+    vec_u8 q3 = vec_ld_u8(pix + 3 * stride);
+
+    luma_intra_filter16(&p3, &p2, &p1, &p0, &q0, &q1, &q2, &q3, alpha, beta);
+
+    vec_st_u8(pix - 3 * stride, p2);
+    vec_st_u8(pix - 2 * stride, p1);
+    vec_st_u8(pix - 1 * stride, p0);
+    vec_st_u8(pix,              q0);
+    vec_st_u8(pix + 1 * stride, q1);
+    vec_st_u8(pix + 2 * stride, q2);
+}
+
+void ff_h264_h_loop_filter_luma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                int alpha, int beta)
+{
+    vec_u8 r[8];
+
+    load_transpose_16x8(pix, stride, r);
+    luma_intra_filter16(&r[0], &r[1], &r[2], &r[3], &r[4], &r[5], &r[6], &r[7],
+                        alpha, beta);
+    transpose_store_16x8(pix, stride, r);
+}
+
+void ff_h264_v_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int alpha, int beta, int8_t *tc0)
+{
+    vec_s16 p1 = vec_ld_u8_s16(pix - 2 * stride);
+    vec_s16 p0 = vec_ld_u8_s16(pix - 1 * stride);
+    vec_s16 q0 = vec_ld_u8_s16(pix);
+    vec_s16 q1 = vec_ld_u8_s16(pix + 1 * stride);
+
+    chroma_filter(&p1, &p0, &q0, &q1, vec_splat_s16(alpha), vec_splat_s16(beta),
+                  expand_tc(tc0, 2));
+
+    vec_st8_u8(pix - stride, vec_packus_s16(p0, q0));
+    vec_st8_u8(pix, vec_packus_s16(q0, p0));
+}
+
+void ff_h264_v_loop_filter_chroma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                  int alpha, int beta)
+{
+    vec_s16 p1 = vec_ld_u8_s16(pix - 2 * stride);
+    vec_s16 p0 = vec_ld_u8_s16(pix - 1 * stride);
+    vec_s16 q0 = vec_ld_u8_s16(pix);
+    vec_s16 q1 = vec_ld_u8_s16(pix + 1 * stride);
+
+    chroma_intra_filter(&p1, &p0, &q0, &q1, vec_splat_s16(alpha), vec_splat_s16(beta));
+
+    vec_st8_u8(pix - stride, vec_packus_s16(p0, q0));
+    vec_st8_u8(pix, vec_packus_s16(q0, p0));
+}
+
+/*
+ * Horizontal chroma edges: 8 rows of 4 pixels around the edge are
+ * transposed into p1, p0, q0, q1 and only p0 and q0 are written back.
+ */
+static av_always_inline void load_transpose_8x4(const uint8_t *pix, ptrdiff_t stride,
+                                                vec_s16 *p1, vec_s16 *p0,
+                                                vec_s16 *q0, vec_s16 *q1)
+{
+    vec_u32 a, b;
+    vec_u8 t;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        a[i] = AV_RN32(pix + i       * stride - 2);
+        b[i] = AV_RN32(pix + (i + 4) * stride - 2);
+    }
+    t = vec_shuffle((vec_u8)a, (vec_u8)b,
+                    0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29);
+    *p1 = vec_lo_u8_s16(t);
+    *p0 = vec_hi_u8_s16(t);
+    t = vec_shuffle((vec_u8)a, (vec_u8)b,
+                    2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31);
+    *q0 = vec_lo_u8_s16(t);
+    *q1 = vec_hi_u8_s16(t);
+}
+
+static av_always_inline void store_8x2(uint8_t *pix, ptrdiff_t stride,
+                                       vec_s16 p0, vec_s16 q0)
+{
+    vec_u8 v = vec_packus_s16(p0, q0);
+    vec_u16 t = (vec_u16)vec_shuffle(v, v, 0, 8, 1, 9, 2, 10, 3, 11,
+                                           4, 12, 5, 13, 6, 14, 7, 15);
+    int i;
+
+    for (i = 0; i < 8; i++)
+        AV_WN16(pix + i * stride - 1, t[i]);
+}
+
+static av_always_inline void h_loop_filter_chroma8(uint8_t *pix, ptrdiff_t stride,
+                                                   int alpha, int beta,
+                                                   const int8_t *tc0, int n)
+{
+    vec_s16 p1, p0, q0, q1;
+
+    load_transpose_8x4(pix, stride, &p1, &p0, &q0, &q1);
+    chroma_filter(&p1, &p0, &q0, &q1, vec_splat_s16(alpha), vec_splat_s16(beta),
+                  expand_tc(tc0, n));
+    store_8x2(pix, stride, p0, q0);
+}
+
+void ff_h264_h_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int alpha, int beta, int8_t *tc0)
+{
+    h_loop_filter_chroma8(pix, stride, alpha, beta, tc0, 2);
+}
+
+void ff_h264_h_loop_filter_chroma422_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                               int alpha, int beta, int8_t *tc0)
+{
+    h_loop_filter_chroma8(pix,              stride, alpha, beta, tc0,     4);
+    h_loop_filter_chroma8(pix + 8 * stride, stride, alpha, beta, tc0 + 2, 4);
+}
+
+static av_always_inline void h_loop_filter_chroma_intra8(uint8_t *pix, ptrdiff_t stride,
+                                                         int alpha, int beta)
+{
+    vec_s16 p1, p0, q0, q1;
+
+    load_transpose_8x4(pix, stride, &p1, &p0, &q0, &q1);
+    chroma_intra_filter(&p1, &p0, &q0, &q1, vec_splat_s16(alpha), vec_splat_s16(beta));
+    store_8x2(pix, stride, p0, q0);
+}
+
+void ff_h264_h_loop_filter_chroma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                  int alpha, int beta)
+{
+    h_loop_filter_chroma_intra8(pix, stride, alpha, beta);
+}
+
+void ff_h264_h_loop_filter_chroma422_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                     int alpha, int beta)
+{
+    h_loop_filter_chroma_intra8(pix,              stride, alpha, beta);
+    h_loop_filter_chroma_intra8(pix + 8 * stride, stride, alpha, beta);
+}
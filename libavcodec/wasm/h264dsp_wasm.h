@@ -0,0 +1,122 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_WASM_H264DSP_WASM_H
+#define AVCODEC_WASM_H264DSP_WASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+void ff_h264_idct_add_8_simd128(uint8_t *dst, int16_t *block, int stride);
+void ff_h264_idct8_add_8_simd128(uint8_t *dst, int16_t *block, int stride);
+void ff_h264_idct_dc_add_8_simd128(uint8_t *dst, int16_t *block, int stride);
+void ff_h264_idct8_dc_add_8_simd128(uint8_t *dst, int16_t *block, int stride);
+void ff_h264_idct_add16_8_simd128(uint8_t *dst, const int *block_offset,
+                                  int16_t *block, int stride,
+                                  const uint8_t nnzc[15 * 8]);
+void ff_h264_idct_add16intra_8_simd128(uint8_t *dst, const int *block_offset,
+                                       int16_t *block, int stride,
+                                       const uint8_t nnzc[15 * 8]);
+void ff_h264_idct8_add4_8_simd128(uint8_t *dst, const int *block_offset,
+                                  int16_t *block, int stride,
+                                  const uint8_t nnzc[15 * 8]);
+void ff_h264_idct_add8_8_simd128(uint8_t **dest, const int *block_offset,
+                                 int16_t *block, int stride,
+                                 const uint8_t nnzc[15 * 8]);
+void ff_h264_add_pixels4_8_simd128(uint8_t *dst, int16_t *block, int stride);
+void ff_h264_add_pixels8_8_simd128(uint8_t *dst, int16_t *block, int stride);
+
+#define H264_WEIGHT_SIMD128(W)                                                   \
+void ff_h264_weight_pixels ## W ## _8_simd128(uint8_t *block, ptrdiff_t stride,  \
+                                              int height, int log2_denom,        \
+                                              int weight, int offset);           \
+void ff_h264_biweight_pixels ## W ## _8_simd128(uint8_t *dst, uint8_t *src,      \
+                                                ptrdiff_t stride, int height,    \
+                                                int log2_denom, int weightd,     \
+                                                int weights, int offset);
+
+H264_WEIGHT_SIMD128(16)
+H264_WEIGHT_SIMD128(8)
+H264_WEIGHT_SIMD128(4)
+
+void ff_h264_v_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int alpha, int beta, int8_t *tc0);
+void ff_h264_h_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int alpha, int beta, int8_t *tc0);
+void ff_h264_v_loop_filter_luma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                int alpha, int beta);
+void ff_h264_h_loop_filter_luma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                int alpha, int beta);
+void ff_h264_v_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int alpha, int beta, int8_t *tc0);
+void ff_h264_h_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int alpha, int beta, int8_t *tc0);
+void ff_h264_h_loop_filter_chroma422_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                               int alpha, int beta, int8_t *tc0);
+void ff_h264_v_loop_filter_chroma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                  int alpha, int beta);
+void ff_h264_h_loop_filter_chroma_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                  int alpha, int beta);
+void ff_h264_h_loop_filter_chroma422_intra_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                                     int alpha, int beta);
+
+#define H264_QPEL_SIMD128(OPNAME, SIZE)                                          \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc00_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc10_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc20_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc30_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc01_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc11_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc21_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc31_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc02_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc12_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc22_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc32_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc03_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc13_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc23_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride); \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc33_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride);
+
+H264_QPEL_SIMD128(put, 16)
+H264_QPEL_SIMD128(put, 8)
+H264_QPEL_SIMD128(avg, 16)
+H264_QPEL_SIMD128(avg, 8)
+
+void ff_put_h264_chroma_mc8_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y);
+void ff_put_h264_chroma_mc4_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y);
+void ff_avg_h264_chroma_mc8_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y);
+void ff_avg_h264_chroma_mc4_8_simd128(uint8_t *dst, uint8_t *src,
+                                      ptrdiff_t stride, int h, int x, int y);
+
+void ff_pred16x16_vertical_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred16x16_horizontal_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred16x16_dc_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred16x16_left_dc_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred16x16_top_dc_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred16x16_128_dc_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred16x16_plane_h264_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred8x8_vertical_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred8x8_horizontal_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred8x8_dc_8_simd128(uint8_t *src, ptrdiff_t stride);
+void ff_pred8x8_plane_8_simd128(uint8_t *src, ptrdiff_t stride);
+
+#endif /* AVCODEC_WASM_H264DSP_WASM_H */
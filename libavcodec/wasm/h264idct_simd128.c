@@ -0,0 +1,258 @@
+/*
+ * H.264 IDCT, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/wasm/util_simd128.h"
+#include "libavcodec/h264dec.h"
+#include "h264dsp_wasm.h"
+
+/*
+ * The transforms work on 16-bit lanes, like the other SIMD versions; the
+ * results match the C code for all coefficients a conforming stream can
+ * produce.
+ */
+
+#define IDCT4_1D(a0, a1, a2, a3)                \
+    do {                                        \
+        vec_s16 z0 = a0 + a2;                   \
+        vec_s16 z1 = a0 - a2;                   \
+        vec_s16 z2 = (a1 >> 1) - a3;            \
+        vec_s16 z3 = a1 + (a3 >> 1);            \
+        a0 = z0 + z3;                           \
+        a1 = z1 + z2;                           \
+        a2 = z1 - z2;                           \
+        a3 = z0 - z3;                           \
+    } while (0)
+
+static av_always_inline void add4_row(uint8_t *dst, vec_s16 res)
+{
+    vec_s16 pix = vec_ld4_u8_s16(dst);
+    vec_st4_u8(dst, vec_packus_s16(pix + res, pix));
+}
+
+static av_always_inline void add8_row(uint8_t *dst, vec_s16 res)
+{
+    vec_s16 pix = vec_ld_u8_s16(dst);
+    vec_st8_u8(dst, vec_packus_s16(pix + res, pix));
+}
+
+void ff_h264_idct_add_8_simd128(uint8_t *dst, int16_t *block, int stride)
+{
+    /* two 4x4 rows per vector */
+    vec_s16 r01 = vec_ld_s16(block);
+    vec_s16 r23 = vec_ld_s16(block + 8);
+    vec_s16 a0 = vec_shuffle(r01, r01, 0, 1, 2, 3, 0, 1, 2, 3);
+    vec_s16 a1 = vec_shuffle(r01, r01, 4, 5, 6, 7, 4, 5, 6, 7);
+    vec_s16 a2 = vec_shuffle(r23, r23, 0, 1, 2, 3, 0, 1, 2, 3);
+    vec_s16 a3 = vec_shuffle(r23, r23, 4, 5, 6, 7, 4, 5, 6, 7);
+    vec_s16 t0, t1;
+
+    IDCT4_1D(a0, a1, a2, a3);
+
+    /* transpose, the upper halves are duplicates */
+    t0 = vec_mergel_s16(a0, a1);
+    t1 = vec_mergel_s16(a2, a3);
+    a0 = (vec_s16)vec_mergel_s32((vec_s32)t0, (vec_s32)t1);
+    a2 = (vec_s16)vec_mergeh_s32((vec_s32)t0, (vec_s32)t1);
+    a1 = vec_shuffle(a0, a0, 4, 5, 6, 7, 4, 5, 6, 7);
+    a3 = vec_shuffle(a2, a2, 4, 5, 6, 7, 4, 5, 6, 7);
+
+    IDCT4_1D(a0, a1, a2, a3);
+
+    add4_row(dst,              (a0 + 32) >> 6);
+    add4_row(dst +     stride, (a1 + 32) >> 6);
+    add4_row(dst + 2 * stride, (a2 + 32) >> 6);
+    add4_row(dst + 3 * stride, (a3 + 32) >> 6);
+
+    memset(block, 0, 16 * sizeof(*block));
+}
+
+#define IDCT8_1D(a0, a1, a2, a3, a4, a5, a6, a7)            \
+    do {                                                    \
+        vec_s16 e0 = a0 + a4;                               \
+        vec_s16 e2 = a0 - a4;                               \
+        vec_s16 e4 = (a2 >> 1) - a6;                        \
+        vec_s16 e6 = (a6 >> 1) + a2;                        \
+        vec_s16 f0 = e0 + e6;                               \
+        vec_s16 f2 = e2 + e4;                               \
+        vec_s16 f4 = e2 - e4;                               \
+        vec_s16 f6 = e0 - e6;                               \
+        vec_s16 e1 = a5 - a3 - a7 - (a7 >> 1);              \
+        vec_s16 e3 = a1 + a7 - a3 - (a3 >> 1);              \
+        vec_s16 e5 = a7 - a1 + a5 + (a5 >> 1);              \
+        vec_s16 e7 = a3 + a5 + a1 + (a1 >> 1);              \
+        vec_s16 f1 = (e7 >> 2) + e1;                        \
+        vec_s16 f3 = e3 + (e5 >> 2);                        \
+        vec_s16 f5 = (e3 >> 2) - e5;                        \
+        vec_s16 f7 = e7 - (e1 >> 2);                        \
+        a0 = f0 + f7;                                       \
+        a7 = f0 - f7;                                       \
+        a1 = f2 + f5;                                       \
+        a6 = f2 - f5;                                       \
+        a2 = f4 + f3;                                       \
+        a5 = f4 - f3;                                       \
+        a3 = f6 + f1;                                       \
+        a4 = f6 - f1;                                       \
+    } while (0)
+
+void ff_h264_idct8_add_8_simd128(uint8_t *dst, int16_t *block, int stride)
+{
+    vec_s16 a0 = vec_ld_s16(block + 0 * 8);
+    vec_s16 a1 = vec_ld_s16(block + 1 * 8);
+    vec_s16 a2 = vec_ld_s16(block + 2 * 8);
+    vec_s16 a3 = vec_ld_s16(block + 3 * 8);
+    vec_s16 a4 = vec_ld_s16(block + 4 * 8);
+    vec_s16 a5 = vec_ld_s16(block + 5 * 8);
+    vec_s16 a6 = vec_ld_s16(block + 6 * 8);
+    vec_s16 a7 = vec_ld_s16(block + 7 * 8);
+
+    IDCT8_1D(a0, a1, a2, a3, a4, a5, a6, a7);
+    VEC_TRANSPOSE8_S16(a0, a1, a2, a3, a4, a5, a6, a7);
+    IDCT8_1D(a0, a1, a2, a3, a4, a5, a6, a7);
+
+    add8_row(dst + 0 * stride, (a0 + 32) >> 6);
+    add8_row(dst + 1 * stride, (a1 + 32) >> 6);
+    add8_row(dst + 2 * stride, (a2 + 32) >> 6);
+    add8_row(dst + 3 * stride, (a3 + 32) >> 6);
+    add8_row(dst + 4 * stride, (a4 + 32) >> 6);
+    add8_row(dst + 5 * stride, (a5 + 32) >> 6);
+    add8_row(dst + 6 * stride, (a6 + 32) >> 6);
+    add8_row(dst + 7 * stride, (a7 + 32) >> 6);
+
+    memset(block, 0, 64 * sizeof(*block));
+}
+
+void ff_h264_idct_dc_add_8_simd128(uint8_t *dst, int16_t *block, int stride)
+{
+    vec_s16 dc = vec_splat_s16((block[0] + 32) >> 6);
+    int i;
+
+    block[0] = 0;
+    for (i = 0; i < 4; i++)
+        add4_row(dst + i * stride, dc);
+}
+
+void ff_h264_idct8_dc_add_8_simd128(uint8_t *dst, int16_t *block, int stride)
+{
+    vec_s16 dc = vec_splat_s16((block[0] + 32) >> 6);
+    int i;
+
+    block[0] = 0;
+    for (i = 0; i < 8; i++)
+        add8_row(dst + i * stride, dc);
+}
+
+void ff_h264_idct_add16_8_simd128(uint8_t *dst, const int *block_offset,
+                                  int16_t *block, int stride,
+                                  const uint8_t nnzc[15 * 8])
+{
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        int nnz = nnzc[scan8[i]];
+        if (nnz) {
+            if (nnz == 1 && block[i * 16])
+                ff_h264_idct_dc_add_8_simd128(dst + block_offset[i], block + i * 16, stride);
+            else
+                ff_h264_idct_add_8_simd128(dst + block_offset[i], block + i * 16, stride);
+        }
+    }
+}
+
+void ff_h264_idct_add16intra_8_simd128(uint8_t *dst, const int *block_offset,
+                                       int16_t *block, int stride,
+                                       const uint8_t nnzc[15 * 8])
+{
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        if (nnzc[scan8[i]])
+            ff_h264_idct_add_8_simd128(dst + block_offset[i], block + i * 16, stride);
+        else if (block[i * 16])
+            ff_h264_idct_dc_add_8_simd128(dst + block_offset[i], block + i * 16, stride);
+    }
+}
+
+void ff_h264_idct8_add4_8_simd128(uint8_t *dst, const int *block_offset,
+                                  int16_t *block, int stride,
+                                  const uint8_t nnzc[15 * 8])
+{
+    int i;
+
+    for (i = 0; i < 16; i += 4) {
+        int nnz = nnzc[scan8[i]];
+        if (nnz) {
+            if (nnz == 1 && block[i * 16])
+                ff_h264_idct8_dc_add_8_simd128(dst + block_offset[i], block + i * 16, stride);
+            else
+                ff_h264_idct8_add_8_simd128(dst + block_offset[i], block + i * 16, stride);
+        }
+    }
+}
+
+void ff_h264_idct_add8_8_simd128(uint8_t **dest, const int *block_offset,
+                                 int16_t *block, int stride,
+                                 const uint8_t nnzc[15 * 8])
+{
+    int i, j;
+
+    for (j = 1; j < 3; j++) {
+        for (i = j * 16; i < j * 16 + 4; i++) {
+            if (nnzc[scan8[i]])
+                ff_h264_idct_add_8_simd128(dest[j - 1] + block_offset[i], block + i * 16, stride);
+            else if (block[i * 16])
+                ff_h264_idct_dc_add_8_simd128(dest[j - 1] + block_offset[i], block + i * 16, stride);
+        }
+    }
+}
+
+/* add_pixels wraps around instead of saturating */
+static av_always_inline void wrap_add_row(uint8_t *dst, vec_s16 res, int w)
+{
+    vec_u8h pix;
+
+    memcpy(&pix, dst, w);
+    pix += vec_convert(res, vec_u8h);
+    memcpy(dst, &pix, w);
+}
+
+void ff_h264_add_pixels4_8_simd128(uint8_t *dst, int16_t *block, int stride)
+{
+    vec_s16 r01 = vec_ld_s16(block);
+    vec_s16 r23 = vec_ld_s16(block + 8);
+
+    wrap_add_row(dst,              r01, 4);
+    wrap_add_row(dst +     stride, vec_shuffle(r01, r01, 4, 5, 6, 7, 4, 5, 6, 7), 4);
+    wrap_add_row(dst + 2 * stride, r23, 4);
+    wrap_add_row(dst + 3 * stride, vec_shuffle(r23, r23, 4, 5, 6, 7, 4, 5, 6, 7), 4);
+
+    memset(block, 0, 16 * sizeof(*block));
+}
+
+void ff_h264_add_pixels8_8_simd128(uint8_t *dst, int16_t *block, int stride)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        wrap_add_row(dst + i * stride, vec_ld_s16(block + i * 8), 8);
+
+    memset(block, 0, 64 * sizeof(*block));
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/wasm/cpu.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/h264pred.h"
+#include "h264dsp_wasm.h"
+
+av_cold void ff_h264_pred_init_wasm(H264PredContext *h, int codec_id,
+                                    const int bit_depth,
+                                    const int chroma_format_idc)
+{
+#if HAVE_SIMD128
+    int cpu_flags = av_get_cpu_flags();
+
+    if (!have_simd128(cpu_flags) || bit_depth != 8)
+        return;
+
+    h->pred16x16[VERT_PRED8x8]    = ff_pred16x16_vertical_8_simd128;
+    h->pred16x16[HOR_PRED8x8]     = ff_pred16x16_horizontal_8_simd128;
+    h->pred16x16[DC_PRED8x8]      = ff_pred16x16_dc_8_simd128;
+    h->pred16x16[LEFT_DC_PRED8x8] = ff_pred16x16_left_dc_8_simd128;
+    h->pred16x16[TOP_DC_PRED8x8]  = ff_pred16x16_top_dc_8_simd128;
+    h->pred16x16[DC_128_PRED8x8]  = ff_pred16x16_128_dc_8_simd128;
+    if (codec_id != AV_CODEC_ID_SVQ3 && codec_id != AV_CODEC_ID_RV40 &&
+        codec_id != AV_CODEC_ID_VP7  && codec_id != AV_CODEC_ID_VP8)
+        h->pred16x16[PLANE_PRED8x8] = ff_pred16x16_plane_h264_8_simd128;
+
+    if (chroma_format_idc <= 1) {
+        h->pred8x8[VERT_PRED8x8] = ff_pred8x8_vertical_8_simd128;
+        h->pred8x8[HOR_PRED8x8]  = ff_pred8x8_horizontal_8_simd128;
+        if (codec_id != AV_CODEC_ID_VP7 && codec_id != AV_CODEC_ID_VP8)
+            h->pred8x8[PLANE_PRED8x8] = ff_pred8x8_plane_8_simd128;
+        if (codec_id == AV_CODEC_ID_H264 || codec_id == AV_CODEC_ID_SVQ3)
+            h->pred8x8[DC_PRED8x8] = ff_pred8x8_dc_8_simd128;
+    }
+#endif /* HAVE_SIMD128 */
+}
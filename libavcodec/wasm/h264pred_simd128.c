@@ -0,0 +1,197 @@
+/*
+ * H.264 intra prediction, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/wasm/util_simd128.h"
+#include "h264dsp_wasm.h"
+
+static av_always_inline void fill16(uint8_t *src, ptrdiff_t stride, vec_u8 v)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        vec_st_u8(src + i * stride, v);
+}
+
+/* sum of 16 bytes */
+static av_always_inline int hsum16(vec_u8 v)
+{
+    vec_s16 s = vec_lo_u8_s16(v) + vec_hi_u8_s16(v);
+    s += vec_shuffle(s, s, 4, 5, 6, 7, 0, 1, 2, 3);
+    s += vec_shuffle(s, s, 2, 3, 0, 1, 2, 3, 0, 1);
+    s += vec_shuffle(s, s, 1, 0, 1, 0, 1, 0, 1, 0);
+    return s[0];
+}
+
+static av_always_inline int left_sum(const uint8_t *src, ptrdiff_t stride, int n)
+{
+    int i, dc = 0;
+
+    for (i = 0; i < n; i++)
+        dc += src[-1 + i * stride];
+    return dc;
+}
+
+void ff_pred16x16_vertical_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    fill16(src, stride, vec_ld_u8(src - stride));
+}
+
+void ff_pred16x16_horizontal_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        vec_st_u8(src + i * stride, vec_splat_u8(src[-1 + i * stride]));
+}
+
+void ff_pred16x16_dc_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    int dc = hsum16(vec_ld_u8(src - stride)) + left_sum(src, stride, 16);
+
+    fill16(src, stride, vec_splat_u8((dc + 16) >> 5));
+}
+
+void ff_pred16x16_left_dc_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    fill16(src, stride, vec_splat_u8((left_sum(src, stride, 16) + 8) >> 4));
+}
+
+void ff_pred16x16_top_dc_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    fill16(src, stride, vec_splat_u8((hsum16(vec_ld_u8(src - stride)) + 8) >> 4));
+}
+
+void ff_pred16x16_128_dc_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    fill16(src, stride, vec_splat_u8(128));
+}
+
+/*
+ * The gradient can leave the 16-bit range for extreme edges, so the rows
+ * are computed in 32-bit lanes and saturated back down to bytes.
+ */
+void ff_pred16x16_plane_h264_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    const uint8_t *src0 = src + 7 - stride;
+    const uint8_t *src1 = src + 8 * stride - 1;
+    const uint8_t *src2 = src1 - 2 * stride;
+    const vec_s32 ramp  = { 0, 1, 2, 3 };
+    vec_s32 b0, b1, b2, b3, vh;
+    int H = src0[1] - src0[-1];
+    int V = src1[0] - src2[ 0];
+    int a, j, k;
+
+    for (k = 2; k <= 8; k++) {
+        src1 += stride;
+        src2 -= stride;
+        H += k * (src0[k] - src0[-k]);
+        V += k * (src1[0] - src2[ 0]);
+    }
+    H = (5 * H + 32) >> 6;
+    V = (5 * V + 32) >> 6;
+
+    a  = 16 * (src1[0] + src2[16] + 1) - 7 * (V + H);
+    vh = vec_splat_s32(4 * H);
+    b0 = vec_splat_s32(a) + ramp * H;
+    b1 = b0 + vh;
+    b2 = b1 + vh;
+    b3 = b2 + vh;
+
+    for (j = 0; j < 16; j++) {
+        vec_st_u8(src, vec_packus_s16(vec_packs_s32(b0 >> 5, b1 >> 5),
+                                      vec_packs_s32(b2 >> 5, b3 >> 5)));
+        b0 += V;
+        b1 += V;
+        b2 += V;
+        b3 += V;
+        src += stride;
+    }
+}
+
+static av_always_inline void fill8(uint8_t *src, ptrdiff_t stride, vec_u8 v, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        vec_st8_u8(src + i * stride, v);
+}
+
+void ff_pred8x8_vertical_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    fill8(src, stride, vec_ld8_u8(src - stride), 8);
+}
+
+void ff_pred8x8_horizontal_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        vec_st8_u8(src + i * stride, vec_splat_u8(src[-1 + i * stride]));
+}
+
+void ff_pred8x8_dc_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    const uint8_t *top = src - stride;
+    int dc0 = top[0] + top[1] + top[2] + top[3] + left_sum(src, stride, 4);
+    int dc1 = top[4] + top[5] + top[6] + top[7];
+    int dc2 = left_sum(src + 4 * stride, stride, 4);
+    vec_u8 v0 = vec_splat_u8((dc0 + 4) >> 3);
+    vec_u8 v1 = vec_splat_u8((dc1 + 2) >> 2);
+    vec_u8 v2 = vec_splat_u8((dc2 + 2) >> 2);
+    vec_u8 v3 = vec_splat_u8((dc1 + dc2 + 4) >> 3);
+
+    fill8(src,              stride, vec_shuffle(v0, v1, 0, 1, 2, 3, 16, 17, 18, 19,
+                                                0, 1, 2, 3, 16, 17, 18, 19), 4);
+    fill8(src + 4 * stride, stride, vec_shuffle(v2, v3, 0, 1, 2, 3, 16, 17, 18, 19,
+                                                0, 1, 2, 3, 16, 17, 18, 19), 4);
+}
+
+void ff_pred8x8_plane_8_simd128(uint8_t *src, ptrdiff_t stride)
+{
+    const uint8_t *src0 = src + 3 - stride;
+    const uint8_t *src1 = src + 4 * stride - 1;
+    const uint8_t *src2 = src1 - 2 * stride;
+    const vec_s32 ramp  = { 0, 1, 2, 3 };
+    vec_s32 b0, b1;
+    int H = src0[1] - src0[-1];
+    int V = src1[0] - src2[ 0];
+    int a, j, k;
+
+    for (k = 2; k <= 4; k++) {
+        src1 += stride;
+        src2 -= stride;
+        H += k * (src0[k] - src0[-k]);
+        V += k * (src1[0] - src2[ 0]);
+    }
+    H = (17 * H + 16) >> 5;
+    V = (17 * V + 16) >> 5;
+
+    a  = 16 * (src1[0] + src2[8] + 1) - 3 * (V + H);
+    b0 = vec_splat_s32(a) + ramp * H;
+    b1 = b0 + 4 * H;
+
+    for (j = 0; j < 8; j++) {
+        vec_s16 v = vec_packs_s32(b0 >> 5, b1 >> 5);
+        vec_st8_u8(src, vec_packus_s16(v, v));
+        b0 += V;
+        b1 += V;
+        src += stride;
+    }
+}
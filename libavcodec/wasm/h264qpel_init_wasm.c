@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/wasm/cpu.h"
+#include "libavcodec/h264qpel.h"
+#include "h264dsp_wasm.h"
+
+#define SET_QPEL(PFX, IDX, NUM)                                                \
+    do {                                                                       \
+        c->PFX ## _pixels_tab[IDX][ 0] = ff_ ## PFX ## NUM ## _mc00_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 1] = ff_ ## PFX ## NUM ## _mc10_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 2] = ff_ ## PFX ## NUM ## _mc20_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 3] = ff_ ## PFX ## NUM ## _mc30_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 4] = ff_ ## PFX ## NUM ## _mc01_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 5] = ff_ ## PFX ## NUM ## _mc11_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 6] = ff_ ## PFX ## NUM ## _mc21_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 7] = ff_ ## PFX ## NUM ## _mc31_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 8] = ff_ ## PFX ## NUM ## _mc02_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][ 9] = ff_ ## PFX ## NUM ## _mc12_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][10] = ff_ ## PFX ## NUM ## _mc22_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][11] = ff_ ## PFX ## NUM ## _mc32_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][12] = ff_ ## PFX ## NUM ## _mc03_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][13] = ff_ ## PFX ## NUM ## _mc13_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][14] = ff_ ## PFX ## NUM ## _mc23_8_simd128; \
+        c->PFX ## _pixels_tab[IDX][15] = ff_ ## PFX ## NUM ## _mc33_8_simd128; \
+    } while (0)
+
+av_cold void ff_h264qpel_init_wasm(H264QpelContext *c, int bit_depth)
+{
+#if HAVE_SIMD128
+    int cpu_flags = av_get_cpu_flags();
+
+    if (!have_simd128(cpu_flags) || bit_depth != 8)
+        return;
+
+    SET_QPEL(put_h264_qpel, 0, 16);
+    SET_QPEL(put_h264_qpel, 1, 8);
+    SET_QPEL(avg_h264_qpel, 0, 16);
+    SET_QPEL(avg_h264_qpel, 1, 8);
+#endif /* HAVE_SIMD128 */
+}
@@ -0,0 +1,304 @@
+/*
+ * H.264 quarter-pel motion compensation, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/wasm/util_simd128.h"
+#include "h264dsp_wasm.h"
+
+/* the 6-tap half-pel filter, for 16- and 32-bit lanes */
+#define TAP6(m2, m1, z0, p1, p2, p3) \
+    (((z0) + (p1)) * 20 - ((m1) + (p2)) * 5 + ((m2) + (p3)))
+
+/* Store 8 pixels, averaged with the destination for avg. */
+static av_always_inline void store8(uint8_t *dst, vec_s16 v, int avg)
+{
+    vec_u8 pix = vec_packus_s16(v, v);
+
+    if (avg)
+        pix = vec_avg_u8(pix, vec_ld8_u8(dst));
+    vec_st8_u8(dst, pix);
+}
+
+static av_always_inline void h_lowpass(uint8_t *dst, const uint8_t *src,
+                                       ptrdiff_t dst_stride, ptrdiff_t src_stride,
+                                       int size, int avg)
+{
+    int x, y;
+
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x += 8) {
+            const uint8_t *s = src + x;
+            vec_s16 v = TAP6(vec_ld_u8_s16(s - 2), vec_ld_u8_s16(s - 1),
+                             vec_ld_u8_s16(s),     vec_ld_u8_s16(s + 1),
+                             vec_ld_u8_s16(s + 2), vec_ld_u8_s16(s + 3));
+            store8(dst + x, (v + 16) >> 5, avg);
+        }
+        src += src_stride;
+        dst += dst_stride;
+    }
+}
+
+static av_always_inline void v_lowpass(uint8_t *dst, const uint8_t *src,
+                                       ptrdiff_t dst_stride, ptrdiff_t src_stride,
+                                       int size, int avg)
+{
+    int x, y;
+
+    for (x = 0; x < size; x += 8) {
+        const uint8_t *s = src + x;
+        vec_s16 m2 = vec_ld_u8_s16(s - 2 * src_stride);
+        vec_s16 m1 = vec_ld_u8_s16(s - 1 * src_stride);
+        vec_s16 z0 = vec_ld_u8_s16(s);
+        vec_s16 p1 = vec_ld_u8_s16(s + 1 * src_stride);
+        vec_s16 p2 = vec_ld_u8_s16(s + 2 * src_stride);
+
+        for (y = 0; y < size; y++) {
+            vec_s16 p3 = vec_ld_u8_s16(s + (y + 3) * src_stride);
+            vec_s16 v  = TAP6(m2, m1, z0, p1, p2, p3);
+            store8(dst + x + y * dst_stride, (v + 16) >> 5, avg);
+            m2 = m1;
+            m1 = z0;
+            z0 = p1;
+            p1 = p2;
+            p2 = p3;
+        }
+    }
+}
+
+/*
+ * The horizontal pass fits 16 bits, the vertical pass over its output
+ * needs 32-bit lanes.
+ */
+static av_always_inline vec_s16 tap6_s32(vec_s16 m2, vec_s16 m1, vec_s16 z0,
+                                         vec_s16 p1, vec_s16 p2, vec_s16 p3)
+{
+    vec_s32 lo = TAP6(vec_lo_s16_s32(m2), vec_lo_s16_s32(m1), vec_lo_s16_s32(z0),
+                      vec_lo_s16_s32(p1), vec_lo_s16_s32(p2), vec_lo_s16_s32(p3));
+    vec_s32 hi = TAP6(vec_hi_s16_s32(m2), vec_hi_s16_s32(m1), vec_hi_s16_s32(z0),
+                      vec_hi_s16_s32(p1), vec_hi_s16_s32(p2), vec_hi_s16_s32(p3));
+    return vec_packs_s32((lo + 512) >> 10, (hi + 512) >> 10);
+}
+
+static av_always_inline void hv_lowpass(uint8_t *dst, const uint8_t *src,
+                                        ptrdiff_t dst_stride, ptrdiff_t src_stride,
+                                        int size, int avg)
+{
+    int16_t tmp[(16 + 5) * 16];
+    int x, y;
+
+    src -= 2 * src_stride;
+    for (y = 0; y < size + 5; y++) {
+        for (x = 0; x < size; x += 8) {
+            const uint8_t *s = src + x;
+            vec_st_s16(tmp + y * size + x,
+                       TAP6(vec_ld_u8_s16(s - 2), vec_ld_u8_s16(s - 1),
+                            vec_ld_u8_s16(s),     vec_ld_u8_s16(s + 1),
+                            vec_ld_u8_s16(s + 2), vec_ld_u8_s16(s + 3)));
+        }
+        src += src_stride;
+    }
+
+    for (x = 0; x < size; x += 8) {
+        const int16_t *t = tmp + x;
+        vec_s16 m2 = vec_ld_s16(t);
+        vec_s16 m1 = vec_ld_s16(t + 1 * size);
+        vec_s16 z0 = vec_ld_s16(t + 2 * size);
+        vec_s16 p1 = vec_ld_s16(t + 3 * size);
+        vec_s16 p2 = vec_ld_s16(t + 4 * size);
+
+        for (y = 0; y < size; y++) {
+            vec_s16 p3 = vec_ld_s16(t + (y + 5) * size);
+            store8(dst + x + y * dst_stride, tap6_s32(m2, m1, z0, p1, p2, p3), avg);
+            m2 = m1;
+            m1 = z0;
+            z0 = p1;
+            p1 = p2;
+            p2 = p3;
+        }
+    }
+}
+
+/* Average two sources, then with the destination for avg. */
+static av_always_inline void pixels_l2(uint8_t *dst, const uint8_t *src1,
+                                       const uint8_t *src2, ptrdiff_t dst_stride,
+                                       ptrdiff_t src1_stride, ptrdiff_t src2_stride,
+                                       int size, int avg)
+{
+    int y;
+
+    for (y = 0; y < size; y++) {
+        if (size == 16) {
+            vec_u8 v = vec_avg_u8(vec_ld_u8(src1), vec_ld_u8(src2));
+            if (avg)
+                v = vec_avg_u8(v, vec_ld_u8(dst));
+            vec_st_u8(dst, v);
+        } else {
+            vec_u8 v = vec_avg_u8(vec_ld8_u8(src1), vec_ld8_u8(src2));
+            if (avg)
+                v = vec_avg_u8(v, vec_ld8_u8(dst));
+            vec_st8_u8(dst, v);
+        }
+        dst  += dst_stride;
+        src1 += src1_stride;
+        src2 += src2_stride;
+    }
+}
+
+static av_always_inline void pixels(uint8_t *dst, const uint8_t *src,
+                                    ptrdiff_t stride, int size, int avg)
+{
+    int y;
+
+    for (y = 0; y < size; y++) {
+        if (size == 16) {
+            vec_u8 v = vec_ld_u8(src);
+            if (avg)
+                v = vec_avg_u8(v, vec_ld_u8(dst));
+            vec_st_u8(dst, v);
+        } else {
+            vec_u8 v = vec_ld8_u8(src);
+            if (avg)
+                v = vec_avg_u8(v, vec_ld8_u8(dst));
+            vec_st8_u8(dst, v);
+        }
+        dst += stride;
+        src += stride;
+    }
+}
+
+#define H264_MC(OPNAME, SIZE, AVG)                                              \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc00_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    pixels(dst, src, stride, SIZE, AVG);                                        \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc10_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half[SIZE * SIZE];                                                  \
+    h_lowpass(half, src, SIZE, stride, SIZE, 0);                                \
+    pixels_l2(dst, src, half, stride, stride, SIZE, SIZE, AVG);                 \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc20_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    h_lowpass(dst, src, stride, stride, SIZE, AVG);                             \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc30_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half[SIZE * SIZE];                                                  \
+    h_lowpass(half, src, SIZE, stride, SIZE, 0);                                \
+    pixels_l2(dst, src + 1, half, stride, stride, SIZE, SIZE, AVG);             \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc01_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half[SIZE * SIZE];                                                  \
+    v_lowpass(half, src, SIZE, stride, SIZE, 0);                                \
+    pixels_l2(dst, src, half, stride, stride, SIZE, SIZE, AVG);                 \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc02_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    v_lowpass(dst, src, stride, stride, SIZE, AVG);                             \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc03_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half[SIZE * SIZE];                                                  \
+    v_lowpass(half, src, SIZE, stride, SIZE, 0);                                \
+    pixels_l2(dst, src + stride, half, stride, stride, SIZE, SIZE, AVG);        \
+}                                                                               \
+                                                                                \
+static av_always_inline void OPNAME ## _hv_diag ## SIZE(uint8_t *dst, const uint8_t *src, \
+                                                        ptrdiff_t stride,       \
+                                                        int dy, int dx)         \
+{                                                                               \
+    uint8_t half_h[SIZE * SIZE];                                                \
+    uint8_t half_v[SIZE * SIZE];                                                \
+    h_lowpass(half_h, src + dy * stride, SIZE, stride, SIZE, 0);                \
+    v_lowpass(half_v, src + dx, SIZE, stride, SIZE, 0);                         \
+    pixels_l2(dst, half_h, half_v, stride, SIZE, SIZE, SIZE, AVG);              \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc11_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    OPNAME ## _hv_diag ## SIZE(dst, src, stride, 0, 0);                         \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc31_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    OPNAME ## _hv_diag ## SIZE(dst, src, stride, 0, 1);                         \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc13_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    OPNAME ## _hv_diag ## SIZE(dst, src, stride, 1, 0);                         \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc33_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    OPNAME ## _hv_diag ## SIZE(dst, src, stride, 1, 1);                         \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc22_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    hv_lowpass(dst, src, stride, stride, SIZE, AVG);                            \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc21_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half_h[SIZE * SIZE];                                                \
+    uint8_t half_hv[SIZE * SIZE];                                               \
+    h_lowpass(half_h, src, SIZE, stride, SIZE, 0);                              \
+    hv_lowpass(half_hv, src, SIZE, stride, SIZE, 0);                            \
+    pixels_l2(dst, half_h, half_hv, stride, SIZE, SIZE, SIZE, AVG);             \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc23_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half_h[SIZE * SIZE];                                                \
+    uint8_t half_hv[SIZE * SIZE];                                               \
+    h_lowpass(half_h, src + stride, SIZE, stride, SIZE, 0);                     \
+    hv_lowpass(half_hv, src, SIZE, stride, SIZE, 0);                            \
+    pixels_l2(dst, half_h, half_hv, stride, SIZE, SIZE, SIZE, AVG);             \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc12_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half_v[SIZE * SIZE];                                                \
+    uint8_t half_hv[SIZE * SIZE];                                               \
+    v_lowpass(half_v, src, SIZE, stride, SIZE, 0);                              \
+    hv_lowpass(half_hv, src, SIZE, stride, SIZE, 0);                            \
+    pixels_l2(dst, half_v, half_hv, stride, SIZE, SIZE, SIZE, AVG);             \
+}                                                                               \
+                                                                                \
+void ff_ ## OPNAME ## _h264_qpel ## SIZE ## _mc32_8_simd128(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                               \
+    uint8_t half_v[SIZE * SIZE];                                                \
+    uint8_t half_hv[SIZE * SIZE];                                               \
+    v_lowpass(half_v, src + 1, SIZE, stride, SIZE, 0);                          \
+    hv_lowpass(half_hv, src, SIZE, stride, SIZE, 0);                            \
+    pixels_l2(dst, half_v, half_hv, stride, SIZE, SIZE, SIZE, AVG);             \
+}
+
+H264_MC(put, 16, 0)
+H264_MC(put, 8,  0)
+H264_MC(avg, 16, 1)
+H264_MC(avg, 8,  1)
@@ -0,0 +1,210 @@
+/*
+ * HEVC inverse transforms and residual add, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "libavcodec/hevcdsp.h"
+#include "hevcdsp_wasm.h"
+
+static av_always_inline vec_s32 ld4_s32(const int16_t *p)
+{
+    return vec_convert(vec_ld_s16h(p), vec_s32);
+}
+
+/* round, shift and saturate 4 results into int16 like SCALE() in C */
+static av_always_inline void st4_scale(int16_t *p, vec_s32 v, int shift)
+{
+    vec_s32 r = (v + (1 << (shift - 1))) >> shift;
+    vec_s16 s = vec_packs_s32(r, r);
+    memcpy(p, &s, 4 * sizeof(*p));
+}
+
+/*
+ * The 1-D transforms run on 32-bit lanes, four columns or rows at a time,
+ * with the same even/odd decomposition as TR_4 ... TR_32 in C.
+ */
+static av_always_inline void tr4(vec_s32 *dst, const vec_s32 *src, int sstep)
+{
+    const vec_s32 e0 = 64 * src[0] + 64 * src[2 * sstep];
+    const vec_s32 e1 = 64 * src[0] - 64 * src[2 * sstep];
+    const vec_s32 o0 = 83 * src[sstep] + 36 * src[3 * sstep];
+    const vec_s32 o1 = 36 * src[sstep] - 83 * src[3 * sstep];
+
+    dst[0] = e0 + o0;
+    dst[1] = e1 + o1;
+    dst[2] = e1 - o1;
+    dst[3] = e0 - o0;
+}
+
+#define TR(N, HALF)                                                           \
+static av_always_inline void tr ## N(vec_s32 *dst, const vec_s32 *src,        \
+                                     int sstep)                               \
+{                                                                             \
+    vec_s32 e[N / 2];                                                         \
+    int i, j;                                                                 \
+                                                                              \
+    tr ## HALF(e, src, 2 * sstep);                                            \
+    for (i = 0; i < N / 2; i++) {                                             \
+        vec_s32 o = { 0 };                                                    \
+        for (j = 1; j < N; j += 2)                                            \
+            o += ff_hevc_transform[32 / N * j][i] * src[j * sstep];           \
+        dst[i]         = e[i] + o;                                            \
+        dst[N - 1 - i] = e[i] - o;                                            \
+    }                                                                         \
+}
+
+TR( 8,  4)
+TR(16,  8)
+TR(32, 16)
+
+static av_always_inline void tr(vec_s32 *dst, const vec_s32 *src, int n)
+{
+    switch (n) {
+    case  4: tr4 (dst, src, 1); break;
+    case  8: tr8 (dst, src, 1); break;
+    case 16: tr16(dst, src, 1); break;
+    case 32: tr32(dst, src, 1); break;
+    }
+}
+
+static av_always_inline void idct(int16_t *coeffs, int n)
+{
+    vec_s32 src[32], dst[32];
+    int i, j, k;
+
+    /* columns, four at a time */
+    for (i = 0; i < n; i += 4) {
+        for (j = 0; j < n; j++)
+            src[j] = ld4_s32(coeffs + j * n + i);
+        tr(dst, src, n);
+        for (j = 0; j < n; j++)
+            st4_scale(coeffs + j * n + i, dst[j], 7);
+    }
+
+    /* rows, four at a time, transposed in 4x4 blocks */
+    for (i = 0; i < n; i += 4) {
+        int16_t *row = coeffs + i * n;
+
+        for (k = 0; k < n; k += 4) {
+            for (j = 0; j < 4; j++)
+                src[k + j] = ld4_s32(row + j * n + k);
+            VEC_TRANSPOSE4_S32(src[k], src[k + 1], src[k + 2], src[k + 3]);
+        }
+        tr(dst, src, n);
+        for (k = 0; k < n; k += 4) {
+            VEC_TRANSPOSE4_S32(dst[k], dst[k + 1], dst[k + 2], dst[k + 3]);
+            for (j = 0; j < 4; j++)
+                st4_scale(row + j * n + k, dst[k + j], 20 - 8);
+        }
+    }
+}
+
+/*
+ * col_limit only tells which coefficients are known to be zero, the full
+ * transform gives the same result.
+ */
+#define IDCT(N)                                                               \
+void ff_hevc_idct_ ## N ## x ## N ## _8_simd128(int16_t *coeffs,              \
+                                                 int col_limit)               \
+{                                                                             \
+    idct(coeffs, N);                                                          \
+}                                                                             \
+                                                                              \
+void ff_hevc_idct_ ## N ## x ## N ## _dc_8_simd128(int16_t *coeffs)           \
+{                                                                             \
+    vec_s16 dc = vec_splat_s16((((coeffs[0] + 1) >> 1) + 32) >> 6);           \
+    int i;                                                                    \
+                                                                              \
+    for (i = 0; i < N * N; i += 8)                                            \
+        memcpy(coeffs + i, &dc, FFMIN(N * N - i, 8) * sizeof(*coeffs));       \
+}
+
+IDCT( 4)
+IDCT( 8)
+IDCT(16)
+IDCT(32)
+
+/* anything beyond +-255 saturates anyway and must not overflow */
+static av_always_inline vec_s16 ld_res(const int16_t *res)
+{
+    return vec_clip_s16(vec_ld_s16(res), vec_splat_s16(-256), vec_splat_s16(255));
+}
+
+void ff_hevc_add_residual4x4_8_simd128(uint8_t *dst, int16_t *res,
+                                       ptrdiff_t stride)
+{
+    int y;
+
+    /* two rows per vector */
+    for (y = 0; y < 4; y += 2) {
+        vec_u32 pix = { AV_RN32(dst), AV_RN32(dst + stride) };
+        vec_s16 sum = vec_lo_u8_s16((vec_u8)pix) + ld_res(res);
+
+        pix = (vec_u32)vec_packus_s16(sum, sum);
+        AV_WN32(dst,          pix[0]);
+        AV_WN32(dst + stride, pix[1]);
+        dst += 2 * stride;
+        res += 8;
+    }
+}
+
+void ff_hevc_add_residual8x8_8_simd128(uint8_t *dst, int16_t *res,
+                                       ptrdiff_t stride)
+{
+    int y;
+
+    for (y = 0; y < 8; y++) {
+        vec_s16 sum = vec_ld_u8_s16(dst) + ld_res(res);
+
+        vec_st8_u8(dst, vec_packus_s16(sum, sum));
+        dst += stride;
+        res += 8;
+    }
+}
+
+static av_always_inline void add_residual16(uint8_t *dst, const int16_t *res,
+                                            ptrdiff_t stride, int size)
+{
+    int x, y;
+
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x += 16) {
+            vec_u8 pix = vec_ld_u8(dst + x);
+
+            vec_st_u8(dst + x, vec_packus_s16(vec_lo_u8_s16(pix) + ld_res(res + x),
+                                              vec_hi_u8_s16(pix) + ld_res(res + x + 8)));
+        }
+        dst += stride;
+        res += size;
+    }
+}
+
+void ff_hevc_add_residual16x16_8_simd128(uint8_t *dst, int16_t *res,
+                                         ptrdiff_t stride)
+{
+    add_residual16(dst, res, stride, 16);
+}
+
+void ff_hevc_add_residual32x32_8_simd128(uint8_t *dst, int16_t *res,
+                                         ptrdiff_t stride)
+{
+    add_residual16(dst, res, stride, 32);
+}
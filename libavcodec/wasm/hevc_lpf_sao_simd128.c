@@ -0,0 +1,285 @@
+/*
+ * HEVC loop filters and SAO, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/common.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/hevcdsp.h"
+#include "hevcdsp_wasm.h"
+
+/* lanes 0-3 and 4-7 belong to the two 4-sample edge segments */
+static av_always_inline vec_s16 seg_splat(int a, int b)
+{
+    return (vec_s16){ a, a, a, a, b, b, b, b };
+}
+
+static av_always_inline vec_s16 seg_mask(int a, int b)
+{
+    return seg_splat(-!!a, -!!b);
+}
+
+/*
+ * p[0..7] hold the lines P3 ... Q3 across the edge, one 8-sample segment
+ * pair per vector. The per-segment decisions use lines 0 and 3 of each
+ * segment as in C, the filters themselves run on all lanes and are
+ * merged under the resulting masks.
+ */
+static av_always_inline void luma_filter(vec_s16 *p, int beta, const int32_t *tc,
+                                         const uint8_t *no_p, const uint8_t *no_q)
+{
+    const vec_s16 p3 = p[0], p2 = p[1], p1 = p[2], p0 = p[3];
+    const vec_s16 q0 = p[4], q1 = p[5], q2 = p[6], q3 = p[7];
+    const vec_s16 zero = { 0 }, max = zero + 255;
+    const vec_s16 dp = vec_abs_s16(p2 - 2 * p1 + p0);
+    const vec_s16 dq = vec_abs_s16(q2 - 2 * q1 + q0);
+    const vec_s16 sp = vec_abs_s16(p3 - p0) + vec_abs_s16(q3 - q0);
+    const vec_s16 pq = vec_abs_s16(p0 - q0);
+    const int beta_3 = beta >> 3, beta_2 = beta >> 2;
+    const int side   = (beta + (beta >> 1)) >> 3;
+    int on[2], strong[2], nd_p[2], nd_q[2];
+    vec_s16 tcv, m_on, m_strong, m_p, m_q, m;
+    vec_s16 s_p0, s_p1, s_p2, s_q0, s_q1, s_q2, tc2;
+    vec_s16 delta0, n_p0, n_q0, n_p1, n_q1, tc_2, d;
+    int j;
+
+    for (j = 0; j < 2; j++) {
+        const int l0  = 4 * j, l3 = 4 * j + 3;
+        const int d0  = dp[l0] + dq[l0];
+        const int d3  = dp[l3] + dq[l3];
+        const int tcj = tc[j];
+        const int tc25 = (tcj * 5 + 1) >> 1;
+
+        on[j]     = d0 + d3 < beta;
+        strong[j] = sp[l0] < beta_3 && pq[l0] < tc25 &&
+                    sp[l3] < beta_3 && pq[l3] < tc25 &&
+                    (d0 << 1) < beta_2 && (d3 << 1) < beta_2;
+        nd_p[j]   = dp[l0] + dp[l3] < side;
+        nd_q[j]   = dq[l0] + dq[l3] < side;
+    }
+    if (!on[0] && !on[1])
+        return;
+
+    tcv      = seg_splat(tc[0], tc[1]);
+    m_on     = seg_mask(on[0], on[1]);
+    m_strong = seg_mask(strong[0], strong[1]) & m_on;
+    m_p      = seg_mask(!no_p[0], !no_p[1]);
+    m_q      = seg_mask(!no_q[0], !no_q[1]);
+
+    /* strong filter */
+    tc2  = 2 * tcv;
+    s_p0 = p0 + vec_clip_s16(((p2 + 2 * p1 + 2 * p0 + 2 * q0 + q1 + 4) >> 3) - p0, -tc2, tc2);
+    s_p1 = p1 + vec_clip_s16(((p2 + p1 + p0 + q0 + 2) >> 2) - p1, -tc2, tc2);
+    s_p2 = p2 + vec_clip_s16(((2 * p3 + 3 * p2 + p1 + p0 + q0 + 4) >> 3) - p2, -tc2, tc2);
+    s_q0 = q0 + vec_clip_s16(((p1 + 2 * p0 + 2 * q0 + 2 * q1 + q2 + 4) >> 3) - q0, -tc2, tc2);
+    s_q1 = q1 + vec_clip_s16(((p0 + q0 + q1 + q2 + 2) >> 2) - q1, -tc2, tc2);
+    s_q2 = q2 + vec_clip_s16(((2 * q3 + 3 * q2 + q1 + q0 + p0 + 4) >> 3) - q2, -tc2, tc2);
+
+    /* normal filter */
+    tc_2   = tcv >> 1;
+    delta0 = (9 * (q0 - p0) - 3 * (q1 - p1) + 8) >> 4;
+    m      = m_on & ~m_strong & (vec_abs_s16(delta0) < 10 * tcv);
+    delta0 = vec_clip_s16(delta0, -tcv, tcv);
+    n_p0   = vec_clip_s16(p0 + delta0, zero, max);
+    n_q0   = vec_clip_s16(q0 - delta0, zero, max);
+    d      = vec_clip_s16((((p2 + p0 + 1) >> 1) - p1 + delta0) >> 1, -tc_2, tc_2);
+    n_p1   = vec_clip_s16(p1 + d, zero, max);
+    d      = vec_clip_s16((((q2 + q0 + 1) >> 1) - q1 - delta0) >> 1, -tc_2, tc_2);
+    n_q1   = vec_clip_s16(q1 + d, zero, max);
+
+    p[1] = vec_sel(m_strong & m_p, s_p2, p2);
+    p[2] = vec_sel(m_strong & m_p, s_p1,
+                   vec_sel(m & m_p & seg_mask(nd_p[0], nd_p[1]), n_p1, p1));
+    p[3] = vec_sel(m_strong & m_p, s_p0, vec_sel(m & m_p, n_p0, p0));
+    p[4] = vec_sel(m_strong & m_q, s_q0, vec_sel(m & m_q, n_q0, q0));
+    p[5] = vec_sel(m_strong & m_q, s_q1,
+                   vec_sel(m & m_q & seg_mask(nd_q[0], nd_q[1]), n_q1, q1));
+    p[6] = vec_sel(m_strong & m_q, s_q2, q2);
+}
+
+void ff_hevc_h_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int beta, int32_t *tc,
+                                          uint8_t *no_p, uint8_t *no_q)
+{
+    vec_s16 p[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        p[i] = vec_ld_u8_s16(pix + (i - 4) * stride);
+    luma_filter(p, beta, tc, no_p, no_q);
+    for (i = 1; i < 7; i++)
+        vec_st8_u8(pix + (i - 4) * stride, vec_packus_s16(p[i], p[i]));
+}
+
+void ff_hevc_v_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int beta, int32_t *tc,
+                                          uint8_t *no_p, uint8_t *no_q)
+{
+    vec_s16 p[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        p[i] = vec_ld_u8_s16(pix + i * stride - 4);
+    VEC_TRANSPOSE8_S16(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+    luma_filter(p, beta, tc, no_p, no_q);
+    VEC_TRANSPOSE8_S16(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+    for (i = 0; i < 8; i++)
+        vec_st8_u8(pix + i * stride - 4, vec_packus_s16(p[i], p[i]));
+}
+
+static av_always_inline void chroma_filter(vec_s16 *p0, vec_s16 *q0,
+                                           vec_s16 p1, vec_s16 q1,
+                                           const int32_t *tc,
+                                           const uint8_t *no_p, const uint8_t *no_q)
+{
+    const vec_s16 zero = { 0 }, max = zero + 255;
+    const vec_s16 tcv = seg_splat(FFMAX(tc[0], 0), FFMAX(tc[1], 0));
+    vec_s16 delta0 = vec_clip_s16((((*q0 - *p0) * 4) + p1 - q1 + 4) >> 3, -tcv, tcv);
+
+    /* tc <= 0 leaves the segment alone, as does a zero delta */
+    *p0 = vec_sel(seg_mask(!no_p[0], !no_p[1]), vec_clip_s16(*p0 + delta0, zero, max), *p0);
+    *q0 = vec_sel(seg_mask(!no_q[0], !no_q[1]), vec_clip_s16(*q0 - delta0, zero, max), *q0);
+}
+
+void ff_hevc_h_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int32_t *tc, uint8_t *no_p,
+                                            uint8_t *no_q)
+{
+    vec_s16 p1 = vec_ld_u8_s16(pix - 2 * stride);
+    vec_s16 p0 = vec_ld_u8_s16(pix - stride);
+    vec_s16 q0 = vec_ld_u8_s16(pix);
+    vec_s16 q1 = vec_ld_u8_s16(pix + stride);
+
+    chroma_filter(&p0, &q0, p1, q1, tc, no_p, no_q);
+    vec_st8_u8(pix - stride, vec_packus_s16(p0, p0));
+    vec_st8_u8(pix,          vec_packus_s16(q0, q0));
+}
+
+void ff_hevc_v_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int32_t *tc, uint8_t *no_p,
+                                            uint8_t *no_q)
+{
+    vec_s16 p[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        p[i] = vec_ld4_u8_s16(pix + i * stride - 2);
+    VEC_TRANSPOSE8_S16(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+    chroma_filter(&p[1], &p[2], p[0], p[3], tc, no_p, no_q);
+    for (i = 0; i < 8; i++) {
+        pix[i * stride - 1] = p[1][i];
+        pix[i * stride]     = p[2][i];
+    }
+}
+
+static av_always_inline vec_s16 ld_px(const uint8_t *p, int n)
+{
+    vec_u8 v = { 0 };
+    memcpy(&v, p, n);
+    return vec_lo_u8_s16(v);
+}
+
+static av_always_inline void st_px(uint8_t *p, vec_s16 v, int n)
+{
+    vec_u8 pix = vec_packus_s16(v, v);
+    memcpy(p, &pix, n);
+}
+
+static av_always_inline void sao_band(uint8_t *dst, const uint8_t *src,
+                                      const vec_s16 *band, const vec_s16 *off,
+                                      int n)
+{
+    vec_s16 v = ld_px(src, n);
+    vec_s16 b = v >> 3;
+    vec_s16 o = { 0 };
+    int k;
+
+    for (k = 0; k < 4; k++)
+        o += off[k] & (b == band[k]);
+    st_px(dst, v + o, n);
+}
+
+void ff_hevc_sao_band_filter_8_simd128(uint8_t *dst, uint8_t *src,
+                                       ptrdiff_t stride_dst, ptrdiff_t stride_src,
+                                       int16_t *sao_offset_val, int sao_left_class,
+                                       int width, int height)
+{
+    vec_s16 band[4], off[4];
+    int k, x, y;
+
+    for (k = 0; k < 4; k++) {
+        band[k] = vec_splat_s16((k + sao_left_class) & 31);
+        off[k]  = vec_splat_s16(sao_offset_val[k + 1]);
+    }
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x + 8 <= width; x += 8)
+            sao_band(dst + x, src + x, band, off, 8);
+        if (x < width)
+            sao_band(dst + x, src + x, band, off, width - x);
+        dst += stride_dst;
+        src += stride_src;
+    }
+}
+
+static av_always_inline void sao_edge(uint8_t *dst, const uint8_t *src,
+                                      ptrdiff_t a_stride, ptrdiff_t b_stride,
+                                      const vec_s16 *off, int n)
+{
+    vec_s16 v = ld_px(src, n);
+    vec_s16 a = ld_px(src + a_stride, n);
+    vec_s16 b = ld_px(src + b_stride, n);
+    /* comparisons give -1 for true, so this is -(CMP(v, a) + CMP(v, b)) */
+    vec_s16 s = (v > a) - (v < a) + (v > b) - (v < b);
+    /* edge_idx[] = { 1, 2, 0, 3, 4 } folded into the offsets */
+    vec_s16 o = (off[1] & (s ==  2)) | (off[2] & (s ==  1)) | (off[0] & (s == 0)) |
+                (off[3] & (s == -1)) | (off[4] & (s == -2));
+
+    st_px(dst, v + o, n);
+}
+
+void ff_hevc_sao_edge_filter_8_simd128(uint8_t *dst, uint8_t *src,
+                                       ptrdiff_t stride_dst,
+                                       int16_t *sao_offset_val,
+                                       int eo, int width, int height)
+{
+    static const int8_t pos[4][2][2] = {
+        { { -1,  0 }, {  1, 0 } }, // horizontal
+        { {  0, -1 }, {  0, 1 } }, // vertical
+        { { -1, -1 }, {  1, 1 } }, // 45 degree
+        { {  1, -1 }, { -1, 1 } }, // 135 degree
+    };
+    const ptrdiff_t stride_src = 2 * MAX_PB_SIZE + AV_INPUT_BUFFER_PADDING_SIZE;
+    const ptrdiff_t a_stride   = pos[eo][0][0] + pos[eo][0][1] * stride_src;
+    const ptrdiff_t b_stride   = pos[eo][1][0] + pos[eo][1][1] * stride_src;
+    vec_s16 off[5];
+    int k, x, y;
+
+    for (k = 0; k < 5; k++)
+        off[k] = vec_splat_s16(sao_offset_val[k]);
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x + 8 <= width; x += 8)
+            sao_edge(dst + x, src + x, a_stride, b_stride, off, 8);
+        if (x < width)
+            sao_edge(dst + x, src + x, a_stride, b_stride, off, width - x);
+        src += stride_src;
+        dst += stride_dst;
+    }
+}
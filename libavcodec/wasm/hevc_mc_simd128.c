@@ -0,0 +1,302 @@
+/*
+ * HEVC motion compensation, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/wasm/util_simd128.h"
+#include "libavcodec/hevcdec.h"
+#include "libavcodec/hevcdsp.h"
+#include "hevcdsp_wasm.h"
+
+/*
+ * All prediction paths share one kernel: a filter stage producing the
+ * 14-bit intermediate of the C code in 16-bit lanes, followed by one of
+ * the output stages below. Blocks are processed 8 columns at a time with
+ * 4- and 2-column tails, so nothing outside the block is read or written
+ * beyond what the C code touches.
+ */
+enum MCOutput {
+    MC_PUT,
+    MC_UNI,
+    MC_BI,
+    MC_UNI_W,
+    MC_BI_W,
+};
+
+static av_always_inline vec_s16 ld_px(const uint8_t *p, int n)
+{
+    vec_u8 v = { 0 };
+    memcpy(&v, p, n);
+    return vec_lo_u8_s16(v);
+}
+
+static av_always_inline vec_s16 ld_s16(const int16_t *p, int n)
+{
+    vec_s16 v = { 0 };
+    memcpy(&v, p, n * sizeof(*p));
+    return v;
+}
+
+/* (x + (1 << (s - 1))) >> s without the risk of overflowing the lane */
+static av_always_inline vec_s16 rshift_rnd(vec_s16 x, int s)
+{
+    return (x >> s) + ((x >> (s - 1)) & 1);
+}
+
+/* 8-bit samples: the sums of the HEVC filters always fit 16 bits */
+static av_always_inline vec_s16 filter_px(const uint8_t *src, ptrdiff_t step,
+                                          const vec_s16 *c, int taps, int n)
+{
+    vec_s16 sum = { 0 };
+    int k;
+
+    for (k = 0; k < taps; k++)
+        sum += c[k] * ld_px(src + (k - taps / 2 + 1) * step, n);
+    return sum;
+}
+
+/* second pass over the 16-bit intermediate, in 32-bit lanes */
+static av_always_inline vec_s16 filter_tmp(const int16_t *tmp, const vec_s32 *c,
+                                           int taps, int n)
+{
+    vec_s32 lo = { 0 }, hi = { 0 };
+    int k;
+
+    for (k = 0; k < taps; k++) {
+        vec_s16 t = ld_s16(tmp + (k - taps / 2 + 1) * MAX_PB_SIZE, n);
+        lo += c[k] * vec_lo_s16_s32(t);
+        hi += c[k] * vec_hi_s16_s32(t);
+    }
+    return vec_packs_s32(lo >> 6, hi >> 6);
+}
+
+static av_always_inline void output(uint8_t *dst, int16_t *dst16,
+                                    const int16_t *src2, int x, vec_s16 v,
+                                    int out, int n, int denom,
+                                    int wx0, int wx1, int ox0, int ox1)
+{
+    vec_s16 res, s;
+    vec_s32 lo, hi;
+    vec_u8 pix;
+    int shift;
+
+    switch (out) {
+    case MC_PUT:
+        memcpy(dst16 + x, &v, n * sizeof(*dst16));
+        return;
+    case MC_UNI:
+        res = rshift_rnd(v, 6);
+        break;
+    case MC_BI:
+        /* (v + s + 64) >> 7, halving first so that the sum fits */
+        s   = ld_s16(src2 + x, n);
+        res = rshift_rnd((v >> 1) + (s >> 1) + (v & s & 1), 6);
+        break;
+    case MC_UNI_W:
+        shift = denom + 6;
+        lo    = ((vec_lo_s16_s32(v) * wx0 + (1 << (shift - 1))) >> shift) + ox0;
+        hi    = ((vec_hi_s16_s32(v) * wx0 + (1 << (shift - 1))) >> shift) + ox0;
+        res   = vec_packs_s32(lo, hi);
+        break;
+    case MC_BI_W:
+        shift = denom + 6;
+        s     = ld_s16(src2 + x, n);
+        lo    = (vec_lo_s16_s32(v) * wx1 + vec_lo_s16_s32(s) * wx0 +
+                 (ox0 + ox1 + 1) * (1 << shift)) >> (shift + 1);
+        hi    = (vec_hi_s16_s32(v) * wx1 + vec_hi_s16_s32(s) * wx0 +
+                 (ox0 + ox1 + 1) * (1 << shift)) >> (shift + 1);
+        res   = vec_packs_s32(lo, hi);
+        break;
+    }
+    pix = vec_packus_s16(res, res);
+    memcpy(dst + x, &pix, n);
+}
+
+static av_always_inline void mc_chunk(uint8_t *dst, int16_t *dst16,
+                                      const uint8_t *src, ptrdiff_t srcstride,
+                                      const int16_t *src2, const int16_t *tmp,
+                                      int x,
+                                      const vec_s16 *ch, const vec_s16 *cv,
+                                      const vec_s32 *cv32, int h, int v, int taps,
+                                      int out, int n, int denom,
+                                      int wx0, int wx1, int ox0, int ox1)
+{
+    vec_s16 res;
+
+    if (h && v)
+        res = filter_tmp(tmp + x, cv32, taps, n);
+    else if (h)
+        res = filter_px(src + x, 1, ch, taps, n);
+    else if (v)
+        res = filter_px(src + x, srcstride, cv, taps, n);
+    else
+        res = ld_px(src + x, n) << 6;
+
+    output(dst, dst16, src2, x, res, out, n, denom, wx0, wx1, ox0, ox1);
+}
+
+static av_always_inline void hevc_mc(uint8_t *dst, ptrdiff_t dststride,
+                                     int16_t *dst16,
+                                     const uint8_t *src, ptrdiff_t srcstride,
+                                     const int16_t *src2, int height, int width,
+                                     const int8_t *fh, const int8_t *fv, int taps,
+                                     int out, int denom,
+                                     int wx0, int wx1, int ox0, int ox1)
+{
+    int16_t tmp_array[(MAX_PB_SIZE + QPEL_EXTRA) * MAX_PB_SIZE];
+    const int16_t *tmp = tmp_array;
+    vec_s16 ch[8], cv[8];
+    vec_s32 cv32[8];
+    int x, y, k;
+
+    for (k = 0; k < taps; k++) {
+        if (fh)
+            ch[k] = vec_splat_s16(fh[k]);
+        if (fv) {
+            cv[k]   = vec_splat_s16(fv[k]);
+            cv32[k] = vec_splat_s32(fv[k]);
+        }
+    }
+
+    if (fh && fv) {
+        const uint8_t *s = src - (taps / 2 - 1) * srcstride;
+        int16_t *t = tmp_array;
+
+        tmp += (taps / 2 - 1) * MAX_PB_SIZE;
+
+        for (y = 0; y < height + taps - 1; y++) {
+            for (x = 0; x + 8 <= width; x += 8)
+                output(NULL, t, NULL, x, filter_px(s + x, 1, ch, taps, 8),
+                       MC_PUT, 8, 0, 0, 0, 0, 0);
+            if (width & 4) {
+                output(NULL, t, NULL, x, filter_px(s + x, 1, ch, taps, 4),
+                       MC_PUT, 4, 0, 0, 0, 0, 0);
+                x += 4;
+            }
+            if (width & 2)
+                output(NULL, t, NULL, x, filter_px(s + x, 1, ch, taps, 2),
+                       MC_PUT, 2, 0, 0, 0, 0, 0);
+            s += srcstride;
+            t += MAX_PB_SIZE;
+        }
+    }
+
+    for (y = 0; y < height; y++) {
+#define CHUNK(N)                                                              \
+        mc_chunk(dst, dst16, src, srcstride, src2, tmp, x,                    \
+                 ch, cv, cv32, !!fh, !!fv, taps, out, N, denom,               \
+                 wx0, wx1, ox0, ox1)
+        for (x = 0; x + 8 <= width; x += 8)
+            CHUNK(8);
+        if (width & 4) {
+            CHUNK(4);
+            x += 4;
+        }
+        if (width & 2)
+            CHUNK(2);
+#undef CHUNK
+        src += srcstride;
+        tmp += MAX_PB_SIZE;
+        if (out == MC_PUT)
+            dst16 += MAX_PB_SIZE;
+        else
+            dst += dststride;
+        if (out == MC_BI || out == MC_BI_W)
+            src2 += MAX_PB_SIZE;
+    }
+}
+
+#define MC_FUNCS(PEL, DIR, FH, FV, TAPS)                                        \
+void ff_hevc_put_hevc_ ## PEL ## _ ## DIR ## _8_simd128(int16_t *dst,          \
+                                                        uint8_t *src,          \
+                                                        ptrdiff_t srcstride,   \
+                                                        int height,            \
+                                                        intptr_t mx,           \
+                                                        intptr_t my,           \
+                                                        int width)             \
+{                                                                              \
+    hevc_mc(NULL, 0, dst, src, srcstride, NULL, height, width,                 \
+            FH, FV, TAPS, MC_PUT, 0, 0, 0, 0, 0);                              \
+}                                                                              \
+                                                                               \
+void ff_hevc_put_hevc_ ## PEL ## _uni_ ## DIR ## _8_simd128(uint8_t *dst,      \
+                                                            ptrdiff_t dststride, \
+                                                            uint8_t *src,      \
+                                                            ptrdiff_t srcstride, \
+                                                            int height,        \
+                                                            intptr_t mx,       \
+                                                            intptr_t my,       \
+                                                            int width)         \
+{                                                                              \
+    hevc_mc(dst, dststride, NULL, src, srcstride, NULL, height, width,         \
+            FH, FV, TAPS, MC_UNI, 0, 0, 0, 0, 0);                              \
+}                                                                              \
+                                                                               \
+void ff_hevc_put_hevc_ ## PEL ## _bi_ ## DIR ## _8_simd128(uint8_t *dst,       \
+                                                           ptrdiff_t dststride, \
+                                                           uint8_t *src,       \
+                                                           ptrdiff_t srcstride, \
+                                                           int16_t *src2,      \
+                                                           int height,         \
+                                                           intptr_t mx,        \
+                                                           intptr_t my,        \
+                                                           int width)          \
+{                                                                              \
+    hevc_mc(dst, dststride, NULL, src, srcstride, src2, height, width,         \
+            FH, FV, TAPS, MC_BI, 0, 0, 0, 0, 0);                               \
+}                                                                              \
+                                                                               \
+void ff_hevc_put_hevc_ ## PEL ## _uni_w_ ## DIR ## _8_simd128(uint8_t *dst,    \
+                                                              ptrdiff_t dststride, \
+                                                              uint8_t *src,    \
+                                                              ptrdiff_t srcstride, \
+                                                              int height,      \
+                                                              int denom,       \
+                                                              int wx, int ox,  \
+                                                              intptr_t mx,     \
+                                                              intptr_t my,     \
+                                                              int width)       \
+{                                                                              \
+    hevc_mc(dst, dststride, NULL, src, srcstride, NULL, height, width,         \
+            FH, FV, TAPS, MC_UNI_W, denom, wx, 0, ox, 0);                      \
+}                                                                              \
+                                                                               \
+void ff_hevc_put_hevc_ ## PEL ## _bi_w_ ## DIR ## _8_simd128(uint8_t *dst,     \
+                                                             ptrdiff_t dststride, \
+                                                             uint8_t *src,     \
+                                                             ptrdiff_t srcstride, \
+                                                             int16_t *src2,    \
+                                                             int height,       \
+                                                             int denom,        \
+                                                             int wx0, int wx1, \
+                                                             int ox0, int ox1, \
+                                                             intptr_t mx,      \
+                                                             intptr_t my,      \
+                                                             int width)        \
+{                                                                              \
+    hevc_mc(dst, dststride, NULL, src, srcstride, src2, height, width,         \
+            FH, FV, TAPS, MC_BI_W, denom, wx0, wx1, ox0, ox1);                 \
+}
+
+MC_FUNCS(pel,  pixels, NULL,                         NULL,                         0)
+MC_FUNCS(qpel, h,      ff_hevc_qpel_filters[mx - 1], NULL,                         8)
+MC_FUNCS(qpel, v,      NULL,                         ff_hevc_qpel_filters[my - 1], 8)
+MC_FUNCS(qpel, hv,     ff_hevc_qpel_filters[mx - 1], ff_hevc_qpel_filters[my - 1], 8)
+MC_FUNCS(epel, h,      ff_hevc_epel_filters[mx - 1], NULL,                         4)
+MC_FUNCS(epel, v,      NULL,                         ff_hevc_epel_filters[my - 1], 4)
+MC_FUNCS(epel, hv,     ff_hevc_epel_filters[mx - 1], ff_hevc_epel_filters[my - 1], 4)
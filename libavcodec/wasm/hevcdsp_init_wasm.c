@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/wasm/cpu.h"
+#include "libavcodec/hevcdsp.h"
+#include "hevcdsp_wasm.h"
+
+#define SET_MC(TAB, V, H, PEL, DIR)                                             \
+    do {                                                                        \
+        c->put_hevc_ ## TAB[i][V][H]          = ff_hevc_put_hevc_ ## PEL ## _ ## DIR ## _8_simd128;        \
+        c->put_hevc_ ## TAB ## _uni[i][V][H]   = ff_hevc_put_hevc_ ## PEL ## _uni_ ## DIR ## _8_simd128;   \
+        c->put_hevc_ ## TAB ## _uni_w[i][V][H] = ff_hevc_put_hevc_ ## PEL ## _uni_w_ ## DIR ## _8_simd128; \
+        c->put_hevc_ ## TAB ## _bi[i][V][H]    = ff_hevc_put_hevc_ ## PEL ## _bi_ ## DIR ## _8_simd128;    \
+        c->put_hevc_ ## TAB ## _bi_w[i][V][H]  = ff_hevc_put_hevc_ ## PEL ## _bi_w_ ## DIR ## _8_simd128;  \
+    } while (0)
+
+av_cold void ff_hevc_dsp_init_wasm(HEVCDSPContext *c, const int bit_depth)
+{
+#if HAVE_SIMD128
+    int cpu_flags = av_get_cpu_flags();
+    int i;
+
+    if (!have_simd128(cpu_flags) || bit_depth != 8)
+        return;
+
+    c->idct[0]         = ff_hevc_idct_4x4_8_simd128;
+    c->idct[1]         = ff_hevc_idct_8x8_8_simd128;
+    c->idct[2]         = ff_hevc_idct_16x16_8_simd128;
+    c->idct[3]         = ff_hevc_idct_32x32_8_simd128;
+    c->idct_dc[0]      = ff_hevc_idct_4x4_dc_8_simd128;
+    c->idct_dc[1]      = ff_hevc_idct_8x8_dc_8_simd128;
+    c->idct_dc[2]      = ff_hevc_idct_16x16_dc_8_simd128;
+    c->idct_dc[3]      = ff_hevc_idct_32x32_dc_8_simd128;
+    c->add_residual[0] = ff_hevc_add_residual4x4_8_simd128;
+    c->add_residual[1] = ff_hevc_add_residual8x8_8_simd128;
+    c->add_residual[2] = ff_hevc_add_residual16x16_8_simd128;
+    c->add_residual[3] = ff_hevc_add_residual32x32_8_simd128;
+
+    for (i = 0; i < 5; i++) {
+        c->sao_band_filter[i] = ff_hevc_sao_band_filter_8_simd128;
+        c->sao_edge_filter[i] = ff_hevc_sao_edge_filter_8_simd128;
+    }
+
+    for (i = 0; i < 10; i++) {
+        SET_MC(qpel, 0, 0, pel,  pixels);
+        SET_MC(qpel, 0, 1, qpel, h);
+        SET_MC(qpel, 1, 0, qpel, v);
+        SET_MC(qpel, 1, 1, qpel, hv);
+        SET_MC(epel, 0, 0, pel,  pixels);
+        SET_MC(epel, 0, 1, epel, h);
+        SET_MC(epel, 1, 0, epel, v);
+        SET_MC(epel, 1, 1, epel, hv);
+    }
+
+    c->hevc_h_loop_filter_luma   = ff_hevc_h_loop_filter_luma_8_simd128;
+    c->hevc_v_loop_filter_luma   = ff_hevc_v_loop_filter_luma_8_simd128;
+    c->hevc_h_loop_filter_chroma = ff_hevc_h_loop_filter_chroma_8_simd128;
+    c->hevc_v_loop_filter_chroma = ff_hevc_v_loop_filter_chroma_8_simd128;
+#endif /* HAVE_SIMD128 */
+}
@@ -0,0 +1,94 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_WASM_HEVCDSP_WASM_H
+#define AVCODEC_WASM_HEVCDSP_WASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HEVC_IDCT_SIMD128(N)                                                    \
+void ff_hevc_idct_ ## N ## x ## N ## _8_simd128(int16_t *coeffs, int col_limit); \
+void ff_hevc_idct_ ## N ## x ## N ## _dc_8_simd128(int16_t *coeffs);            \
+void ff_hevc_add_residual ## N ## x ## N ## _8_simd128(uint8_t *dst, int16_t *res, \
+                                                      ptrdiff_t stride);
+
+HEVC_IDCT_SIMD128(4)
+HEVC_IDCT_SIMD128(8)
+HEVC_IDCT_SIMD128(16)
+HEVC_IDCT_SIMD128(32)
+
+#define HEVC_MC_SIMD128(PEL, DIR)                                               \
+void ff_hevc_put_hevc_ ## PEL ## _ ## DIR ## _8_simd128(int16_t *dst, uint8_t *src, \
+                                                        ptrdiff_t srcstride,   \
+                                                        int height, intptr_t mx, \
+                                                        intptr_t my, int width); \
+void ff_hevc_put_hevc_ ## PEL ## _uni_ ## DIR ## _8_simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                            uint8_t *src, ptrdiff_t srcstride, \
+                                                            int height, intptr_t mx, \
+                                                            intptr_t my, int width); \
+void ff_hevc_put_hevc_ ## PEL ## _bi_ ## DIR ## _8_simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                           uint8_t *src, ptrdiff_t srcstride, \
+                                                           int16_t *src2, int height, \
+                                                           intptr_t mx, intptr_t my, \
+                                                           int width);         \
+void ff_hevc_put_hevc_ ## PEL ## _uni_w_ ## DIR ## _8_simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                              uint8_t *src, ptrdiff_t srcstride, \
+                                                              int height, int denom, \
+                                                              int wx, int ox,  \
+                                                              intptr_t mx, intptr_t my, \
+                                                              int width);      \
+void ff_hevc_put_hevc_ ## PEL ## _bi_w_ ## DIR ## _8_simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                             uint8_t *src, ptrdiff_t srcstride, \
+                                                             int16_t *src2, int height, \
+                                                             int denom, int wx0, int wx1, \
+                                                             int ox0, int ox1, \
+                                                             intptr_t mx, intptr_t my, \
+                                                             int width);
+
+HEVC_MC_SIMD128(pel,  pixels)
+HEVC_MC_SIMD128(qpel, h)
+HEVC_MC_SIMD128(qpel, v)
+HEVC_MC_SIMD128(qpel, hv)
+HEVC_MC_SIMD128(epel, h)
+HEVC_MC_SIMD128(epel, v)
+HEVC_MC_SIMD128(epel, hv)
+
+void ff_hevc_h_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int beta, int32_t *tc,
+                                          uint8_t *no_p, uint8_t *no_q);
+void ff_hevc_v_loop_filter_luma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                          int beta, int32_t *tc,
+                                          uint8_t *no_p, uint8_t *no_q);
+void ff_hevc_h_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int32_t *tc, uint8_t *no_p,
+                                            uint8_t *no_q);
+void ff_hevc_v_loop_filter_chroma_8_simd128(uint8_t *pix, ptrdiff_t stride,
+                                            int32_t *tc, uint8_t *no_p,
+                                            uint8_t *no_q);
+
+void ff_hevc_sao_band_filter_8_simd128(uint8_t *dst, uint8_t *src,
+                                       ptrdiff_t stride_dst, ptrdiff_t stride_src,
+                                       int16_t *sao_offset_val, int sao_left_class,
+                                       int width, int height);
+void ff_hevc_sao_edge_filter_8_simd128(uint8_t *dst, uint8_t *src,
+                                       ptrdiff_t stride_dst,
+                                       int16_t *sao_offset_val,
+                                       int eo, int width, int height);
+
+#endif /* AVCODEC_WASM_HEVCDSP_WASM_H */
@@ -0,0 +1,73 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/wasm/cpu.h"
+#include "libavcodec/vp8dsp.h"
+#include "vp8dsp_wasm.h"
+
+#define VP8_MC_FUNC(IDX, SIZE)                                                  \
+    c->put_vp8_epel_pixels_tab[IDX][0][1] = ff_put_vp8_epel ## SIZE ## _h4_simd128;   \
+    c->put_vp8_epel_pixels_tab[IDX][0][2] = ff_put_vp8_epel ## SIZE ## _h6_simd128;   \
+    c->put_vp8_epel_pixels_tab[IDX][1][0] = ff_put_vp8_epel ## SIZE ## _v4_simd128;   \
+    c->put_vp8_epel_pixels_tab[IDX][1][1] = ff_put_vp8_epel ## SIZE ## _h4v4_simd128; \
+    c->put_vp8_epel_pixels_tab[IDX][1][2] = ff_put_vp8_epel ## SIZE ## _h6v4_simd128; \
+    c->put_vp8_epel_pixels_tab[IDX][2][0] = ff_put_vp8_epel ## SIZE ## _v6_simd128;   \
+    c->put_vp8_epel_pixels_tab[IDX][2][1] = ff_put_vp8_epel ## SIZE ## _h4v6_simd128; \
+    c->put_vp8_epel_pixels_tab[IDX][2][2] = ff_put_vp8_epel ## SIZE ## _h6v6_simd128
+
+av_cold void ff_vp78dsp_init_wasm(VP8DSPContext *c)
+{
+#if HAVE_SIMD128
+    if (!have_simd128(av_get_cpu_flags()))
+        return;
+
+    VP8_MC_FUNC(0, 16);
+    VP8_MC_FUNC(1, 8);
+    VP8_MC_FUNC(2, 4);
+#endif /* HAVE_SIMD128 */
+}
+
+av_cold void ff_vp8dsp_init_wasm(VP8DSPContext *c)
+{
+#if HAVE_SIMD128
+    if (!have_simd128(av_get_cpu_flags()))
+        return;
+
+    c->vp8_luma_dc_wht    = ff_vp8_luma_dc_wht_simd128;
+    c->vp8_idct_add       = ff_vp8_idct_add_simd128;
+    c->vp8_idct_dc_add    = ff_vp8_idct_dc_add_simd128;
+    c->vp8_idct_dc_add4y  = ff_vp8_idct_dc_add4y_simd128;
+    c->vp8_idct_dc_add4uv = ff_vp8_idct_dc_add4uv_simd128;
+
+    c->vp8_v_loop_filter16y = ff_vp8_v_loop_filter16y_simd128;
+    c->vp8_h_loop_filter16y = ff_vp8_h_loop_filter16y_simd128;
+    c->vp8_v_loop_filter8uv = ff_vp8_v_loop_filter8uv_simd128;
+    c->vp8_h_loop_filter8uv = ff_vp8_h_loop_filter8uv_simd128;
+
+    c->vp8_v_loop_filter16y_inner = ff_vp8_v_loop_filter16y_inner_simd128;
+    c->vp8_h_loop_filter16y_inner = ff_vp8_h_loop_filter16y_inner_simd128;
+    c->vp8_v_loop_filter8uv_inner = ff_vp8_v_loop_filter8uv_inner_simd128;
+    c->vp8_h_loop_filter8uv_inner = ff_vp8_h_loop_filter8uv_inner_simd128;
+
+    c->vp8_v_loop_filter_simple = ff_vp8_v_loop_filter_simple_simd128;
+    c->vp8_h_loop_filter_simple = ff_vp8_h_loop_filter_simple_simd128;
+#endif /* HAVE_SIMD128 */
+}
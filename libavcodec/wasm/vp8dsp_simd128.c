@@ -0,0 +1,456 @@
+/*
+ * VP8 DSP functions, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "vp8dsp_wasm.h"
+
+/***********************************************************************
+ * Inverse transforms
+ **********************************************************************/
+
+static av_always_inline vec_s32 ld4_s32(const int16_t *p)
+{
+    vec_s16h v;
+    memcpy(&v, p, sizeof(v));
+    return vec_convert(v, vec_s32);
+}
+
+/* truncate to int16 like the C code storing into int16_t */
+static av_always_inline vec_s32 trunc16(vec_s32 v)
+{
+    return vec_convert(vec_convert(v, vec_s16h), vec_s32);
+}
+
+#define MUL_20091(a) ((((a) * 20091) >> 16) + (a))
+#define MUL_35468(a)  (((a) * 35468) >> 16)
+
+#define IDCT4_1D(a0, a1, a2, a3)                                \
+    do {                                                        \
+        vec_s32 t0 = a0 + a2;                                   \
+        vec_s32 t1 = a0 - a2;                                   \
+        vec_s32 t2 = MUL_35468(a1) - MUL_20091(a3);             \
+        vec_s32 t3 = MUL_20091(a1) + MUL_35468(a3);             \
+        a0 = t0 + t3;                                           \
+        a1 = t1 + t2;                                           \
+        a2 = t1 - t2;                                           \
+        a3 = t0 - t3;                                           \
+    } while (0)
+
+static av_always_inline void add4_row(uint8_t *dst, vec_s32 res)
+{
+    vec_s16 pix = vec_ld4_u8_s16(dst);
+    vec_s16h r = vec_convert(res, vec_s16h);
+    pix += vec_shuffle(r, r, 0, 1, 2, 3, 4, 5, 6, 7);
+    vec_st4_u8(dst, vec_packus_s16(pix, pix));
+}
+
+void ff_vp8_idct_add_simd128(uint8_t *dst, int16_t block[16], ptrdiff_t stride)
+{
+    vec_s32 r0 = ld4_s32(block),     r1 = ld4_s32(block + 4);
+    vec_s32 r2 = ld4_s32(block + 8), r3 = ld4_s32(block + 12);
+
+    memset(block, 0, 16 * sizeof(*block));
+
+    /* columns, one per lane */
+    IDCT4_1D(r0, r1, r2, r3);
+    r0 = trunc16(r0);
+    r1 = trunc16(r1);
+    r2 = trunc16(r2);
+    r3 = trunc16(r3);
+
+    /* rows, one per lane */
+    VEC_TRANSPOSE4_S32(r0, r1, r2, r3);
+    IDCT4_1D(r0, r1, r2, r3);
+    r0 = (r0 + 4) >> 3;
+    r1 = (r1 + 4) >> 3;
+    r2 = (r2 + 4) >> 3;
+    r3 = (r3 + 4) >> 3;
+    VEC_TRANSPOSE4_S32(r0, r1, r2, r3);
+
+    add4_row(dst,              r0);
+    add4_row(dst + stride,     r1);
+    add4_row(dst + stride * 2, r2);
+    add4_row(dst + stride * 3, r3);
+}
+
+void ff_vp8_idct_dc_add_simd128(uint8_t *dst, int16_t block[16], ptrdiff_t stride)
+{
+    const vec_s16 dc = vec_splat_s16((block[0] + 4) >> 3);
+    int i;
+
+    block[0] = 0;
+    for (i = 0; i < 4; i++, dst += stride) {
+        vec_s16 pix = vec_ld4_u8_s16(dst) + dc;
+        vec_st4_u8(dst, vec_packus_s16(pix, pix));
+    }
+}
+
+static av_always_inline vec_s16 dc_pair(int16_t *b0, int16_t *b1)
+{
+    const vec_s16 dc = { (b0[0] + 4) >> 3, (b0[0] + 4) >> 3,
+                         (b0[0] + 4) >> 3, (b0[0] + 4) >> 3,
+                         (b1[0] + 4) >> 3, (b1[0] + 4) >> 3,
+                         (b1[0] + 4) >> 3, (b1[0] + 4) >> 3 };
+    b0[0] = 0;
+    b1[0] = 0;
+    return dc;
+}
+
+void ff_vp8_idct_dc_add4y_simd128(uint8_t *dst, int16_t block[4][16],
+                                  ptrdiff_t stride)
+{
+    const vec_s16 lo = dc_pair(block[0], block[1]);
+    const vec_s16 hi = dc_pair(block[2], block[3]);
+    int i;
+
+    for (i = 0; i < 4; i++, dst += stride) {
+        vec_u8 pix = vec_ld_u8(dst);
+        vec_st_u8(dst, vec_packus_s16(vec_lo_u8_s16(pix) + lo,
+                                      vec_hi_u8_s16(pix) + hi));
+    }
+}
+
+void ff_vp8_idct_dc_add4uv_simd128(uint8_t *dst, int16_t block[4][16],
+                                   ptrdiff_t stride)
+{
+    const vec_s16 dc[2] = { dc_pair(block[0], block[1]),
+                            dc_pair(block[2], block[3]) };
+    int i;
+
+    for (i = 0; i < 8; i++, dst += stride) {
+        vec_s16 pix = vec_ld_u8_s16(dst) + dc[i >> 2];
+        vec_st8_u8(dst, vec_packus_s16(pix, pix));
+    }
+}
+
+void ff_vp8_luma_dc_wht_simd128(int16_t block[4][4][16], int16_t dc[16])
+{
+    vec_s32 r0 = ld4_s32(dc),     r1 = ld4_s32(dc + 4);
+    vec_s32 r2 = ld4_s32(dc + 8), r3 = ld4_s32(dc + 12);
+    vec_s32 t0, t1, t2, t3;
+    int i;
+
+    /* columns, one per lane */
+    t0 = r0 + r3;
+    t1 = r1 + r2;
+    t2 = r1 - r2;
+    t3 = r0 - r3;
+    r0 = trunc16(t0 + t1);
+    r1 = trunc16(t3 + t2);
+    r2 = trunc16(t0 - t1);
+    r3 = trunc16(t3 - t2);
+
+    /* rows, one per lane */
+    VEC_TRANSPOSE4_S32(r0, r1, r2, r3);
+    t0 = r0 + r3 + 3;
+    t1 = r1 + r2;
+    t2 = r1 - r2;
+    t3 = r0 - r3 + 3;
+    r0 = (t0 + t1) >> 3;
+    r1 = (t3 + t2) >> 3;
+    r2 = (t0 - t1) >> 3;
+    r3 = (t3 - t2) >> 3;
+
+    memset(dc, 0, 16 * sizeof(*dc));
+    for (i = 0; i < 4; i++) {
+        block[i][0][0] = r0[i];
+        block[i][1][0] = r1[i];
+        block[i][2][0] = r2[i];
+        block[i][3][0] = r3[i];
+    }
+}
+
+/***********************************************************************
+ * Loop filters
+ **********************************************************************/
+
+enum { LF_SIMPLE, LF_INNER, LF_MBEDGE };
+
+#define ABSD(a, b) vec_abs_s16((a) - (b))
+
+static av_always_inline vec_s16 clip_int8(vec_s16 v)
+{
+    const vec_s16 zero = { 0 };
+    return vec_clip_s16(v, zero - 128, zero + 127);
+}
+
+static av_always_inline vec_s16 clip_uint8(vec_s16 v)
+{
+    const vec_s16 zero = { 0 };
+    return vec_clip_s16(v, zero, zero + 255);
+}
+
+/*
+ * px[0..7] hold p3 ... q3 for 8 lines, one line per lane.
+ * Returns 0 if no line is filtered, so the caller can skip the stores.
+ */
+static av_always_inline int loop_filter(vec_s16 *px, int E, int I, int H, int mode)
+{
+    const vec_s16 p3 = px[0], p2 = px[1], p1 = px[2], p0 = px[3];
+    const vec_s16 q0 = px[4], q1 = px[5], q2 = px[6], q3 = px[7];
+    const vec_s16 zero = { 0 }, ones = zero - 1;
+    const vec_s16 vI = vec_splat_s16(I), vH = vec_splat_s16(H);
+    vec_s16 mask, hev = zero, is4tap = ones, common, d, c, a, f1, f2;
+
+    mask = ABSD(p0, q0) * 2 + (ABSD(p1, q1) >> 1) <= vec_splat_s16(E);
+    if (mode != LF_SIMPLE) {
+        mask &= (ABSD(p3, p2) <= vI) & (ABSD(p2, p1) <= vI) &
+                (ABSD(p1, p0) <= vI) & (ABSD(q3, q2) <= vI) &
+                (ABSD(q2, q1) <= vI) & (ABSD(q1, q0) <= vI);
+        hev   = (ABSD(p1, p0) > vH) | (ABSD(q1, q0) > vH);
+    }
+    if (!((vec_s64)mask)[0] && !((vec_s64)mask)[1])
+        return 0;
+
+    common = mask;
+    if (mode == LF_INNER)
+        is4tap = hev;
+    else if (mode == LF_MBEDGE)
+        common &= hev;
+
+    d  = 3 * (q0 - p0);
+    c  = clip_int8(p1 - q1);
+    a  = clip_int8(d + (c & is4tap));
+    f1 = vec_min_s16(a + 4, zero + 127) >> 3;
+    f2 = vec_min_s16(a + 3, zero + 127) >> 3;
+    px[3] = vec_sel(common, clip_uint8(p0 + f2), p0);
+    px[4] = vec_sel(common, clip_uint8(q0 - f1), q0);
+
+    if (mode == LF_INNER) {
+        a     = (f1 + 1) >> 1;
+        px[2] = vec_sel(mask & ~hev, clip_uint8(p1 + a), p1);
+        px[5] = vec_sel(mask & ~hev, clip_uint8(q1 - a), q1);
+    } else if (mode == LF_MBEDGE) {
+        const vec_s16 mb = mask & ~hev;
+        const vec_s16 w  = clip_int8(c + d);
+        const vec_s16 a0 = (w * 27 + 63) >> 7;
+        const vec_s16 a1 = (w * 18 + 63) >> 7;
+        const vec_s16 a2 = (w *  9 + 63) >> 7;
+
+        px[1] = vec_sel(mb, clip_uint8(p2 + a2), p2);
+        px[2] = vec_sel(mb, clip_uint8(p1 + a1), p1);
+        px[3] = vec_sel(mb, clip_uint8(p0 + a0), px[3]);
+        px[4] = vec_sel(mb, clip_uint8(q0 - a0), px[4]);
+        px[5] = vec_sel(mb, clip_uint8(q1 - a1), q1);
+        px[6] = vec_sel(mb, clip_uint8(q2 - a2), q2);
+    }
+
+    return 1;
+}
+
+/* filter across a row edge: each vector is one row of 8 pixels */
+static av_always_inline void loop_filter_v(uint8_t *dst, ptrdiff_t stride,
+                                           int E, int I, int H, int mode)
+{
+    const int n = mode == LF_SIMPLE ? 2 : 4;
+    const int m = mode == LF_MBEDGE ? 3 : 2;
+    vec_s16 px[8] = { { 0 } };
+    int i;
+
+    for (i = 4 - n; i < 4 + n; i++)
+        px[i] = vec_ld_u8_s16(dst + (i - 4) * stride);
+    if (!loop_filter(px, E, I, H, mode))
+        return;
+    for (i = 4 - m; i < 4 + m; i++)
+        vec_st8_u8(dst + (i - 4) * stride, vec_packus_s16(px[i], px[i]));
+}
+
+/* filter across a column edge: an 8x8 transpose turns the rows into lanes */
+static av_always_inline void loop_filter_h(uint8_t *dst, ptrdiff_t stride,
+                                           int E, int I, int H, int mode)
+{
+    vec_s16 px[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        px[i] = vec_ld_u8_s16(dst - 4 + i * stride);
+    VEC_TRANSPOSE8_S16(px[0], px[1], px[2], px[3], px[4], px[5], px[6], px[7]);
+    if (!loop_filter(px, E, I, H, mode))
+        return;
+    VEC_TRANSPOSE8_S16(px[0], px[1], px[2], px[3], px[4], px[5], px[6], px[7]);
+    for (i = 0; i < 8; i++)
+        vec_st8_u8(dst - 4 + i * stride, vec_packus_s16(px[i], px[i]));
+}
+
+#define LOOP_FILTERS(name, mode)                                                \
+void ff_vp8_v_loop_filter16y ## name ## _simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 int flim_E, int flim_I,        \
+                                                 int hev_thresh)                \
+{                                                                               \
+    loop_filter_v(dst,     stride, flim_E, flim_I, hev_thresh, mode);           \
+    loop_filter_v(dst + 8, stride, flim_E, flim_I, hev_thresh, mode);           \
+}                                                                               \
+                                                                                \
+void ff_vp8_h_loop_filter16y ## name ## _simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 int flim_E, int flim_I,        \
+                                                 int hev_thresh)                \
+{                                                                               \
+    loop_filter_h(dst,              stride, flim_E, flim_I, hev_thresh, mode);  \
+    loop_filter_h(dst + 8 * stride, stride, flim_E, flim_I, hev_thresh, mode);  \
+}                                                                               \
+                                                                                \
+void ff_vp8_v_loop_filter8uv ## name ## _simd128(uint8_t *dstU, uint8_t *dstV,  \
+                                                 ptrdiff_t stride,              \
+                                                 int flim_E, int flim_I,        \
+                                                 int hev_thresh)                \
+{                                                                               \
+    loop_filter_v(dstU, stride, flim_E, flim_I, hev_thresh, mode);              \
+    loop_filter_v(dstV, stride, flim_E, flim_I, hev_thresh, mode);              \
+}                                                                               \
+                                                                                \
+void ff_vp8_h_loop_filter8uv ## name ## _simd128(uint8_t *dstU, uint8_t *dstV,  \
+                                                 ptrdiff_t stride,              \
+                                                 int flim_E, int flim_I,        \
+                                                 int hev_thresh)                \
+{                                                                               \
+    loop_filter_h(dstU, stride, flim_E, flim_I, hev_thresh, mode);              \
+    loop_filter_h(dstV, stride, flim_E, flim_I, hev_thresh, mode);              \
+}
+
+LOOP_FILTERS(,       LF_MBEDGE)
+LOOP_FILTERS(_inner, LF_INNER)
+
+void ff_vp8_v_loop_filter_simple_simd128(uint8_t *dst, ptrdiff_t stride, int flim)
+{
+    loop_filter_v(dst,     stride, flim, 0, 0, LF_SIMPLE);
+    loop_filter_v(dst + 8, stride, flim, 0, 0, LF_SIMPLE);
+}
+
+void ff_vp8_h_loop_filter_simple_simd128(uint8_t *dst, ptrdiff_t stride, int flim)
+{
+    loop_filter_h(dst,              stride, flim, 0, 0, LF_SIMPLE);
+    loop_filter_h(dst + 8 * stride, stride, flim, 0, 0, LF_SIMPLE);
+}
+
+/***********************************************************************
+ * Six-tap and four-tap subpel motion compensation
+ **********************************************************************/
+
+static const uint8_t subpel_filters[7][6] = {
+    { 0,  6, 123,  12,  1, 0 },
+    { 2, 11, 108,  36,  8, 1 },
+    { 0,  9,  93,  50,  6, 0 },
+    { 3, 16,  77,  77, 16, 3 },
+    { 0,  6,  50,  93,  9, 0 },
+    { 1,  8,  36, 108, 11, 2 },
+    { 0,  1,  12, 123,  6, 0 },
+};
+
+static av_always_inline vec_u16 ld_px(const uint8_t *p, int w)
+{
+    return (vec_u16)(w >= 8 ? vec_ld_u8_s16(p) : vec_ld4_u8_s16(p));
+}
+
+/*
+ * Taps 1 and 4 are the only negative ones, so the positive and negative
+ * parts are summed separately on unsigned 16-bit lanes (at most 160 * 255)
+ * and a negative result saturates to 0 exactly like the C clip.
+ */
+static av_always_inline vec_u8 epel(const uint8_t *src, ptrdiff_t step,
+                                    const vec_u16 *F, int taps, int w)
+{
+    vec_u16 pos = ld_px(src, w) * F[2] + ld_px(src + step, w) * F[3];
+    vec_u16 neg = ld_px(src - step, w) * F[1] + ld_px(src + 2 * step, w) * F[4];
+
+    if (taps == 6)
+        pos += ld_px(src - 2 * step, w) * F[0] + ld_px(src + 3 * step, w) * F[5];
+    pos = (((pos - neg) & (vec_u16)(pos > neg)) + 64) >> 7;
+    return vec_packus_s16((vec_s16)pos, (vec_s16)pos);
+}
+
+static av_always_inline void store(uint8_t *dst, vec_u8 v, int w)
+{
+    if (w >= 8)
+        vec_st8_u8(dst, v);
+    else
+        vec_st4_u8(dst, v);
+}
+
+static av_always_inline void epel_1d(uint8_t *dst, ptrdiff_t dst_stride,
+                                     const uint8_t *src, ptrdiff_t src_stride,
+                                     int w, int h, ptrdiff_t step,
+                                     const uint8_t *filter, int taps)
+{
+    vec_u16 F[6];
+    int x;
+
+    for (x = 0; x < 6; x++)
+        F[x] = (vec_u16)vec_splat_s16(filter[x]);
+    do {
+        for (x = 0; x < w; x += 8)
+            store(dst + x, epel(src + x, step, F, taps, w), w);
+        dst += dst_stride;
+        src += src_stride;
+    } while (--h);
+}
+
+static av_always_inline void epel_2d(uint8_t *dst, ptrdiff_t dst_stride,
+                                     const uint8_t *src, ptrdiff_t src_stride,
+                                     int w, int h, int mx, int my,
+                                     int htaps, int vtaps)
+{
+    LOCAL_ALIGNED_16(uint8_t, tmp, [(2 * 16 + 5) * 16]);
+    const int above = vtaps == 6 ? 2 : 1;
+
+    epel_1d(tmp, 16, src - above * src_stride, src_stride, w, h + vtaps - 1,
+            1, subpel_filters[mx - 1], htaps);
+    epel_1d(dst, dst_stride, tmp + above * 16, 16, w, h, 16,
+            subpel_filters[my - 1], vtaps);
+}
+
+#define EPEL_1D(SIZE, TAPS)                                                     \
+void ff_put_vp8_epel ## SIZE ## _h ## TAPS ## _simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                       uint8_t *src, ptrdiff_t srcstride, \
+                                                       int h, int mx, int my)   \
+{                                                                               \
+    epel_1d(dst, dststride, src, srcstride, SIZE, h, 1,                         \
+            subpel_filters[mx - 1], TAPS);                                      \
+}                                                                               \
+                                                                                \
+void ff_put_vp8_epel ## SIZE ## _v ## TAPS ## _simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                       uint8_t *src, ptrdiff_t srcstride, \
+                                                       int h, int mx, int my)   \
+{                                                                               \
+    epel_1d(dst, dststride, src, srcstride, SIZE, h, srcstride,                 \
+            subpel_filters[my - 1], TAPS);                                      \
+}
+
+#define EPEL_2D(SIZE, HTAPS, VTAPS)                                             \
+void ff_put_vp8_epel ## SIZE ## _h ## HTAPS ## v ## VTAPS ## _simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                                      uint8_t *src, ptrdiff_t srcstride, \
+                                                                      int h, int mx, int my) \
+{                                                                               \
+    epel_2d(dst, dststride, src, srcstride, SIZE, h, mx, my, HTAPS, VTAPS);     \
+}
+
+#define EPEL_SIZE(SIZE)     \
+EPEL_1D(SIZE, 4)            \
+EPEL_1D(SIZE, 6)            \
+EPEL_2D(SIZE, 4, 4)         \
+EPEL_2D(SIZE, 4, 6)         \
+EPEL_2D(SIZE, 6, 4)         \
+EPEL_2D(SIZE, 6, 6)
+
+EPEL_SIZE(16)
+EPEL_SIZE(8)
+EPEL_SIZE(4)
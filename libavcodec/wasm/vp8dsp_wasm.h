@@ -0,0 +1,74 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_WASM_VP8DSP_WASM_H
+#define AVCODEC_WASM_VP8DSP_WASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+void ff_vp8_luma_dc_wht_simd128(int16_t block[4][4][16], int16_t dc[16]);
+void ff_vp8_idct_add_simd128(uint8_t *dst, int16_t block[16], ptrdiff_t stride);
+void ff_vp8_idct_dc_add_simd128(uint8_t *dst, int16_t block[16], ptrdiff_t stride);
+void ff_vp8_idct_dc_add4y_simd128(uint8_t *dst, int16_t block[4][16],
+                                  ptrdiff_t stride);
+void ff_vp8_idct_dc_add4uv_simd128(uint8_t *dst, int16_t block[4][16],
+                                   ptrdiff_t stride);
+
+#define VP8_LF_SIMD128(name)                                                     \
+void ff_vp8_v_loop_filter16y ## name ## _simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 int flim_E, int flim_I,         \
+                                                 int hev_thresh);                \
+void ff_vp8_h_loop_filter16y ## name ## _simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 int flim_E, int flim_I,         \
+                                                 int hev_thresh);                \
+void ff_vp8_v_loop_filter8uv ## name ## _simd128(uint8_t *dstU, uint8_t *dstV,   \
+                                                 ptrdiff_t stride,               \
+                                                 int flim_E, int flim_I,         \
+                                                 int hev_thresh);                \
+void ff_vp8_h_loop_filter8uv ## name ## _simd128(uint8_t *dstU, uint8_t *dstV,   \
+                                                 ptrdiff_t stride,               \
+                                                 int flim_E, int flim_I,         \
+                                                 int hev_thresh);
+
+VP8_LF_SIMD128()
+VP8_LF_SIMD128(_inner)
+
+void ff_vp8_v_loop_filter_simple_simd128(uint8_t *dst, ptrdiff_t stride, int flim);
+void ff_vp8_h_loop_filter_simple_simd128(uint8_t *dst, ptrdiff_t stride, int flim);
+
+#define VP8_EPEL_SIMD128(SIZE, NAME)                                             \
+void ff_put_vp8_epel ## SIZE ## _ ## NAME ## _simd128(uint8_t *dst, ptrdiff_t dststride, \
+                                                      uint8_t *src, ptrdiff_t srcstride, \
+                                                      int h, int mx, int my);
+
+#define VP8_EPEL_SIZE_SIMD128(SIZE)    \
+VP8_EPEL_SIMD128(SIZE, h4)             \
+VP8_EPEL_SIMD128(SIZE, h6)             \
+VP8_EPEL_SIMD128(SIZE, v4)             \
+VP8_EPEL_SIMD128(SIZE, v6)             \
+VP8_EPEL_SIMD128(SIZE, h4v4)           \
+VP8_EPEL_SIMD128(SIZE, h4v6)           \
+VP8_EPEL_SIMD128(SIZE, h6v4)           \
+VP8_EPEL_SIMD128(SIZE, h6v6)
+
+VP8_EPEL_SIZE_SIMD128(16)
+VP8_EPEL_SIZE_SIMD128(8)
+VP8_EPEL_SIZE_SIMD128(4)
+
+#endif /* AVCODEC_WASM_VP8DSP_WASM_H */
@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/wasm/cpu.h"
+#include "libavcodec/vp9dsp.h"
+#include "vp9dsp_wasm.h"
+
+#define init_itxfm(tx, sz)                                                      \
+    dsp->itxfm_add[tx][DCT_DCT]   = ff_vp9_idct_idct_  ## sz ## _add_8_simd128; \
+    dsp->itxfm_add[tx][DCT_ADST]  = ff_vp9_iadst_idct_ ## sz ## _add_8_simd128; \
+    dsp->itxfm_add[tx][ADST_DCT]  = ff_vp9_idct_iadst_ ## sz ## _add_8_simd128; \
+    dsp->itxfm_add[tx][ADST_ADST] = ff_vp9_iadst_iadst_ ## sz ## _add_8_simd128
+
+#define init_subpel1(idx1, idx2, idxh, idxv, sz, dir, type)                     \
+    dsp->mc[idx1][FILTER_8TAP_SMOOTH ][idx2][idxh][idxv] = ff_vp9_ ## type ## _8tap_smooth_  ## sz ## dir ## _8_simd128; \
+    dsp->mc[idx1][FILTER_8TAP_REGULAR][idx2][idxh][idxv] = ff_vp9_ ## type ## _8tap_regular_ ## sz ## dir ## _8_simd128; \
+    dsp->mc[idx1][FILTER_8TAP_SHARP  ][idx2][idxh][idxv] = ff_vp9_ ## type ## _8tap_sharp_   ## sz ## dir ## _8_simd128
+
+#define init_subpel2(idx, idxh, idxv, dir, type)                                \
+    init_subpel1(0, idx, idxh, idxv, 64, dir, type);                            \
+    init_subpel1(1, idx, idxh, idxv, 32, dir, type);                            \
+    init_subpel1(2, idx, idxh, idxv, 16, dir, type);                            \
+    init_subpel1(3, idx, idxh, idxv,  8, dir, type);                            \
+    init_subpel1(4, idx, idxh, idxv,  4, dir, type)
+
+#define init_subpel3(idx, type)                                                 \
+    init_subpel2(idx, 1, 1, hv, type);                                          \
+    init_subpel2(idx, 0, 1, v,  type);                                          \
+    init_subpel2(idx, 1, 0, h,  type)
+
+#define init_avg(idx, sz)                                                       \
+    dsp->mc[idx][FILTER_8TAP_SMOOTH ][1][0][0] = ff_vp9_avg ## sz ## _8_simd128; \
+    dsp->mc[idx][FILTER_8TAP_REGULAR][1][0][0] = ff_vp9_avg ## sz ## _8_simd128; \
+    dsp->mc[idx][FILTER_8TAP_SHARP  ][1][0][0] = ff_vp9_avg ## sz ## _8_simd128; \
+    dsp->mc[idx][FILTER_BILINEAR    ][1][0][0] = ff_vp9_avg ## sz ## _8_simd128
+
+#define init_ipred(tx, sz)                                                      \
+    dsp->intra_pred[tx][VERT_PRED]    = ff_vp9_vert_    ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][HOR_PRED]     = ff_vp9_hor_     ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][DC_PRED]      = ff_vp9_dc_      ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][LEFT_DC_PRED] = ff_vp9_dc_left_ ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][TOP_DC_PRED]  = ff_vp9_dc_top_  ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][TM_VP8_PRED]  = ff_vp9_tm_      ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][DC_127_PRED]  = ff_vp9_dc_127_  ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][DC_128_PRED]  = ff_vp9_dc_128_  ## sz ## _8_simd128;    \
+    dsp->intra_pred[tx][DC_129_PRED]  = ff_vp9_dc_129_  ## sz ## _8_simd128
+
+av_cold void ff_vp9dsp_init_wasm(VP9DSPContext *dsp, int bpp)
+{
+#if HAVE_SIMD128
+    int cpu_flags = av_get_cpu_flags();
+    int i;
+
+    if (!have_simd128(cpu_flags) || bpp != 8)
+        return;
+
+    init_itxfm(TX_4X4,   4x4);
+    init_itxfm(TX_8X8,   8x8);
+    init_itxfm(TX_16X16, 16x16);
+    for (i = 0; i < N_TXFM_TYPES; i++)
+        dsp->itxfm_add[TX_32X32][i] = ff_vp9_idct_idct_32x32_add_8_simd128;
+
+    init_subpel3(0, put);
+    init_subpel3(1, avg);
+    init_avg(0, 64);
+    init_avg(1, 32);
+    init_avg(2, 16);
+    init_avg(3,  8);
+    init_avg(4,  4);
+
+    dsp->loop_filter_8[0][0] = ff_vp9_loop_filter_h_4_8_8_simd128;
+    dsp->loop_filter_8[0][1] = ff_vp9_loop_filter_v_4_8_8_simd128;
+    dsp->loop_filter_8[1][0] = ff_vp9_loop_filter_h_8_8_8_simd128;
+    dsp->loop_filter_8[1][1] = ff_vp9_loop_filter_v_8_8_8_simd128;
+    dsp->loop_filter_8[2][0] = ff_vp9_loop_filter_h_16_8_8_simd128;
+    dsp->loop_filter_8[2][1] = ff_vp9_loop_filter_v_16_8_8_simd128;
+
+    dsp->loop_filter_16[0] = ff_vp9_loop_filter_h_16_16_8_simd128;
+    dsp->loop_filter_16[1] = ff_vp9_loop_filter_v_16_16_8_simd128;
+
+    dsp->loop_filter_mix2[0][0][0] = ff_vp9_loop_filter_h_44_16_8_simd128;
+    dsp->loop_filter_mix2[0][0][1] = ff_vp9_loop_filter_v_44_16_8_simd128;
+    dsp->loop_filter_mix2[0][1][0] = ff_vp9_loop_filter_h_48_16_8_simd128;
+    dsp->loop_filter_mix2[0][1][1] = ff_vp9_loop_filter_v_48_16_8_simd128;
+    dsp->loop_filter_mix2[1][0][0] = ff_vp9_loop_filter_h_84_16_8_simd128;
+    dsp->loop_filter_mix2[1][0][1] = ff_vp9_loop_filter_v_84_16_8_simd128;
+    dsp->loop_filter_mix2[1][1][0] = ff_vp9_loop_filter_h_88_16_8_simd128;
+    dsp->loop_filter_mix2[1][1][1] = ff_vp9_loop_filter_v_88_16_8_simd128;
+
+    init_ipred(TX_4X4,   4x4);
+    init_ipred(TX_8X8,   8x8);
+    init_ipred(TX_16X16, 16x16);
+    init_ipred(TX_32X32, 32x32);
+#endif /* HAVE_SIMD128 */
+}
@@ -0,0 +1,122 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_WASM_VP9DSP_WASM_H
+#define AVCODEC_WASM_VP9DSP_WASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VP9_ITXFM_SIMD128(type_a, type_b, sz)                                    \
+void ff_vp9_ ## type_a ## _ ## type_b ## _ ## sz ## x ## sz ## _add_8_simd128(uint8_t *dst, \
+                                                                    ptrdiff_t stride,        \
+                                                                    int16_t *block,          \
+                                                                    int eob);
+
+#define VP9_ITXFM_TYPES_SIMD128(sz)          \
+VP9_ITXFM_SIMD128(idct,  idct,  sz)          \
+VP9_ITXFM_SIMD128(iadst, idct,  sz)          \
+VP9_ITXFM_SIMD128(idct,  iadst, sz)          \
+VP9_ITXFM_SIMD128(iadst, iadst, sz)
+
+VP9_ITXFM_TYPES_SIMD128(4)
+VP9_ITXFM_TYPES_SIMD128(8)
+VP9_ITXFM_TYPES_SIMD128(16)
+VP9_ITXFM_SIMD128(idct, idct, 32)
+
+#define VP9_MC_SIMD128(op, type, sz)                                             \
+void ff_vp9_ ## op ## _8tap_ ## type ## _ ## sz ## h_8_simd128(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                              const uint8_t *src, ptrdiff_t src_stride, \
+                                                              int h, int mx, int my); \
+void ff_vp9_ ## op ## _8tap_ ## type ## _ ## sz ## v_8_simd128(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                              const uint8_t *src, ptrdiff_t src_stride, \
+                                                              int h, int mx, int my); \
+void ff_vp9_ ## op ## _8tap_ ## type ## _ ## sz ## hv_8_simd128(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                               const uint8_t *src, ptrdiff_t src_stride, \
+                                                               int h, int mx, int my);
+
+#define VP9_MC_SIZES_SIMD128(op, type) \
+VP9_MC_SIMD128(op, type, 64)           \
+VP9_MC_SIMD128(op, type, 32)           \
+VP9_MC_SIMD128(op, type, 16)           \
+VP9_MC_SIMD128(op, type,  8)           \
+VP9_MC_SIMD128(op, type,  4)
+
+#define VP9_MC_OPS_SIMD128(type)       \
+VP9_MC_SIZES_SIMD128(put, type)        \
+VP9_MC_SIZES_SIMD128(avg, type)
+
+VP9_MC_OPS_SIMD128(smooth)
+VP9_MC_OPS_SIMD128(regular)
+VP9_MC_OPS_SIMD128(sharp)
+
+#define VP9_AVG_SIMD128(sz)                                                      \
+void ff_vp9_avg ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t dst_stride,          \
+                                    const uint8_t *src, ptrdiff_t src_stride,    \
+                                    int h, int mx, int my);
+
+VP9_AVG_SIMD128(64)
+VP9_AVG_SIMD128(32)
+VP9_AVG_SIMD128(16)
+VP9_AVG_SIMD128(8)
+VP9_AVG_SIMD128(4)
+
+#define VP9_LPF_SIMD128(dir, wd, len)                                            \
+void ff_vp9_loop_filter_ ## dir ## _ ## wd ## _ ## len ## _8_simd128(uint8_t *dst, \
+                                                                   ptrdiff_t stride, \
+                                                                   int E, int I, int H);
+
+VP9_LPF_SIMD128(h, 4,  8)
+VP9_LPF_SIMD128(v, 4,  8)
+VP9_LPF_SIMD128(h, 8,  8)
+VP9_LPF_SIMD128(v, 8,  8)
+VP9_LPF_SIMD128(h, 16, 8)
+VP9_LPF_SIMD128(v, 16, 8)
+VP9_LPF_SIMD128(h, 16, 16)
+VP9_LPF_SIMD128(v, 16, 16)
+VP9_LPF_SIMD128(h, 44, 16)
+VP9_LPF_SIMD128(v, 44, 16)
+VP9_LPF_SIMD128(h, 48, 16)
+VP9_LPF_SIMD128(v, 48, 16)
+VP9_LPF_SIMD128(h, 84, 16)
+VP9_LPF_SIMD128(v, 84, 16)
+VP9_LPF_SIMD128(h, 88, 16)
+VP9_LPF_SIMD128(v, 88, 16)
+
+#define VP9_IPRED_SIMD128(type, sz)                                              \
+void ff_vp9_ ## type ## _ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                         const uint8_t *left,    \
+                                                         const uint8_t *top);
+
+#define VP9_IPRED_TYPES_SIMD128(sz)    \
+VP9_IPRED_SIMD128(vert,    sz)         \
+VP9_IPRED_SIMD128(hor,     sz)         \
+VP9_IPRED_SIMD128(tm,      sz)         \
+VP9_IPRED_SIMD128(dc,      sz)         \
+VP9_IPRED_SIMD128(dc_left, sz)         \
+VP9_IPRED_SIMD128(dc_top,  sz)         \
+VP9_IPRED_SIMD128(dc_127,  sz)         \
+VP9_IPRED_SIMD128(dc_128,  sz)         \
+VP9_IPRED_SIMD128(dc_129,  sz)
+
+VP9_IPRED_TYPES_SIMD128(4)
+VP9_IPRED_TYPES_SIMD128(8)
+VP9_IPRED_TYPES_SIMD128(16)
+VP9_IPRED_TYPES_SIMD128(32)
+
+#endif /* AVCODEC_WASM_VP9DSP_WASM_H */
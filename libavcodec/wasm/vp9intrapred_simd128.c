@@ -0,0 +1,187 @@
+/*
+ * VP9 intra prediction, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/wasm/util_simd128.h"
+#include "vp9dsp_wasm.h"
+
+static av_always_inline void st_row(uint8_t *dst, const vec_u8 *v, int sz)
+{
+    switch (sz) {
+    case 4:  vec_st4_u8(dst, v[0]);      break;
+    case 8:  vec_st8_u8(dst, v[0]);      break;
+    case 32: vec_st_u8(dst + 16, v[1]); /* fall through */
+    case 16: vec_st_u8(dst, v[0]);       break;
+    }
+}
+
+static av_always_inline void ld_row(vec_u8 *v, const uint8_t *src, int sz)
+{
+    switch (sz) {
+    case 4:  v[0] = vec_splat_u8(0); memcpy(&v[0], src, 4); break;
+    case 8:  v[0] = vec_ld8_u8(src);                        break;
+    case 32: v[1] = vec_ld_u8(src + 16); /* fall through */
+    case 16: v[0] = vec_ld_u8(src);                         break;
+    }
+}
+
+static av_always_inline void fill(uint8_t *dst, ptrdiff_t stride, int val, int sz)
+{
+    const vec_u8 v[2] = { vec_splat_u8(val), vec_splat_u8(val) };
+    int y;
+
+    for (y = 0; y < sz; y++, dst += stride)
+        st_row(dst, v, sz);
+}
+
+static av_always_inline int sum_px(const uint8_t *p, int sz)
+{
+    vec_s16 acc = { 0 };
+    int i, sum = 0;
+
+    if (sz == 4)
+        return p[0] + p[1] + p[2] + p[3];
+    for (i = 0; i < sz; i += 8)
+        acc += vec_ld_u8_s16(p + i);
+    for (i = 0; i < 8; i++)
+        sum += acc[i];
+    return sum;
+}
+
+static av_always_inline void vert(uint8_t *dst, ptrdiff_t stride,
+                                  const uint8_t *top, int sz)
+{
+    vec_u8 v[2];
+    int y;
+
+    ld_row(v, top, sz);
+    for (y = 0; y < sz; y++, dst += stride)
+        st_row(dst, v, sz);
+}
+
+/* left[] is stored bottom to top */
+static av_always_inline void hor(uint8_t *dst, ptrdiff_t stride,
+                                 const uint8_t *left, int sz)
+{
+    int y;
+
+    for (y = 0; y < sz; y++, dst += stride) {
+        const vec_u8 v[2] = { vec_splat_u8(left[sz - 1 - y]),
+                              vec_splat_u8(left[sz - 1 - y]) };
+        st_row(dst, v, sz);
+    }
+}
+
+static av_always_inline void tm(uint8_t *dst, ptrdiff_t stride,
+                                const uint8_t *left, const uint8_t *top, int sz)
+{
+    const int n = sz >= 16 ? sz / 8 : 1;
+    vec_s16 t[4];
+    int x, y;
+
+    if (sz == 4)
+        t[0] = vec_ld4_u8_s16(top);
+    else
+        for (x = 0; x < n; x++)
+            t[x] = vec_ld_u8_s16(top + 8 * x);
+
+    for (y = 0; y < sz; y++, dst += stride) {
+        const vec_s16 d = vec_splat_s16(left[sz - 1 - y] - top[-1]);
+        vec_u8 v[2];
+
+        if (sz <= 8) {
+            v[0] = vec_packus_s16(t[0] + d, t[0] + d);
+        } else {
+            for (x = 0; x < n; x += 2)
+                v[x >> 1] = vec_packus_s16(t[x] + d, t[x + 1] + d);
+        }
+        st_row(dst, v, sz);
+    }
+}
+
+#define INTRA_PRED(sz, log2sz)                                                  \
+void ff_vp9_vert_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 const uint8_t *left,           \
+                                                 const uint8_t *top)            \
+{                                                                               \
+    vert(dst, stride, top, sz);                                                 \
+}                                                                               \
+                                                                                \
+void ff_vp9_hor_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                const uint8_t *left,            \
+                                                const uint8_t *top)             \
+{                                                                               \
+    hor(dst, stride, left, sz);                                                 \
+}                                                                               \
+                                                                                \
+void ff_vp9_tm_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride,  \
+                                               const uint8_t *left,             \
+                                               const uint8_t *top)              \
+{                                                                               \
+    tm(dst, stride, left, top, sz);                                             \
+}                                                                               \
+                                                                                \
+void ff_vp9_dc_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride,  \
+                                               const uint8_t *left,             \
+                                               const uint8_t *top)              \
+{                                                                               \
+    fill(dst, stride, (sum_px(left, sz) + sum_px(top, sz) + sz) >> (log2sz + 1), sz); \
+}                                                                               \
+                                                                                \
+void ff_vp9_dc_left_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                    const uint8_t *left,        \
+                                                    const uint8_t *top)         \
+{                                                                               \
+    fill(dst, stride, (sum_px(left, sz) + sz / 2) >> log2sz, sz);               \
+}                                                                               \
+                                                                                \
+void ff_vp9_dc_top_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                   const uint8_t *left,         \
+                                                   const uint8_t *top)          \
+{                                                                               \
+    fill(dst, stride, (sum_px(top, sz) + sz / 2) >> log2sz, sz);                \
+}                                                                               \
+                                                                                \
+void ff_vp9_dc_127_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                   const uint8_t *left,         \
+                                                   const uint8_t *top)          \
+{                                                                               \
+    fill(dst, stride, 127, sz);                                                 \
+}                                                                               \
+                                                                                \
+void ff_vp9_dc_128_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                   const uint8_t *left,         \
+                                                   const uint8_t *top)          \
+{                                                                               \
+    fill(dst, stride, 128, sz);                                                 \
+}                                                                               \
+                                                                                \
+void ff_vp9_dc_129_ ## sz ## x ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                   const uint8_t *left,         \
+                                                   const uint8_t *top)          \
+{                                                                               \
+    fill(dst, stride, 129, sz);                                                 \
+}
+
+INTRA_PRED(4,  2)
+INTRA_PRED(8,  3)
+INTRA_PRED(16, 4)
+INTRA_PRED(32, 5)
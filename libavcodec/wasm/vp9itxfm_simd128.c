@@ -0,0 +1,638 @@
+/*
+ * VP9 inverse transforms, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "vp9dsp_wasm.h"
+
+/*
+ * The 1-D transforms are the ones from vp9dsp_template.c evaluated on
+ * 32-bit lanes, four columns at a time. Like in C, the intermediate and
+ * final coefficients are truncated to 16 bits, so the output is bit-exact
+ * for any input.
+ */
+#define IN(x) in[x]
+
+static av_always_inline void idct4_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0, t1, t2, t3;
+
+    t0 = ((IN(0) + IN(2)) * 11585 + (1 << 13)) >> 14;
+    t1 = ((IN(0) - IN(2)) * 11585 + (1 << 13)) >> 14;
+    t2 = (IN(1) *  6270 - IN(3) * 15137 + (1 << 13)) >> 14;
+    t3 = (IN(1) * 15137 + IN(3) *  6270 + (1 << 13)) >> 14;
+
+    out[0] = t0 + t3;
+    out[1] = t1 + t2;
+    out[2] = t1 - t2;
+    out[3] = t0 - t3;
+}
+
+static av_always_inline void iadst4_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0, t1, t2, t3;
+
+    t0 =  5283 * IN(0) + 15212 * IN(2) +  9929 * IN(3);
+    t1 =  9929 * IN(0) -  5283 * IN(2) - 15212 * IN(3);
+    t2 = 13377 * (IN(0) - IN(2) + IN(3));
+    t3 = 13377 * IN(1);
+
+    out[0] = (t0 + t3      + (1 << 13)) >> 14;
+    out[1] = (t1 + t3      + (1 << 13)) >> 14;
+    out[2] = (t2           + (1 << 13)) >> 14;
+    out[3] = (t0 + t1 - t3 + (1 << 13)) >> 14;
+}
+
+static av_always_inline void idct8_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0, t0a, t1, t1a, t2, t2a, t3, t3a, t4, t4a, t5, t5a, t6, t6a, t7, t7a;
+
+    t0a = ((IN(0) + IN(4)) * 11585 + (1 << 13)) >> 14;
+    t1a = ((IN(0) - IN(4)) * 11585 + (1 << 13)) >> 14;
+    t2a = (IN(2) *  6270 - IN(6) * 15137 + (1 << 13)) >> 14;
+    t3a = (IN(2) * 15137 + IN(6) *  6270 + (1 << 13)) >> 14;
+    t4a = (IN(1) *  3196 - IN(7) * 16069 + (1 << 13)) >> 14;
+    t5a = (IN(5) * 13623 - IN(3) *  9102 + (1 << 13)) >> 14;
+    t6a = (IN(5) *  9102 + IN(3) * 13623 + (1 << 13)) >> 14;
+    t7a = (IN(1) * 16069 + IN(7) *  3196 + (1 << 13)) >> 14;
+
+    t0  = t0a + t3a;
+    t1  = t1a + t2a;
+    t2  = t1a - t2a;
+    t3  = t0a - t3a;
+    t4  = t4a + t5a;
+    t5a = t4a - t5a;
+    t7  = t7a + t6a;
+    t6a = t7a - t6a;
+
+    t5  = ((t6a - t5a) * 11585 + (1 << 13)) >> 14;
+    t6  = ((t6a + t5a) * 11585 + (1 << 13)) >> 14;
+
+    out[0] = t0 + t7;
+    out[1] = t1 + t6;
+    out[2] = t2 + t5;
+    out[3] = t3 + t4;
+    out[4] = t3 - t4;
+    out[5] = t2 - t5;
+    out[6] = t1 - t6;
+    out[7] = t0 - t7;
+}
+
+static av_always_inline void iadst8_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0, t0a, t1, t1a, t2, t2a, t3, t3a, t4, t4a, t5, t5a, t6, t6a, t7, t7a;
+
+    t0a = 16305 * IN(7) +  1606 * IN(0);
+    t1a =  1606 * IN(7) - 16305 * IN(0);
+    t2a = 14449 * IN(5) +  7723 * IN(2);
+    t3a =  7723 * IN(5) - 14449 * IN(2);
+    t4a = 10394 * IN(3) + 12665 * IN(4);
+    t5a = 12665 * IN(3) - 10394 * IN(4);
+    t6a =  4756 * IN(1) + 15679 * IN(6);
+    t7a = 15679 * IN(1) -  4756 * IN(6);
+
+    t0 = (t0a + t4a + (1 << 13)) >> 14;
+    t1 = (t1a + t5a + (1 << 13)) >> 14;
+    t2 = (t2a + t6a + (1 << 13)) >> 14;
+    t3 = (t3a + t7a + (1 << 13)) >> 14;
+    t4 = (t0a - t4a + (1 << 13)) >> 14;
+    t5 = (t1a - t5a + (1 << 13)) >> 14;
+    t6 = (t2a - t6a + (1 << 13)) >> 14;
+    t7 = (t3a - t7a + (1 << 13)) >> 14;
+
+    t4a = 15137 * t4 +  6270 * t5;
+    t5a =  6270 * t4 - 15137 * t5;
+    t6a = 15137 * t7 -  6270 * t6;
+    t7a =  6270 * t7 + 15137 * t6;
+
+    out[0] =   t0 + t2;
+    out[7] = -(t1 + t3);
+    t2     =   t0 - t2;
+    t3     =   t1 - t3;
+
+    out[1] = -((t4a + t6a + (1 << 13)) >> 14);
+    out[6] =   (t5a + t7a + (1 << 13)) >> 14;
+    t6     =   (t4a - t6a + (1 << 13)) >> 14;
+    t7     =   (t5a - t7a + (1 << 13)) >> 14;
+
+    out[3] = -(((t2 + t3) * 11585 + (1 << 13)) >> 14);
+    out[4] =   ((t2 - t3) * 11585 + (1 << 13)) >> 14;
+    out[2] =   ((t6 + t7) * 11585 + (1 << 13)) >> 14;
+    out[5] = -(((t6 - t7) * 11585 + (1 << 13)) >> 14);
+}
+
+static av_always_inline void idct16_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15;
+    vec_s32 t0a, t1a, t2a, t3a, t4a, t5a, t6a, t7a;
+    vec_s32 t8a, t9a, t10a, t11a, t12a, t13a, t14a, t15a;
+
+    t0a  = ((IN(0) + IN(8)) * 11585 + (1 << 13)) >> 14;
+    t1a  = ((IN(0) - IN(8)) * 11585 + (1 << 13)) >> 14;
+    t2a  = (IN(4)  *  6270 - IN(12) * 15137 + (1 << 13)) >> 14;
+    t3a  = (IN(4)  * 15137 + IN(12) *  6270 + (1 << 13)) >> 14;
+    t4a  = (IN(2)  *  3196 - IN(14) * 16069 + (1 << 13)) >> 14;
+    t7a  = (IN(2)  * 16069 + IN(14) *  3196 + (1 << 13)) >> 14;
+    t5a  = (IN(10) * 13623 - IN(6)  *  9102 + (1 << 13)) >> 14;
+    t6a  = (IN(10) *  9102 + IN(6)  * 13623 + (1 << 13)) >> 14;
+    t8a  = (IN(1)  *  1606 - IN(15) * 16305 + (1 << 13)) >> 14;
+    t15a = (IN(1)  * 16305 + IN(15) *  1606 + (1 << 13)) >> 14;
+    t9a  = (IN(9)  * 12665 - IN(7)  * 10394 + (1 << 13)) >> 14;
+    t14a = (IN(9)  * 10394 + IN(7)  * 12665 + (1 << 13)) >> 14;
+    t10a = (IN(5)  *  7723 - IN(11) * 14449 + (1 << 13)) >> 14;
+    t13a = (IN(5)  * 14449 + IN(11) *  7723 + (1 << 13)) >> 14;
+    t11a = (IN(13) * 15679 - IN(3)  *  4756 + (1 << 13)) >> 14;
+    t12a = (IN(13) *  4756 + IN(3)  * 15679 + (1 << 13)) >> 14;
+
+    t0  = t0a  + t3a;
+    t1  = t1a  + t2a;
+    t2  = t1a  - t2a;
+    t3  = t0a  - t3a;
+    t4  = t4a  + t5a;
+    t5  = t4a  - t5a;
+    t6  = t7a  - t6a;
+    t7  = t7a  + t6a;
+    t8  = t8a  + t9a;
+    t9  = t8a  - t9a;
+    t10 = t11a - t10a;
+    t11 = t11a + t10a;
+    t12 = t12a + t13a;
+    t13 = t12a - t13a;
+    t14 = t15a - t14a;
+    t15 = t15a + t14a;
+
+    t5a  = ((t6 - t5) * 11585 + (1 << 13)) >> 14;
+    t6a  = ((t6 + t5) * 11585 + (1 << 13)) >> 14;
+    t9a  = (  t14 *  6270 - t9  * 15137  + (1 << 13)) >> 14;
+    t14a = (  t14 * 15137 + t9  *  6270  + (1 << 13)) >> 14;
+    t10a = (-(t13 * 15137 + t10 *  6270) + (1 << 13)) >> 14;
+    t13a = (  t13 *  6270 - t10 * 15137  + (1 << 13)) >> 14;
+
+    t0a  = t0   + t7;
+    t1a  = t1   + t6a;
+    t2a  = t2   + t5a;
+    t3a  = t3   + t4;
+    t4   = t3   - t4;
+    t5   = t2   - t5a;
+    t6   = t1   - t6a;
+    t7   = t0   - t7;
+    t8a  = t8   + t11;
+    t9   = t9a  + t10a;
+    t10  = t9a  - t10a;
+    t11a = t8   - t11;
+    t12a = t15  - t12;
+    t13  = t14a - t13a;
+    t14  = t14a + t13a;
+    t15a = t15  + t12;
+
+    t10a = ((t13  - t10)  * 11585 + (1 << 13)) >> 14;
+    t13a = ((t13  + t10)  * 11585 + (1 << 13)) >> 14;
+    t11  = ((t12a - t11a) * 11585 + (1 << 13)) >> 14;
+    t12  = ((t12a + t11a) * 11585 + (1 << 13)) >> 14;
+
+    out[ 0] = t0a + t15a;
+    out[ 1] = t1a + t14;
+    out[ 2] = t2a + t13a;
+    out[ 3] = t3a + t12;
+    out[ 4] = t4  + t11;
+    out[ 5] = t5  + t10a;
+    out[ 6] = t6  + t9;
+    out[ 7] = t7  + t8a;
+    out[ 8] = t7  - t8a;
+    out[ 9] = t6  - t9;
+    out[10] = t5  - t10a;
+    out[11] = t4  - t11;
+    out[12] = t3a - t12;
+    out[13] = t2a - t13a;
+    out[14] = t1a - t14;
+    out[15] = t0a - t15a;
+}
+
+static av_always_inline void iadst16_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15;
+    vec_s32 t0a, t1a, t2a, t3a, t4a, t5a, t6a, t7a;
+    vec_s32 t8a, t9a, t10a, t11a, t12a, t13a, t14a, t15a;
+
+    t0  = IN(15) * 16364 + IN(0)  *   804;
+    t1  = IN(15) *   804 - IN(0)  * 16364;
+    t2  = IN(13) * 15893 + IN(2)  *  3981;
+    t3  = IN(13) *  3981 - IN(2)  * 15893;
+    t4  = IN(11) * 14811 + IN(4)  *  7005;
+    t5  = IN(11) *  7005 - IN(4)  * 14811;
+    t6  = IN(9)  * 13160 + IN(6)  *  9760;
+    t7  = IN(9)  *  9760 - IN(6)  * 13160;
+    t8  = IN(7)  * 11003 + IN(8)  * 12140;
+    t9  = IN(7)  * 12140 - IN(8)  * 11003;
+    t10 = IN(5)  *  8423 + IN(10) * 14053;
+    t11 = IN(5)  * 14053 - IN(10) *  8423;
+    t12 = IN(3)  *  5520 + IN(12) * 15426;
+    t13 = IN(3)  * 15426 - IN(12) *  5520;
+    t14 = IN(1)  *  2404 + IN(14) * 16207;
+    t15 = IN(1)  * 16207 - IN(14) *  2404;
+
+    t0a  = ((1 << 13) + t0 + t8 ) >> 14;
+    t1a  = ((1 << 13) + t1 + t9 ) >> 14;
+    t2a  = ((1 << 13) + t2 + t10) >> 14;
+    t3a  = ((1 << 13) + t3 + t11) >> 14;
+    t4a  = ((1 << 13) + t4 + t12) >> 14;
+    t5a  = ((1 << 13) + t5 + t13) >> 14;
+    t6a  = ((1 << 13) + t6 + t14) >> 14;
+    t7a  = ((1 << 13) + t7 + t15) >> 14;
+    t8a  = ((1 << 13) + t0 - t8 ) >> 14;
+    t9a  = ((1 << 13) + t1 - t9 ) >> 14;
+    t10a = ((1 << 13) + t2 - t10) >> 14;
+    t11a = ((1 << 13) + t3 - t11) >> 14;
+    t12a = ((1 << 13) + t4 - t12) >> 14;
+    t13a = ((1 << 13) + t5 - t13) >> 14;
+    t14a = ((1 << 13) + t6 - t14) >> 14;
+    t15a = ((1 << 13) + t7 - t15) >> 14;
+
+    t8   = t8a  * 16069 + t9a  *  3196;
+    t9   = t8a  *  3196 - t9a  * 16069;
+    t10  = t10a *  9102 + t11a * 13623;
+    t11  = t10a * 13623 - t11a *  9102;
+    t12  = t13a * 16069 - t12a *  3196;
+    t13  = t13a *  3196 + t12a * 16069;
+    t14  = t15a *  9102 - t14a * 13623;
+    t15  = t15a * 13623 + t14a *  9102;
+
+    t0   = t0a + t4a;
+    t1   = t1a + t5a;
+    t2   = t2a + t6a;
+    t3   = t3a + t7a;
+    t4   = t0a - t4a;
+    t5   = t1a - t5a;
+    t6   = t2a - t6a;
+    t7   = t3a - t7a;
+    t8a  = ((1 << 13) + t8  + t12) >> 14;
+    t9a  = ((1 << 13) + t9  + t13) >> 14;
+    t10a = ((1 << 13) + t10 + t14) >> 14;
+    t11a = ((1 << 13) + t11 + t15) >> 14;
+    t12a = ((1 << 13) + t8  - t12) >> 14;
+    t13a = ((1 << 13) + t9  - t13) >> 14;
+    t14a = ((1 << 13) + t10 - t14) >> 14;
+    t15a = ((1 << 13) + t11 - t15) >> 14;
+
+    t4a  = t4 * 15137 + t5 *  6270;
+    t5a  = t4 *  6270 - t5 * 15137;
+    t6a  = t7 * 15137 - t6 *  6270;
+    t7a  = t7 *  6270 + t6 * 15137;
+    t12  = t12a * 15137 + t13a *  6270;
+    t13  = t12a *  6270 - t13a * 15137;
+    t14  = t15a * 15137 - t14a *  6270;
+    t15  = t15a *  6270 + t14a * 15137;
+
+    out[ 0] =   t0 + t2;
+    out[15] = -(t1 + t3);
+    t2a     =   t0 - t2;
+    t3a     =   t1 - t3;
+    out[ 3] = -(((1 << 13) + t4a + t6a) >> 14);
+    out[12] =   ((1 << 13) + t5a + t7a) >> 14;
+    t6      =   ((1 << 13) + t4a - t6a) >> 14;
+    t7      =   ((1 << 13) + t5a - t7a) >> 14;
+    out[ 1] = -(t8a + t10a);
+    out[14] =   t9a + t11a;
+    t10     =   t8a - t10a;
+    t11     =   t9a - t11a;
+    out[ 2] =   ((1 << 13) + t12 + t14) >> 14;
+    out[13] = -(((1 << 13) + t13 + t15) >> 14);
+    t14a    =   ((1 << 13) + t12 - t14) >> 14;
+    t15a    =   ((1 << 13) + t13 - t15) >> 14;
+
+    out[ 7] = (-(t2a  + t3a)  * 11585  + (1 << 13)) >> 14;
+    out[ 8] = ( (t2a  - t3a)  * 11585  + (1 << 13)) >> 14;
+    out[ 4] = ( (t7   + t6)   * 11585  + (1 << 13)) >> 14;
+    out[11] = ( (t7   - t6)   * 11585  + (1 << 13)) >> 14;
+    out[ 6] = ( (t11  + t10)  * 11585  + (1 << 13)) >> 14;
+    out[ 9] = ( (t11  - t10)  * 11585  + (1 << 13)) >> 14;
+    out[ 5] = (-(t14a + t15a) * 11585  + (1 << 13)) >> 14;
+    out[10] = ( (t14a - t15a) * 11585  + (1 << 13)) >> 14;
+}
+
+static av_always_inline void idct32_1d(const vec_s32 *in, vec_s32 *out)
+{
+    vec_s32 t0a  = ((IN(0) + IN(16)) * 11585         + (1 << 13)) >> 14;
+    vec_s32 t1a  = ((IN(0) - IN(16)) * 11585         + (1 << 13)) >> 14;
+    vec_s32 t2a  = (IN( 8) *  6270 - IN(24) * 15137 + (1 << 13)) >> 14;
+    vec_s32 t3a  = (IN( 8) * 15137 + IN(24) *  6270 + (1 << 13)) >> 14;
+    vec_s32 t4a  = (IN( 4) *  3196 - IN(28) * 16069 + (1 << 13)) >> 14;
+    vec_s32 t7a  = (IN( 4) * 16069 + IN(28) *  3196 + (1 << 13)) >> 14;
+    vec_s32 t5a  = (IN(20) * 13623 - IN(12) *  9102 + (1 << 13)) >> 14;
+    vec_s32 t6a  = (IN(20) *  9102 + IN(12) * 13623 + (1 << 13)) >> 14;
+    vec_s32 t8a  = (IN( 2) *  1606 - IN(30) * 16305 + (1 << 13)) >> 14;
+    vec_s32 t15a = (IN( 2) * 16305 + IN(30) *  1606 + (1 << 13)) >> 14;
+    vec_s32 t9a  = (IN(18) * 12665 - IN(14) * 10394 + (1 << 13)) >> 14;
+    vec_s32 t14a = (IN(18) * 10394 + IN(14) * 12665 + (1 << 13)) >> 14;
+    vec_s32 t10a = (IN(10) *  7723 - IN(22) * 14449 + (1 << 13)) >> 14;
+    vec_s32 t13a = (IN(10) * 14449 + IN(22) *  7723 + (1 << 13)) >> 14;
+    vec_s32 t11a = (IN(26) * 15679 - IN( 6) *  4756 + (1 << 13)) >> 14;
+    vec_s32 t12a = (IN(26) *  4756 + IN( 6) * 15679 + (1 << 13)) >> 14;
+    vec_s32 t16a = (IN( 1) *   804 - IN(31) * 16364 + (1 << 13)) >> 14;
+    vec_s32 t31a = (IN( 1) * 16364 + IN(31) *   804 + (1 << 13)) >> 14;
+    vec_s32 t17a = (IN(17) * 12140 - IN(15) * 11003 + (1 << 13)) >> 14;
+    vec_s32 t30a = (IN(17) * 11003 + IN(15) * 12140 + (1 << 13)) >> 14;
+    vec_s32 t18a = (IN( 9) *  7005 - IN(23) * 14811 + (1 << 13)) >> 14;
+    vec_s32 t29a = (IN( 9) * 14811 + IN(23) *  7005 + (1 << 13)) >> 14;
+    vec_s32 t19a = (IN(25) * 15426 - IN( 7) *  5520 + (1 << 13)) >> 14;
+    vec_s32 t28a = (IN(25) *  5520 + IN( 7) * 15426 + (1 << 13)) >> 14;
+    vec_s32 t20a = (IN( 5) *  3981 - IN(27) * 15893 + (1 << 13)) >> 14;
+    vec_s32 t27a = (IN( 5) * 15893 + IN(27) *  3981 + (1 << 13)) >> 14;
+    vec_s32 t21a = (IN(21) * 14053 - IN(11) *  8423 + (1 << 13)) >> 14;
+    vec_s32 t26a = (IN(21) *  8423 + IN(11) * 14053 + (1 << 13)) >> 14;
+    vec_s32 t22a = (IN(13) *  9760 - IN(19) * 13160 + (1 << 13)) >> 14;
+    vec_s32 t25a = (IN(13) * 13160 + IN(19) *  9760 + (1 << 13)) >> 14;
+    vec_s32 t23a = (IN(29) * 16207 - IN( 3) *  2404 + (1 << 13)) >> 14;
+    vec_s32 t24a = (IN(29) *  2404 + IN( 3) * 16207 + (1 << 13)) >> 14;
+
+    vec_s32 t0  = t0a  + t3a;
+    vec_s32 t1  = t1a  + t2a;
+    vec_s32 t2  = t1a  - t2a;
+    vec_s32 t3  = t0a  - t3a;
+    vec_s32 t4  = t4a  + t5a;
+    vec_s32 t5  = t4a  - t5a;
+    vec_s32 t6  = t7a  - t6a;
+    vec_s32 t7  = t7a  + t6a;
+    vec_s32 t8  = t8a  + t9a;
+    vec_s32 t9  = t8a  - t9a;
+    vec_s32 t10 = t11a - t10a;
+    vec_s32 t11 = t11a + t10a;
+    vec_s32 t12 = t12a + t13a;
+    vec_s32 t13 = t12a - t13a;
+    vec_s32 t14 = t15a - t14a;
+    vec_s32 t15 = t15a + t14a;
+    vec_s32 t16 = t16a + t17a;
+    vec_s32 t17 = t16a - t17a;
+    vec_s32 t18 = t19a - t18a;
+    vec_s32 t19 = t19a + t18a;
+    vec_s32 t20 = t20a + t21a;
+    vec_s32 t21 = t20a - t21a;
+    vec_s32 t22 = t23a - t22a;
+    vec_s32 t23 = t23a + t22a;
+    vec_s32 t24 = t24a + t25a;
+    vec_s32 t25 = t24a - t25a;
+    vec_s32 t26 = t27a - t26a;
+    vec_s32 t27 = t27a + t26a;
+    vec_s32 t28 = t28a + t29a;
+    vec_s32 t29 = t28a - t29a;
+    vec_s32 t30 = t31a - t30a;
+    vec_s32 t31 = t31a + t30a;
+
+    t5a  = ((t6 - t5) * 11585             + (1 << 13)) >> 14;
+    t6a  = ((t6 + t5) * 11585             + (1 << 13)) >> 14;
+    t9a  = (  t14 *  6270 - t9  * 15137  + (1 << 13)) >> 14;
+    t14a = (  t14 * 15137 + t9  *  6270  + (1 << 13)) >> 14;
+    t10a = (-(t13 * 15137 + t10 *  6270) + (1 << 13)) >> 14;
+    t13a = (  t13 *  6270 - t10 * 15137  + (1 << 13)) >> 14;
+    t17a = (  t30 *  3196 - t17 * 16069  + (1 << 13)) >> 14;
+    t30a = (  t30 * 16069 + t17 *  3196  + (1 << 13)) >> 14;
+    t18a = (-(t29 * 16069 + t18 *  3196) + (1 << 13)) >> 14;
+    t29a = (  t29 *  3196 - t18 * 16069  + (1 << 13)) >> 14;
+    t21a = (  t26 * 13623 - t21 *  9102  + (1 << 13)) >> 14;
+    t26a = (  t26 *  9102 + t21 * 13623  + (1 << 13)) >> 14;
+    t22a = (-(t25 *  9102 + t22 * 13623) + (1 << 13)) >> 14;
+    t25a = (  t25 * 13623 - t22 *  9102  + (1 << 13)) >> 14;
+
+    t0a  = t0   + t7;
+    t1a  = t1   + t6a;
+    t2a  = t2   + t5a;
+    t3a  = t3   + t4;
+    t4a  = t3   - t4;
+    t5   = t2   - t5a;
+    t6   = t1   - t6a;
+    t7a  = t0   - t7;
+    t8a  = t8   + t11;
+    t9   = t9a  + t10a;
+    t10  = t9a  - t10a;
+    t11a = t8   - t11;
+    t12a = t15  - t12;
+    t13  = t14a - t13a;
+    t14  = t14a + t13a;
+    t15a = t15  + t12;
+    t16a = t16  + t19;
+    t17  = t17a + t18a;
+    t18  = t17a - t18a;
+    t19a = t16  - t19;
+    t20a = t23  - t20;
+    t21  = t22a - t21a;
+    t22  = t22a + t21a;
+    t23a = t23  + t20;
+    t24a = t24  + t27;
+    t25  = t25a + t26a;
+    t26  = t25a - t26a;
+    t27a = t24  - t27;
+    t28a = t31  - t28;
+    t29  = t30a - t29a;
+    t30  = t30a + t29a;
+    t31a = t31  + t28;
+
+    t10a = ((t13  - t10)  * 11585           + (1 << 13)) >> 14;
+    t13a = ((t13  + t10)  * 11585           + (1 << 13)) >> 14;
+    t11  = ((t12a - t11a) * 11585           + (1 << 13)) >> 14;
+    t12  = ((t12a + t11a) * 11585           + (1 << 13)) >> 14;
+    t18a = (  t29  *  6270 - t18  * 15137  + (1 << 13)) >> 14;
+    t29a = (  t29  * 15137 + t18  *  6270  + (1 << 13)) >> 14;
+    t19  = (  t28a *  6270 - t19a * 15137  + (1 << 13)) >> 14;
+    t28  = (  t28a * 15137 + t19a *  6270  + (1 << 13)) >> 14;
+    t20  = (-(t27a * 15137 + t20a *  6270) + (1 << 13)) >> 14;
+    t27  = (  t27a *  6270 - t20a * 15137  + (1 << 13)) >> 14;
+    t21a = (-(t26  * 15137 + t21  *  6270) + (1 << 13)) >> 14;
+    t26a = (  t26  *  6270 - t21  * 15137  + (1 << 13)) >> 14;
+
+    t0   = t0a + t15a;
+    t1   = t1a + t14;
+    t2   = t2a + t13a;
+    t3   = t3a + t12;
+    t4   = t4a + t11;
+    t5a  = t5  + t10a;
+    t6a  = t6  + t9;
+    t7   = t7a + t8a;
+    t8   = t7a - t8a;
+    t9a  = t6  - t9;
+    t10  = t5  - t10a;
+    t11a = t4a - t11;
+    t12a = t3a - t12;
+    t13  = t2a - t13a;
+    t14a = t1a - t14;
+    t15  = t0a - t15a;
+    t16  = t16a + t23a;
+    t17a = t17  + t22;
+    t18  = t18a + t21a;
+    t19a = t19  + t20;
+    t20a = t19  - t20;
+    t21  = t18a - t21a;
+    t22a = t17  - t22;
+    t23  = t16a - t23a;
+    t24  = t31a - t24a;
+    t25a = t30  - t25;
+    t26  = t29a - t26a;
+    t27a = t28  - t27;
+    t28a = t28  + t27;
+    t29  = t29a + t26a;
+    t30a = t30  + t25;
+    t31  = t31a + t24a;
+
+    t20  = ((t27a - t20a) * 11585 + (1 << 13)) >> 14;
+    t27  = ((t27a + t20a) * 11585 + (1 << 13)) >> 14;
+    t21a = ((t26  - t21 ) * 11585 + (1 << 13)) >> 14;
+    t26a = ((t26  + t21 ) * 11585 + (1 << 13)) >> 14;
+    t22  = ((t25a - t22a) * 11585 + (1 << 13)) >> 14;
+    t25  = ((t25a + t22a) * 11585 + (1 << 13)) >> 14;
+    t23a = ((t24  - t23 ) * 11585 + (1 << 13)) >> 14;
+    t24a = ((t24  + t23 ) * 11585 + (1 << 13)) >> 14;
+
+    out[ 0] = t0   + t31;
+    out[ 1] = t1   + t30a;
+    out[ 2] = t2   + t29;
+    out[ 3] = t3   + t28a;
+    out[ 4] = t4   + t27;
+    out[ 5] = t5a  + t26a;
+    out[ 6] = t6a  + t25;
+    out[ 7] = t7   + t24a;
+    out[ 8] = t8   + t23a;
+    out[ 9] = t9a  + t22;
+    out[10] = t10  + t21a;
+    out[11] = t11a + t20;
+    out[12] = t12a + t19a;
+    out[13] = t13  + t18;
+    out[14] = t14a + t17a;
+    out[15] = t15  + t16;
+    out[16] = t15  - t16;
+    out[17] = t14a - t17a;
+    out[18] = t13  - t18;
+    out[19] = t12a - t19a;
+    out[20] = t11a - t20;
+    out[21] = t10  - t21a;
+    out[22] = t9a  - t22;
+    out[23] = t8   - t23a;
+    out[24] = t7   - t24a;
+    out[25] = t6a  - t25;
+    out[26] = t5a  - t26a;
+    out[27] = t4   - t27;
+    out[28] = t3   - t28a;
+    out[29] = t2   - t29;
+    out[30] = t1   - t30a;
+    out[31] = t0   - t31;
+}
+
+#undef IN
+
+static av_always_inline vec_s32 ld4_s32(const int16_t *p)
+{
+    return vec_convert(vec_ld_s16h(p), vec_s32);
+}
+
+static av_always_inline void st4_s16(int16_t *p, vec_s32 v)
+{
+    vec_s16h s = vec_convert(v, vec_s16h);
+    memcpy(p, &s, sizeof(s));
+}
+
+static av_always_inline void add4(uint8_t *dst, vec_s32 v, int bits)
+{
+    vec_s16 pix = vec_ld4_u8_s16(dst);
+    /* truncate to 16 bits before rounding, like the dctcoef output in C */
+    vec_s16h s = vec_convert(v, vec_s16h);
+    vec_s16 r;
+
+    v = (vec_convert(s, vec_s32) + (1 << (bits - 1))) >> bits;
+    s = vec_convert(v, vec_s16h);
+    r = vec_shuffle(s, s, 0, 1, 2, 3, 0, 1, 2, 3);
+    vec_st4_u8(dst, vec_packus_s16(pix + r, pix));
+}
+
+static av_always_inline void dc_only_add(uint8_t *dst, ptrdiff_t stride,
+                                         int16_t *block, int sz, int bits)
+{
+    const int t = ((((int) block[0] * 11585 + (1 << 13)) >> 14)
+                                        * 11585 + (1 << 13)) >> 14;
+    const vec_s16 dc = vec_splat_s16((t + (1 << (bits - 1))) >> bits);
+    int x, y;
+
+    block[0] = 0;
+    for (y = 0; y < sz; y++) {
+        if (sz == 4) {
+            vec_s16 pix = vec_ld4_u8_s16(dst);
+            vec_st4_u8(dst, vec_packus_s16(pix + dc, pix));
+        } else {
+            for (x = 0; x < sz; x += 8) {
+                vec_s16 pix = vec_ld_u8_s16(dst + x);
+                vec_st8_u8(dst + x, vec_packus_s16(pix + dc, pix));
+            }
+        }
+        dst += stride;
+    }
+}
+
+/*
+ * First pass on the columns of block, stored transposed in tmp like in C,
+ * second pass on the columns of tmp, which gives four output pixels of a
+ * row per vector.
+ */
+#define ITXFM(type_a, type_b, sz, bits, has_dconly)                             \
+void ff_vp9_ ## type_a ## _ ## type_b ## _ ## sz ## x ## sz ## _add_8_simd128(uint8_t *dst, \
+                                                                    ptrdiff_t stride,        \
+                                                                    int16_t *block,          \
+                                                                    int eob)                 \
+{                                                                               \
+    LOCAL_ALIGNED_16(int16_t, tmp, [sz * sz]);                                  \
+    vec_s32 in[sz], out[sz];                                                    \
+    int i, k;                                                                   \
+                                                                                \
+    if (has_dconly && eob == 1) {                                               \
+        dc_only_add(dst, stride, block, sz, bits);                              \
+        return;                                                                 \
+    }                                                                           \
+                                                                                \
+    for (i = 0; i < sz; i += 4) {                                               \
+        for (k = 0; k < sz; k++)                                                \
+            in[k] = ld4_s32(block + k * sz + i);                                \
+        type_a ## sz ## _1d(in, out);                                           \
+        for (k = 0; k < sz; k += 4) {                                           \
+            VEC_TRANSPOSE4_S32(out[k], out[k + 1], out[k + 2], out[k + 3]);     \
+            st4_s16(tmp + (i + 0) * sz + k, out[k]);                            \
+            st4_s16(tmp + (i + 1) * sz + k, out[k + 1]);                        \
+            st4_s16(tmp + (i + 2) * sz + k, out[k + 2]);                        \
+            st4_s16(tmp + (i + 3) * sz + k, out[k + 3]);                        \
+        }                                                                       \
+    }                                                                           \
+    memset(block, 0, sz * sz * sizeof(*block));                                 \
+                                                                                \
+    for (i = 0; i < sz; i += 4) {                                               \
+        for (k = 0; k < sz; k++)                                                \
+            in[k] = ld4_s32(tmp + k * sz + i);                                  \
+        type_b ## sz ## _1d(in, out);                                           \
+        for (k = 0; k < sz; k++)                                                \
+            add4(dst + k * stride + i, out[k], bits);                           \
+    }                                                                           \
+}
+
+#define ITXFM_TYPES(sz, bits)            \
+ITXFM(idct,  idct,  sz, bits, 1)         \
+ITXFM(iadst, idct,  sz, bits, 0)         \
+ITXFM(idct,  iadst, sz, bits, 0)         \
+ITXFM(iadst, iadst, sz, bits, 0)
+
+ITXFM_TYPES(4, 4)
+ITXFM_TYPES(8, 5)
+ITXFM_TYPES(16, 6)
+ITXFM(idct, idct, 32, 6, 1)
@@ -0,0 +1,222 @@
+/*
+ * VP9 loop filter, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/wasm/util_simd128.h"
+#include "vp9dsp_wasm.h"
+
+#define ABSD(a, b) vec_abs_s16((a) - (b))
+
+/*
+ * px[0..15] hold p7 ... p0, q0 ... q7 for 8 lines, one line per lane.
+ * Returns 0 if no line is filtered, so the caller can skip the stores.
+ */
+static av_always_inline int loop_filter(vec_s16 *px, int E, int I, int H, int wd)
+{
+    const vec_s16 p7 = px[0], p6 = px[1], p5 = px[2],  p4 = px[3];
+    const vec_s16 p3 = px[4], p2 = px[5], p1 = px[6],  p0 = px[7];
+    const vec_s16 q0 = px[8], q1 = px[9], q2 = px[10], q3 = px[11];
+    const vec_s16 q4 = px[12], q5 = px[13], q6 = px[14], q7 = px[15];
+    const vec_s16 zero = { 0 }, one = zero + 1, max = zero + 255;
+    const vec_s16 vI = vec_splat_s16(I), vE = vec_splat_s16(E), vH = vec_splat_s16(H);
+    vec_s16 fm, flat8in = zero, flat8out = zero, m16 = zero, m8 = zero, m4;
+    vec_s16 hev, f, f1, f2;
+
+    fm = (ABSD(p3, p2) <= vI) & (ABSD(p2, p1) <= vI) &
+         (ABSD(p1, p0) <= vI) & (ABSD(q1, q0) <= vI) &
+         (ABSD(q2, q1) <= vI) & (ABSD(q3, q2) <= vI) &
+         (ABSD(p0, q0) * 2 + (ABSD(p1, q1) >> 1) <= vE);
+    if (!((vec_s64)fm)[0] && !((vec_s64)fm)[1])
+        return 0;
+
+    if (wd >= 8) {
+        flat8in = (ABSD(p3, p0) <= one) & (ABSD(p2, p0) <= one) &
+                  (ABSD(p1, p0) <= one) & (ABSD(q1, q0) <= one) &
+                  (ABSD(q2, q0) <= one) & (ABSD(q3, q0) <= one);
+        if (wd >= 16) {
+            flat8out = (ABSD(p7, p0) <= one) & (ABSD(p6, p0) <= one) &
+                       (ABSD(p5, p0) <= one) & (ABSD(p4, p0) <= one) &
+                       (ABSD(q4, q0) <= one) & (ABSD(q5, q0) <= one) &
+                       (ABSD(q6, q0) <= one) & (ABSD(q7, q0) <= one);
+            m16 = fm & flat8in & flat8out;
+        }
+        m8 = fm & flat8in & ~m16;
+    }
+    m4 = fm & ~flat8in;
+
+    /* 4-tap filter, hev adds the outer tap and leaves p1/q1 alone */
+    hev = (ABSD(p1, p0) > vH) | (ABSD(q1, q0) > vH);
+    f   = vec_clip_s16(p1 - q1, zero - 128, zero + 127) & hev;
+    f   = vec_clip_s16(3 * (q0 - p0) + f, zero - 128, zero + 127);
+    f1  = vec_min_s16(f + 4, zero + 127) >> 3;
+    f2  = vec_min_s16(f + 3, zero + 127) >> 3;
+    f   = (f1 + 1) >> 1;
+    px[6] = vec_sel(m4 & ~hev, vec_clip_s16(p1 + f, zero, max), p1);
+    px[7] = vec_sel(m4, vec_clip_s16(p0 + f2, zero, max), p0);
+    px[8] = vec_sel(m4, vec_clip_s16(q0 - f1, zero, max), q0);
+    px[9] = vec_sel(m4 & ~hev, vec_clip_s16(q1 - f, zero, max), q1);
+
+    if (wd >= 8) {
+        px[5]  = vec_sel(m8, (p3 + p3 + p3 + 2 * p2 + p1 + p0 + q0 + 4) >> 3, px[5]);
+        px[6]  = vec_sel(m8, (p3 + p3 + p2 + 2 * p1 + p0 + q0 + q1 + 4) >> 3, px[6]);
+        px[7]  = vec_sel(m8, (p3 + p2 + p1 + 2 * p0 + q0 + q1 + q2 + 4) >> 3, px[7]);
+        px[8]  = vec_sel(m8, (p2 + p1 + p0 + 2 * q0 + q1 + q2 + q3 + 4) >> 3, px[8]);
+        px[9]  = vec_sel(m8, (p1 + p0 + q0 + 2 * q1 + q2 + q3 + q3 + 4) >> 3, px[9]);
+        px[10] = vec_sel(m8, (p0 + q0 + q1 + 2 * q2 + q3 + q3 + q3 + 4) >> 3, px[10]);
+    }
+
+    if (wd >= 16 && (((vec_s64)m16)[0] || ((vec_s64)m16)[1])) {
+        /* running sum over the 16-tap window, as in the C formulas */
+        vec_s16 s = p7 * 7 + p6 * 2 + p5 + p4 + p3 + p2 + p1 + p0 + q0 + 8;
+
+        px[1]  = vec_sel(m16, s >> 4, px[1]);
+        s += p5 - p7 - p6 + q1;
+        px[2]  = vec_sel(m16, s >> 4, px[2]);
+        s += p4 - p7 - p5 + q2;
+        px[3]  = vec_sel(m16, s >> 4, px[3]);
+        s += p3 - p7 - p4 + q3;
+        px[4]  = vec_sel(m16, s >> 4, px[4]);
+        s += p2 - p7 - p3 + q4;
+        px[5]  = vec_sel(m16, s >> 4, px[5]);
+        s += p1 - p7 - p2 + q5;
+        px[6]  = vec_sel(m16, s >> 4, px[6]);
+        s += p0 - p7 - p1 + q6;
+        px[7]  = vec_sel(m16, s >> 4, px[7]);
+        s += q0 - p7 - p0 + q7;
+        px[8]  = vec_sel(m16, s >> 4, px[8]);
+        s += q1 - p6 - q0 + q7;
+        px[9]  = vec_sel(m16, s >> 4, px[9]);
+        s += q2 - p5 - q1 + q7;
+        px[10] = vec_sel(m16, s >> 4, px[10]);
+        s += q3 - p4 - q2 + q7;
+        px[11] = vec_sel(m16, s >> 4, px[11]);
+        s += q4 - p3 - q3 + q7;
+        px[12] = vec_sel(m16, s >> 4, px[12]);
+        s += q5 - p2 - q4 + q7;
+        px[13] = vec_sel(m16, s >> 4, px[13]);
+        s += q6 - p1 - q5 + q7;
+        px[14] = vec_sel(m16, s >> 4, px[14]);
+    }
+
+    return 1;
+}
+
+/* filter across a row edge: each vector is one row of 8 pixels */
+static av_always_inline void loop_filter_v(uint8_t *dst, ptrdiff_t stride,
+                                           int E, int I, int H, int wd)
+{
+    const int n = wd >= 16 ? 8 : 4;
+    vec_s16 px[16] = { { 0 } };
+    int i;
+
+    for (i = 8 - n; i < 8 + n; i++)
+        px[i] = vec_ld_u8_s16(dst + (i - 8) * stride);
+    if (!loop_filter(px, E, I, H, wd))
+        return;
+    for (i = 9 - n; i < 7 + n; i++)
+        vec_st8_u8(dst + (i - 8) * stride, vec_packus_s16(px[i], px[i]));
+}
+
+/* filter across a column edge: 8x8 transposes turn the rows into lanes */
+static av_always_inline void loop_filter_h(uint8_t *dst, ptrdiff_t stride,
+                                           int E, int I, int H, int wd)
+{
+    vec_s16 px[16] = { { 0 } };
+    int i;
+
+    if (wd >= 16) {
+        for (i = 0; i < 8; i++) {
+            px[i]     = vec_ld_u8_s16(dst - 8 + i * stride);
+            px[8 + i] = vec_ld_u8_s16(dst     + i * stride);
+        }
+        VEC_TRANSPOSE8_S16(px[0], px[1], px[2],  px[3],  px[4],  px[5],  px[6],  px[7]);
+        VEC_TRANSPOSE8_S16(px[8], px[9], px[10], px[11], px[12], px[13], px[14], px[15]);
+    } else {
+        for (i = 0; i < 8; i++)
+            px[4 + i] = vec_ld_u8_s16(dst - 4 + i * stride);
+        VEC_TRANSPOSE8_S16(px[4], px[5], px[6], px[7], px[8], px[9], px[10], px[11]);
+    }
+
+    if (!loop_filter(px, E, I, H, wd))
+        return;
+
+    if (wd >= 16) {
+        VEC_TRANSPOSE8_S16(px[0], px[1], px[2],  px[3],  px[4],  px[5],  px[6],  px[7]);
+        VEC_TRANSPOSE8_S16(px[8], px[9], px[10], px[11], px[12], px[13], px[14], px[15]);
+        for (i = 0; i < 8; i++)
+            vec_st_u8(dst - 8 + i * stride, vec_packus_s16(px[i], px[8 + i]));
+    } else {
+        VEC_TRANSPOSE8_S16(px[4], px[5], px[6], px[7], px[8], px[9], px[10], px[11]);
+        for (i = 0; i < 8; i++)
+            vec_st8_u8(dst - 4 + i * stride, vec_packus_s16(px[4 + i], px[4 + i]));
+    }
+}
+
+#define LF_8(wd)                                                                \
+void ff_vp9_loop_filter_h_ ## wd ## _8_8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 int E, int I, int H)           \
+{                                                                               \
+    loop_filter_h(dst, stride, E, I, H, wd);                                    \
+}                                                                               \
+                                                                                \
+void ff_vp9_loop_filter_v_ ## wd ## _8_8_simd128(uint8_t *dst, ptrdiff_t stride, \
+                                                 int E, int I, int H)           \
+{                                                                               \
+    loop_filter_v(dst, stride, E, I, H, wd);                                    \
+}
+
+LF_8(4)
+LF_8(8)
+LF_8(16)
+
+void ff_vp9_loop_filter_h_16_16_8_simd128(uint8_t *dst, ptrdiff_t stride,
+                                          int E, int I, int H)
+{
+    loop_filter_h(dst,              stride, E, I, H, 16);
+    loop_filter_h(dst + 8 * stride, stride, E, I, H, 16);
+}
+
+void ff_vp9_loop_filter_v_16_16_8_simd128(uint8_t *dst, ptrdiff_t stride,
+                                          int E, int I, int H)
+{
+    loop_filter_v(dst,     stride, E, I, H, 16);
+    loop_filter_v(dst + 8, stride, E, I, H, 16);
+}
+
+#define LF_MIX(wd1, wd2)                                                        \
+void ff_vp9_loop_filter_h_ ## wd1 ## wd2 ## _16_8_simd128(uint8_t *dst,         \
+                                                          ptrdiff_t stride,     \
+                                                          int E, int I, int H)  \
+{                                                                               \
+    loop_filter_h(dst, stride, E & 0xff, I & 0xff, H & 0xff, wd1);              \
+    loop_filter_h(dst + 8 * stride, stride, E >> 8, I >> 8, H >> 8, wd2);       \
+}                                                                               \
+                                                                                \
+void ff_vp9_loop_filter_v_ ## wd1 ## wd2 ## _16_8_simd128(uint8_t *dst,         \
+                                                          ptrdiff_t stride,     \
+                                                          int E, int I, int H)  \
+{                                                                               \
+    loop_filter_v(dst, stride, E & 0xff, I & 0xff, H & 0xff, wd1);              \
+    loop_filter_v(dst + 8, stride, E >> 8, I >> 8, H >> 8, wd2);                \
+}
+
+LF_MIX(4, 4)
+LF_MIX(4, 8)
+LF_MIX(8, 4)
+LF_MIX(8, 8)
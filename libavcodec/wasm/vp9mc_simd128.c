@@ -0,0 +1,205 @@
+/*
+ * VP9 motion compensation, 128-bit portable SIMD
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "libavcodec/vp9dsp.h"
+#include "vp9dsp_wasm.h"
+
+/*
+ * Every tap of a filter family has a fixed sign, so the positive and the
+ * negative taps can be summed separately on unsigned 16-bit lanes without
+ * overflow (at most 182 * 255 for the sharp filter). The saturating
+ * difference is then exact wherever the result is not clipped to 0.
+ */
+static const int8_t tap_sign[3][8] = {
+    [FILTER_8TAP_SMOOTH]  = { -1, -1,  1,  1,  1,  1, -1, -1 },
+    [FILTER_8TAP_REGULAR] = { -1,  1, -1,  1,  1, -1,  1, -1 },
+    [FILTER_8TAP_SHARP]   = { -1,  1, -1,  1,  1, -1,  1, -1 },
+};
+
+static av_always_inline void load_taps(vec_u16 *c, const int16_t *filter)
+{
+    int k;
+
+    for (k = 0; k < 8; k++)
+        c[k] = (vec_u16)vec_splat_s16(FFABS(filter[k]));
+}
+
+static av_always_inline vec_u16 ld_px(const uint8_t *p, int w)
+{
+    return (vec_u16)(w >= 8 ? vec_ld_u8_s16(p) : vec_ld4_u8_s16(p));
+}
+
+static av_always_inline vec_u8 filter8(const uint8_t *src, ptrdiff_t step,
+                                       const vec_u16 *c, int type, int w)
+{
+    const vec_u16 zero = { 0 };
+    vec_u16 pos = zero, neg = zero;
+    int k;
+
+    for (k = 0; k < 8; k++) {
+        vec_u16 s = ld_px(src + (k - 3) * step, w);
+
+        if (tap_sign[type][k] > 0)
+            pos += c[k] * s;
+        else
+            neg += c[k] * s;
+    }
+    pos = (((pos - neg) & (vec_u16)(pos > neg)) + 64) >> 7;
+    return vec_packus_s16((vec_s16)pos, (vec_s16)pos);
+}
+
+static av_always_inline vec_u8 ld4_u8(const uint8_t *p)
+{
+    vec_u8 v = { 0 };
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static av_always_inline void store(uint8_t *dst, vec_u8 v, int w, int avg)
+{
+    if (avg)
+        v = vec_avg_u8(v, w >= 8 ? vec_ld8_u8(dst) : ld4_u8(dst));
+    if (w >= 8)
+        vec_st8_u8(dst, v);
+    else
+        vec_st4_u8(dst, v);
+}
+
+static av_always_inline void filter_1d(uint8_t *dst, ptrdiff_t dst_stride,
+                                       const uint8_t *src, ptrdiff_t src_stride,
+                                       int w, int h, ptrdiff_t step,
+                                       const int16_t *filter, int type, int avg)
+{
+    vec_u16 c[8];
+    int x;
+
+    load_taps(c, filter);
+    do {
+        for (x = 0; x < w; x += 8)
+            store(dst + x, filter8(src + x, step, c, type, w), w, avg);
+        dst += dst_stride;
+        src += src_stride;
+    } while (--h);
+}
+
+static av_always_inline void filter_2d(uint8_t *dst, ptrdiff_t dst_stride,
+                                       const uint8_t *src, ptrdiff_t src_stride,
+                                       int w, int h, const int16_t *filterx,
+                                       const int16_t *filtery, int type, int avg)
+{
+    LOCAL_ALIGNED_16(uint8_t, tmp, [64 * 71]);
+    vec_u16 c[8];
+    int x, y;
+
+    load_taps(c, filterx);
+    src -= 3 * src_stride;
+    for (y = 0; y < h + 7; y++) {
+        for (x = 0; x < w; x += 8) {
+            vec_u8 v = filter8(src + x, 1, c, type, w);
+            if (w >= 8)
+                vec_st8_u8(tmp + y * 64 + x, v);
+            else
+                vec_st4_u8(tmp + y * 64 + x, v);
+        }
+        src += src_stride;
+    }
+
+    filter_1d(dst, dst_stride, tmp + 3 * 64, 64, w, h, 64, filtery, type, avg);
+}
+
+#define FILTER_FNS(type, type_idx, sz, op, avg)                                 \
+void ff_vp9_ ## op ## _8tap_ ## type ## _ ## sz ## h_8_simd128(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                              const uint8_t *src, ptrdiff_t src_stride, \
+                                                              int h, int mx, int my) \
+{                                                                               \
+    filter_1d(dst, dst_stride, src, src_stride, sz, h, 1,                       \
+              ff_vp9_subpel_filters[type_idx][mx], type_idx, avg);              \
+}                                                                               \
+                                                                                \
+void ff_vp9_ ## op ## _8tap_ ## type ## _ ## sz ## v_8_simd128(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                              const uint8_t *src, ptrdiff_t src_stride, \
+                                                              int h, int mx, int my) \
+{                                                                               \
+    filter_1d(dst, dst_stride, src, src_stride, sz, h, src_stride,              \
+              ff_vp9_subpel_filters[type_idx][my], type_idx, avg);              \
+}                                                                               \
+                                                                                \
+void ff_vp9_ ## op ## _8tap_ ## type ## _ ## sz ## hv_8_simd128(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                               const uint8_t *src, ptrdiff_t src_stride, \
+                                                               int h, int mx, int my) \
+{                                                                               \
+    filter_2d(dst, dst_stride, src, src_stride, sz, h,                          \
+              ff_vp9_subpel_filters[type_idx][mx],                              \
+              ff_vp9_subpel_filters[type_idx][my], type_idx, avg);              \
+}
+
+#define FILTER_SIZES(type, type_idx, op, avg) \
+FILTER_FNS(type, type_idx, 64, op, avg)       \
+FILTER_FNS(type, type_idx, 32, op, avg)       \
+FILTER_FNS(type, type_idx, 16, op, avg)       \
+FILTER_FNS(type, type_idx,  8, op, avg)       \
+FILTER_FNS(type, type_idx,  4, op, avg)
+
+#define FILTER_OPS(type, type_idx)            \
+FILTER_SIZES(type, type_idx, put, 0)          \
+FILTER_SIZES(type, type_idx, avg, 1)
+
+FILTER_OPS(smooth,  FILTER_8TAP_SMOOTH)
+FILTER_OPS(regular, FILTER_8TAP_REGULAR)
+FILTER_OPS(sharp,   FILTER_8TAP_SHARP)
+
+static av_always_inline void avg_fpel(uint8_t *dst, ptrdiff_t dst_stride,
+                                      const uint8_t *src, ptrdiff_t src_stride,
+                                      int w, int h)
+{
+    int x;
+
+    do {
+        if (w >= 16) {
+            for (x = 0; x < w; x += 16)
+                vec_st_u8(dst + x, vec_avg_u8(vec_ld_u8(dst + x), vec_ld_u8(src + x)));
+        } else if (w == 8) {
+            vec_st8_u8(dst, vec_avg_u8(vec_ld8_u8(dst), vec_ld8_u8(src)));
+        } else {
+            vec_st4_u8(dst, vec_avg_u8(ld4_u8(dst), ld4_u8(src)));
+        }
+        dst += dst_stride;
+        src += src_stride;
+    } while (--h);
+}
+
+#define AVG_FPEL(sz)                                                            \
+void ff_vp9_avg ## sz ## _8_simd128(uint8_t *dst, ptrdiff_t dst_stride,         \
+                                    const uint8_t *src, ptrdiff_t src_stride,   \
+                                    int h, int mx, int my)                      \
+{                                                                               \
+    avg_fpel(dst, dst_stride, src, src_stride, sz, h);                          \
+}
+
+AVG_FPEL(64)
+AVG_FPEL(32)
+AVG_FPEL(16)
+AVG_FPEL(8)
+AVG_FPEL(4)
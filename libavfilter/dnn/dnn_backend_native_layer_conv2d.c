@@ -19,7 +19,11 @@
  */
 
 #include "libavutil/avassert.h"
+#include "../internal.h"
 #include "dnn_backend_native_layer_conv2d.h"
+#if HAVE_SIMD128
+#include "libavutil/wasm/util_simd128.h"
+#endif
 
 #define CLAMP_TO_EDGE(x, w) ((x) < 0 ? 0 : ((x) >= (w) ? (w - 1) : (x)))
 
@@ -88,23 +92,215 @@ int dnn_load_layer_conv2d(Layer *layer, AVIOContext *model_file_context, int fil
     return dnn_size;
 }
 
+/*
+ * The convolution is computed as a matrix product: the taps of a run of
+ * output pixels are unrolled into the rows of a buffer (im2col), in the
+ * kernel_size * kernel_size * input_num order of the kernel rows, which is
+ * then multiplied by the transposed kernel.
+ */
+
+/* output pixels and output channels computed by one call of gemm_block() */
+#define PX_BLOCK 4
+#define OC_BLOCK 8
+/* output pixels unrolled into the im2col buffer at once */
+#define COL_PIXELS 64
+/* taps multiplied at once, so that the rows being used stay in cache */
+#define TAPS_BLOCK 256
+
+typedef struct ThreadData {
+    const ConvolutionalParams *params;
+    const float *input;
+    float *output;
+    const float *kernel;    ///< kernel reordered by pack_kernel()
+    const float *biases;    ///< biases padded to a multiple of OC_BLOCK
+    float *scratch;         ///< im2col and result buffers of each job
+    int scratch_size;
+    int taps, oc_padded;
+    int height, width;
+    int out_height, out_width;
+    int pad_size;
+} ThreadData;
+
+/*
+ * Interleave the taps of OC_BLOCK consecutive output channels, so that
+ * gemm_block() reads the kernel sequentially, and pad the last block of
+ * output channels with zeros.
+ */
+static void pack_kernel(float *kernel, float *biases, const ConvolutionalParams *conv_params,
+                        int taps, int oc_padded)
+{
+    for (int oc0 = 0; oc0 < oc_padded; oc0 += OC_BLOCK) {
+        for (int k = 0; k < taps; k++) {
+            for (int i = 0; i < OC_BLOCK; i++) {
+                int oc = oc0 + i;
+                *kernel++ = oc < conv_params->output_num ? conv_params->kernel[oc * taps + k] : 0.f;
+            }
+        }
+    }
+    for (int oc = 0; oc < oc_padded; oc++)
+        biases[oc] = conv_params->has_bias && oc < conv_params->output_num ? conv_params->biases[oc] : 0.f;
+}
+
+/* unroll the taps of the n output pixels starting at (x0, y) into rows of col */
+static void im2col(const ThreadData *td, float *col, int x0, int y, int n)
+{
+    const ConvolutionalParams *conv_params = td->params;
+    const int channels = conv_params->input_num;
+    const int radius = conv_params->kernel_size >> 1;
+    const int cy = y + td->pad_size;
+
+    for (int i = 0; i < n; i++) {
+        const int cx = x0 + i + td->pad_size;
+
+        for (int kernel_y = 0; kernel_y < conv_params->kernel_size; ++kernel_y) {
+            int y_pos = cy + (kernel_y - radius) * conv_params->dilation;
+
+            if (conv_params->padding_method == SAME_CLAMP_TO_EDGE)
+                y_pos = CLAMP_TO_EDGE(y_pos, td->height);
+
+            for (int kernel_x = 0; kernel_x < conv_params->kernel_size; ++kernel_x) {
+                int x_pos = cx + (kernel_x - radius) * conv_params->dilation;
+
+                if (conv_params->padding_method == SAME_CLAMP_TO_EDGE) {
+                    x_pos = CLAMP_TO_EDGE(x_pos, td->width);
+                } else if (x_pos < 0 || x_pos >= td->width || y_pos < 0 || y_pos >= td->height) {
+                    memset(col, 0, channels * sizeof(*col));
+                    col += channels;
+                    continue;
+                }
+                memcpy(col, td->input + (y_pos * td->width + x_pos) * channels,
+                       channels * sizeof(*col));
+                col += channels;
+            }
+        }
+    }
+    memset(col, 0, (FFALIGN(n, PX_BLOCK) - n) * td->taps * sizeof(*col));
+}
+
+/*
+ * Multiply PX_BLOCK rows of the im2col buffer by nb_taps taps of an
+ * OC_BLOCK wide block of the packed kernel, accumulating into dst.
+ */
+#if HAVE_SIMD128
+static void gemm_block(float *dst, int dst_stride, const float *col, int col_stride,
+                       const float *kernel, int nb_taps, int nb_oc)
+{
+    vec_f32 acc[PX_BLOCK][2];
+
+    for (int i = 0; i < PX_BLOCK; i++) {
+        acc[i][0] = vec_ld_f32(dst + i * dst_stride);
+        acc[i][1] = vec_ld_f32(dst + i * dst_stride + 4);
+    }
+    for (int k = 0; k < nb_taps; k++, kernel += OC_BLOCK) {
+        const vec_f32 w0 = vec_ld_f32(kernel), w1 = vec_ld_f32(kernel + 4);
+
+        for (int i = 0; i < PX_BLOCK; i++) {
+            const vec_f32 a = vec_splat_f32(col[i * col_stride + k]);
+            acc[i][0] += a * w0;
+            acc[i][1] += a * w1;
+        }
+    }
+    for (int i = 0; i < PX_BLOCK; i++) {
+        vec_st_f32(dst + i * dst_stride,     acc[i][0]);
+        vec_st_f32(dst + i * dst_stride + 4, acc[i][1]);
+    }
+}
+#else
+/*
+ * without vectors, work on 2x4 sub-blocks whose accumulators fit in registers,
+ * skipping those made only of padding output channels
+ */
+static void gemm_block(float *dst, int dst_stride, const float *col, int col_stride,
+                       const float *kernel, int nb_taps, int nb_oc)
+{
+    for (int i = 0; i < PX_BLOCK; i += 2) {
+        for (int j = 0; j < nb_oc; j += 4) {
+            const float *a0 = col + i * col_stride, *a1 = a0 + col_stride;
+            const float *w = kernel + j;
+            float *d0 = dst + i * dst_stride + j, *d1 = d0 + dst_stride;
+            float s00 = d0[0], s01 = d0[1], s02 = d0[2], s03 = d0[3];
+            float s10 = d1[0], s11 = d1[1], s12 = d1[2], s13 = d1[3];
+
+            for (int k = 0; k < nb_taps; k++, w += OC_BLOCK) {
+                s00 += a0[k] * w[0]; s01 += a0[k] * w[1]; s02 += a0[k] * w[2]; s03 += a0[k] * w[3];
+                s10 += a1[k] * w[0]; s11 += a1[k] * w[1]; s12 += a1[k] * w[2]; s13 += a1[k] * w[3];
+            }
+            d0[0] = s00; d0[1] = s01; d0[2] = s02; d0[3] = s03;
+            d1[0] = s10; d1[1] = s11; d1[2] = s12; d1[3] = s13;
+        }
+    }
+}
+#endif
+
+static float activate(float value, DNNActivationFunc activation)
+{
+    switch (activation) {
+    case RELU:
+        return FFMAX(value, 0.0);
+    case TANH:
+        return 2.0f  / (1.0f + exp(-2.0f * value)) - 1.0f;
+    case SIGMOID:
+        return 1.0f / (1.0f + exp(-value));
+    case LEAKY_RELU:
+        return FFMAX(value, 0.0) + 0.2 * FFMIN(value, 0.0);
+    }
+    return value;
+}
+
+static int conv2d_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const ThreadData *td = arg;
+    const ConvolutionalParams *conv_params = td->params;
+    const int taps = td->taps, oc_padded = td->oc_padded;
+    const int slice_start = (td->out_height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->out_height * (jobnr + 1)) / nb_jobs;
+    float *col = td->scratch + jobnr * td->scratch_size;
+    float *res = col + COL_PIXELS * taps;
+
+    for (int y = slice_start; y < slice_end; y++) {
+        for (int x0 = 0; x0 < td->out_width; x0 += COL_PIXELS) {
+            const int n = FFMIN(COL_PIXELS, td->out_width - x0);
+            float *output = td->output + ((size_t)y * td->out_width + x0) * conv_params->output_num;
+
+            im2col(td, col, x0, y, n);
+            for (int i = 0; i < n; i += PX_BLOCK)
+                for (int j = 0; j < PX_BLOCK; j++)
+                    memcpy(res + (i + j) * oc_padded, td->biases, oc_padded * sizeof(*res));
+
+            for (int k0 = 0; k0 < taps; k0 += TAPS_BLOCK) {
+                const int nb_taps = FFMIN(TAPS_BLOCK, taps - k0);
+                for (int oc0 = 0; oc0 < oc_padded; oc0 += OC_BLOCK) {
+                    const float *kernel = td->kernel + (oc0 * taps + k0 * OC_BLOCK);
+                    for (int i = 0; i < n; i += PX_BLOCK)
+                        gemm_block(res + i * oc_padded + oc0, oc_padded,
+                                   col + i * taps + k0, taps, kernel, nb_taps,
+                                   FFMIN(OC_BLOCK, conv_params->output_num - oc0));
+                }
+            }
+
+            for (int i = 0; i < n; i++)
+                for (int oc = 0; oc < conv_params->output_num; oc++)
+                    output[i * conv_params->output_num + oc] =
+                        activate(res[i * oc_padded + oc], conv_params->activation);
+        }
+    }
+    return 0;
+}
+
 int dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_operand_indexes,
-                             int32_t output_operand_index, const void *parameters)
+                             int32_t output_operand_index, const void *parameters,
+                             AVFilterContext *filter_ctx)
 {
-    float *output;
     int32_t input_operand_index = input_operand_indexes[0];
     int number = operands[input_operand_index].dims[0];
     int height = operands[input_operand_index].dims[1];
     int width = operands[input_operand_index].dims[2];
     int channel = operands[input_operand_index].dims[3];
-    const float *input = operands[input_operand_index].data;
     const ConvolutionalParams *conv_params = (const ConvolutionalParams *)parameters;
-
-    int radius = conv_params->kernel_size >> 1;
-    int src_linesize = width * conv_params->input_num;
-    int filter_linesize = conv_params->kernel_size * conv_params->input_num;
-    int filter_size = conv_params->kernel_size * filter_linesize;
     int pad_size = (conv_params->padding_method == VALID) ? (conv_params->kernel_size - 1) / 2 * conv_params->dilation : 0;
+    int nb_jobs = 1;
+    float *packed;
+    ThreadData td;
 
     DnnOperand *output_operand = &operands[output_operand_index];
     output_operand->dims[0] = number;
@@ -118,57 +314,41 @@ int dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_operand_
     output_operand->data = av_realloc(output_operand->data, output_operand->length);
     if (!output_operand->data)
         return -1;
-    output = output_operand->data;
 
     av_assert0(channel == conv_params->input_num);
 
-    for (int y = pad_size; y < height - pad_size; ++y) {
-        for (int x = pad_size; x < width - pad_size; ++x) {
-            for (int n_filter = 0; n_filter < conv_params->output_num; ++n_filter) {
-                if (conv_params->has_bias)
-                    output[n_filter] = conv_params->biases[n_filter];
-                else
-                    output[n_filter] = 0.f;
-
-                for (int ch = 0; ch < conv_params->input_num; ++ch) {
-                    for (int kernel_y = 0; kernel_y < conv_params->kernel_size; ++kernel_y) {
-                        for (int kernel_x = 0; kernel_x < conv_params->kernel_size; ++kernel_x) {
-                            float input_pel;
-                            if (conv_params->padding_method == SAME_CLAMP_TO_EDGE) {
-                                int y_pos = CLAMP_TO_EDGE(y + (kernel_y - radius) * conv_params->dilation, height);
-                                int x_pos = CLAMP_TO_EDGE(x + (kernel_x - radius) * conv_params->dilation, width);
-                                input_pel = input[y_pos * src_linesize + x_pos * conv_params->input_num + ch];
-                            } else {
-                                int y_pos = y + (kernel_y - radius) * conv_params->dilation;
-                                int x_pos = x + (kernel_x - radius) * conv_params->dilation;
-                                input_pel = (x_pos < 0 || x_pos >= width || y_pos < 0 || y_pos >= height) ? 0.0 :
-                                                   input[y_pos * src_linesize + x_pos * conv_params->input_num + ch];
-                            }
-
-
-                            output[n_filter] += input_pel * conv_params->kernel[n_filter * filter_size + kernel_y * filter_linesize +
-                                                                                kernel_x * conv_params->input_num + ch];
-                        }
-                    }
-                }
-                switch (conv_params->activation){
-                case RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0);
-                    break;
-                case TANH:
-                    output[n_filter] = 2.0f  / (1.0f + exp(-2.0f * output[n_filter])) - 1.0f;
-                    break;
-                case SIGMOID:
-                    output[n_filter] = 1.0f / (1.0f + exp(-output[n_filter]));
-                    break;
-                case NONE:
-                    break;
-                case LEAKY_RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0) + 0.2 * FFMIN(output[n_filter], 0.0);
-                }
-            }
-            output += conv_params->output_num;
-        }
+    td.params       = conv_params;
+    td.input        = operands[input_operand_index].data;
+    td.output       = output_operand->data;
+    td.taps         = conv_params->kernel_size * conv_params->kernel_size * conv_params->input_num;
+    td.oc_padded    = FFALIGN(conv_params->output_num, OC_BLOCK);
+    td.scratch_size = COL_PIXELS * (td.taps + td.oc_padded);
+    td.height       = height;
+    td.width        = width;
+    td.out_height   = output_operand->dims[1];
+    td.out_width    = output_operand->dims[2];
+    td.pad_size     = pad_size;
+
+    if (filter_ctx)
+        nb_jobs = FFMIN(td.out_height, ff_filter_get_nb_threads(filter_ctx));
+
+    packed = av_malloc_array(td.taps + 1, td.oc_padded * sizeof(*packed));
+    td.scratch = av_malloc_array(nb_jobs, td.scratch_size * sizeof(*td.scratch));
+    if (!packed || !td.scratch) {
+        av_free(packed);
+        av_free(td.scratch);
+        return -1;
     }
+    pack_kernel(packed, packed + td.taps * td.oc_padded, conv_params, td.taps, td.oc_padded);
+    td.kernel = packed;
+    td.biases = packed + td.taps * td.oc_padded;
+
+    if (filter_ctx)
+        filter_ctx->internal->execute(filter_ctx, conv2d_slice, &td, NULL, nb_jobs);
+    else
+        conv2d_slice(NULL, &td, 0, 1);
+
+    av_free(packed);
+    av_free(td.scratch);
     return 0;
 }
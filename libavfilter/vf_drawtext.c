@@ -140,6 +140,28 @@ enum expansion_mode {
     EXP_STRFTIME,
 };
 
+#define TILE_W 32
+
+typedef struct TextMask {
+    uint8_t *data;                  ///< 8-bit coverage, w bytes per line
+    uint8_t *tiles;                 ///< for each line, 1 per TILE_W columns holding some coverage
+    int x, y, w, h;                 ///< position relative to the text box
+} TextMask;
+
+/**
+ * A rasterised text run: the layout and the coverage of the last expanded
+ * text, reused as long as the text and the font size do not change.
+ */
+typedef struct TextRun {
+    char *text;                     ///< expanded text of the run, NULL if none
+    unsigned int fontsize;          ///< font size the run was rendered with
+    int text_w, text_h;             ///< size of the text box
+    int max_glyph_w, max_glyph_h;
+    int ascent, descent;
+    TextMask fill;                  ///< glyph coverage, also used for the shadow
+    TextMask border;                ///< border coverage
+} TextRun;
+
 typedef struct DrawTextContext {
     const AVClass *class;
     int exp_mode;                   ///< expansion mode to use for the text
@@ -184,6 +206,10 @@ typedef struct DrawTextContext {
     FT_Face face;                   ///< freetype font face handle
     FT_Stroker stroker;             ///< freetype stroker handle
     struct AVTreeNode *glyphs;      ///< rendered glyphs, stored using the UTF-32 char code
+    uint8_t *atlas;                 ///< 8-bit coverage of all the rendered glyphs
+    unsigned int atlas_size;        ///< allocated size of atlas
+    size_t atlas_used;              ///< bytes of atlas in use
+    TextRun run;                    ///< last rendered text run
     char *x_expr;                   ///< expression for x position
     char *y_expr;                   ///< expression for y position
     AVExpr *x_pexpr, *y_pexpr;      ///< parsed expressions for x and y
@@ -287,16 +313,16 @@ static const struct ft_error {
 #define FT_ERRMSG(e) ft_errors[e].err_msg
 
 typedef struct Glyph {
-    FT_Glyph glyph;
-    FT_Glyph border_glyph;
     uint32_t code;
     unsigned int fontsize;
-    FT_Bitmap bitmap; ///< array holding bitmaps of font
-    FT_Bitmap border_bitmap; ///< array holding bitmaps of font border
     FT_BBox bbox;
     int advance;
     int bitmap_left;
     int bitmap_top;
+    size_t bitmap_offset;           ///< offset of the glyph coverage in the atlas
+    int bitmap_w, bitmap_h;
+    size_t border_offset;           ///< offset of the border coverage in the atlas
+    int border_w, border_h;
 } Glyph;
 
 static int glyph_cmp(const void *key, const void *b)
@@ -310,6 +336,50 @@ static int glyph_cmp(const void *key, const void *b)
          return FFDIFFSIGN((int64_t)a->fontsize, (int64_t)bb->fontsize);
 }
 
+/**
+ * Append a rendered bitmap to the glyph atlas as 8-bit coverage.
+ */
+static int atlas_add(DrawTextContext *s, const FT_Bitmap *bitmap,
+                     size_t *offset, int *w, int *h)
+{
+    size_t size = (size_t)bitmap->width * bitmap->rows;
+    uint8_t *dst;
+    int x, y;
+
+    if (bitmap->pixel_mode != FT_PIXEL_MODE_MONO &&
+        bitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+        return AVERROR(EINVAL);
+    if (size > UINT_MAX - s->atlas_used)
+        return AVERROR(ENOMEM);
+
+    *offset = s->atlas_used;
+    *w = bitmap->width;
+    *h = bitmap->rows;
+    if (!size)
+        return 0;
+
+    dst = av_fast_realloc(s->atlas, &s->atlas_size, s->atlas_used + size);
+    if (!dst)
+        return AVERROR(ENOMEM);
+    s->atlas = dst;
+    dst += s->atlas_used;
+
+    for (y = 0; y < bitmap->rows; y++) {
+        const uint8_t *src = bitmap->buffer + y * bitmap->pitch;
+
+        if (bitmap->pixel_mode == FT_PIXEL_MODE_MONO) {
+            for (x = 0; x < bitmap->width; x++)
+                dst[x] = (src[x >> 3] >> (~x & 7) & 1) * 255;
+        } else {
+            memcpy(dst, src, bitmap->width);
+        }
+        dst += bitmap->width;
+    }
+
+    s->atlas_used += size;
+    return 0;
+}
+
 /**
  * Load glyphs corresponding to the UTF-32 codepoint code.
  */
@@ -317,6 +387,7 @@ static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
 {
     DrawTextContext *s = ctx->priv;
     FT_BitmapGlyph bitmapglyph;
+    FT_Glyph ft_glyph = NULL, ft_border = NULL;
     Glyph *glyph;
     struct AVTreeNode *node = NULL;
     int ret;
@@ -333,33 +404,37 @@ static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
     glyph->code  = code;
     glyph->fontsize = s->fontsize;
 
-    if (FT_Get_Glyph(s->face->glyph, &glyph->glyph)) {
+    if (FT_Get_Glyph(s->face->glyph, &ft_glyph)) {
         ret = AVERROR(EINVAL);
         goto error;
     }
     if (s->borderw) {
-        glyph->border_glyph = glyph->glyph;
-        if (FT_Glyph_StrokeBorder(&glyph->border_glyph, s->stroker, 0, 0) ||
-            FT_Glyph_To_Bitmap(&glyph->border_glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
+        ft_border = ft_glyph;
+        if (FT_Glyph_StrokeBorder(&ft_border, s->stroker, 0, 0) ||
+            FT_Glyph_To_Bitmap(&ft_border, FT_RENDER_MODE_NORMAL, 0, 1)) {
             ret = AVERROR_EXTERNAL;
             goto error;
         }
-        bitmapglyph = (FT_BitmapGlyph) glyph->border_glyph;
-        glyph->border_bitmap = bitmapglyph->bitmap;
+        bitmapglyph = (FT_BitmapGlyph) ft_border;
+        if ((ret = atlas_add(s, &bitmapglyph->bitmap, &glyph->border_offset,
+                             &glyph->border_w, &glyph->border_h)) < 0)
+            goto error;
     }
-    if (FT_Glyph_To_Bitmap(&glyph->glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
+    if (FT_Glyph_To_Bitmap(&ft_glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
         ret = AVERROR_EXTERNAL;
         goto error;
     }
-    bitmapglyph = (FT_BitmapGlyph) glyph->glyph;
+    bitmapglyph = (FT_BitmapGlyph) ft_glyph;
+    if ((ret = atlas_add(s, &bitmapglyph->bitmap, &glyph->bitmap_offset,
+                         &glyph->bitmap_w, &glyph->bitmap_h)) < 0)
+        goto error;
 
-    glyph->bitmap      = bitmapglyph->bitmap;
     glyph->bitmap_left = bitmapglyph->left;
     glyph->bitmap_top  = bitmapglyph->top;
     glyph->advance     = s->face->glyph->advance.x >> 6;
 
     /* measure text height to calculate text_height (or the maximum text height) */
-    FT_Glyph_Get_CBox(glyph->glyph, ft_glyph_bbox_pixels, &glyph->bbox);
+    FT_Glyph_Get_CBox(ft_glyph, ft_glyph_bbox_pixels, &glyph->bbox);
 
     /* cache the newly created glyph */
     if (!(node = av_tree_node_alloc())) {
@@ -368,14 +443,17 @@ static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
     }
     av_tree_insert(&s->glyphs, glyph, glyph_cmp, &node);
 
+    FT_Done_Glyph(ft_glyph);
+    FT_Done_Glyph(ft_border);
+
     if (glyph_ptr)
         *glyph_ptr = glyph;
     return 0;
 
 error:
-    if (glyph)
-        av_freep(&glyph->glyph);
-
+    if (ft_border != ft_glyph)
+        FT_Done_Glyph(ft_border);
+    FT_Done_Glyph(ft_glyph);
     av_freep(&glyph);
     av_freep(&node);
     return ret;
@@ -791,14 +869,19 @@ static int query_formats(AVFilterContext *ctx)
 
 static int glyph_enu_free(void *opaque, void *elem)
 {
-    Glyph *glyph = elem;
-
-    FT_Done_Glyph(glyph->glyph);
-    FT_Done_Glyph(glyph->border_glyph);
     av_free(elem);
     return 0;
 }
 
+static void free_run(TextRun *run)
+{
+    av_freep(&run->text);
+    av_freep(&run->fill.data);
+    av_freep(&run->fill.tiles);
+    av_freep(&run->border.data);
+    av_freep(&run->border.tiles);
+}
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
@@ -816,6 +899,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
     s->glyphs = NULL;
+    av_freep(&s->atlas);
+    s->atlas_size = s->atlas_used = 0;
+    free_run(&s->run);
 
     FT_Done_Face(s->face);
     FT_Stroker_Done(s->stroker);
@@ -1213,51 +1299,307 @@ static int expand_text(AVFilterContext *ctx, char *text, AVBPrint *bp)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height,
-                       FFDrawColor *color,
-                       int x, int y, int borderw)
+/**
+ * Composite the coverage of all the glyphs of the expanded text, or of their
+ * borders, into a single mask.
+ */
+static int render_layer(DrawTextContext *s, int border, TextMask *mask)
 {
-    char *text = s->expanded_text.str;
+    const char *text = s->expanded_text.str;
+    int x_min = INT_MAX, y_min = INT_MAX, x_max = INT_MIN, y_max = INT_MIN;
     uint32_t code = 0;
-    int i, x1, y1;
+    int pass, i, x, y, nb_tiles;
+    const uint8_t *p;
+    Glyph dummy = { 0 };
+
+    /* first pass: bounding box of the layer, second pass: compositing */
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0, p = text; *p; i++) {
+            const Glyph *glyph;
+            const uint8_t *src;
+            uint8_t *dst;
+            int x0, y0, w, h;
+
+            GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid;);
+continue_on_invalid:
+
+            /* newlines and tabs only move the pen */
+            if (is_newline(code) || code == '\t')
+                continue;
+
+            dummy.code = code;
+            dummy.fontsize = s->fontsize;
+            glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+
+            x0 = s->positions[i].x - border;
+            y0 = s->positions[i].y - border;
+            w  = border ? glyph->border_w : glyph->bitmap_w;
+            h  = border ? glyph->border_h : glyph->bitmap_h;
+            if (!w || !h)
+                continue;
+
+            if (!pass) {
+                x_min = FFMIN(x_min, x0);
+                y_min = FFMIN(y_min, y0);
+                x_max = FFMAX(x_max, x0 + w);
+                y_max = FFMAX(y_max, y0 + h);
+                continue;
+            }
+
+            src = s->atlas + (border ? glyph->border_offset : glyph->bitmap_offset);
+            dst = mask->data + (y0 - mask->y) * mask->w + x0 - mask->x;
+            for (y = 0; y < h; y++) {
+                /* overlapping glyphs add up as if blended one after the other */
+                for (x = 0; x < w; x++)
+                    dst[x] += ((255 - dst[x]) * src[x] + 127) / 255;
+                src += w;
+                dst += mask->w;
+            }
+        }
+
+        if (!pass) {
+            if (x_min >= x_max)
+                return 0;
+            if ((int64_t)(x_max - x_min) * (y_max - y_min) > INT_MAX)
+                return AVERROR(EINVAL);
+            mask->x = x_min;
+            mask->y = y_min;
+            mask->w = x_max - x_min;
+            mask->h = y_max - y_min;
+            mask->data = av_mallocz(mask->w * mask->h);
+            if (!mask->data)
+                return AVERROR(ENOMEM);
+        }
+    }
+
+    /* note which parts of each line hold coverage, the rest is not blended */
+    nb_tiles = (mask->w + TILE_W - 1) / TILE_W;
+    mask->tiles = av_mallocz_array(mask->h, nb_tiles);
+    if (!mask->tiles)
+        return AVERROR(ENOMEM);
+    for (y = 0; y < mask->h; y++) {
+        const uint8_t *line = mask->data + y * mask->w;
+
+        for (x = 0; x < mask->w; x++)
+            if (line[x])
+                mask->tiles[y * nb_tiles + x / TILE_W] = 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Lay out the expanded text and rasterise it into s->run, unless the run
+ * already holds it.
+ */
+static int update_run(AVFilterContext *ctx)
+{
+    DrawTextContext *s = ctx->priv;
+    TextRun *run = &s->run;
+    char *text = s->expanded_text.str;
+    uint32_t code = 0, prev_code = 0;
+    int x = 0, y = 0, i, ret;
+    int max_text_line_w = 0, len;
     uint8_t *p;
-    Glyph *glyph = NULL;
+    int y_min = 32000, y_max = -32000;
+    int x_min = 32000, x_max = -32000;
+    FT_Vector delta;
+    Glyph *glyph = NULL, *prev_glyph = NULL;
+    Glyph dummy = { 0 };
+
+    if (run->text && run->fontsize == s->fontsize && !strcmp(run->text, text))
+        return 0;
+
+    free_run(run);
 
+    if ((len = s->expanded_text.len) > s->nb_positions) {
+        if (!(s->positions =
+              av_realloc(s->positions, len*sizeof(*s->positions))))
+            return AVERROR(ENOMEM);
+        s->nb_positions = len;
+    }
+
+    /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
         GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid;);
 continue_on_invalid:
 
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
+        /* get glyph */
+        dummy.code = code;
+        dummy.fontsize = s->fontsize;
+        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+        if (!glyph) {
+            ret = load_glyph(ctx, &glyph, code);
+            if (ret < 0)
+                return ret;
+        }
+
+        y_min = FFMIN(glyph->bbox.yMin, y_min);
+        y_max = FFMAX(glyph->bbox.yMax, y_max);
+        x_min = FFMIN(glyph->bbox.xMin, x_min);
+        x_max = FFMAX(glyph->bbox.xMax, x_max);
+    }
+    s->max_glyph_h = y_max - y_min;
+    s->max_glyph_w = x_max - x_min;
+
+    /* compute and save position for each glyph */
+    glyph = NULL;
+    for (i = 0, p = text; *p; i++) {
+        GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid2;);
+continue_on_invalid2:
+
+        /* skip the \n in the sequence \r\n */
+        if (prev_code == '\r' && code == '\n')
+            continue;
+
+        prev_code = code;
+        if (is_newline(code)) {
+
+            max_text_line_w = FFMAX(max_text_line_w, x);
+            y += s->max_glyph_h + s->line_spacing;
+            x = 0;
             continue;
+        }
 
+        /* get glyph */
+        prev_glyph = glyph;
         dummy.code = code;
         dummy.fontsize = s->fontsize;
         glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
 
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
+        /* kerning */
+        if (s->use_kerning && prev_glyph && glyph->code) {
+            FT_Get_Kerning(s->face, prev_glyph->code, glyph->code,
+                           ft_kerning_default, &delta);
+            x += delta.x >> 6;
+        }
+
+        /* save position */
+        s->positions[i].x = x + glyph->bitmap_left;
+        s->positions[i].y = y - glyph->bitmap_top + y_max;
+        if (code == '\t') x  = (x / s->tabsize + 1)*s->tabsize;
+        else              x += glyph->advance;
+    }
 
-        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
-            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
-            return AVERROR(EINVAL);
+    max_text_line_w = FFMAX(x, max_text_line_w);
+
+    run->text_w      = max_text_line_w;
+    run->text_h      = y + s->max_glyph_h;
+    run->max_glyph_w = s->max_glyph_w;
+    run->max_glyph_h = s->max_glyph_h;
+    run->ascent      = y_max;
+    run->descent     = y_min;
+
+    if ((ret = render_layer(s, 0, &run->fill)) < 0)
+        return ret;
+    if (s->borderw && (ret = render_layer(s, s->borderw, &run->border)) < 0)
+        return ret;
 
-        x1 = s->positions[i].x+s->x+x - borderw;
-        y1 = s->positions[i].y+s->y+y - borderw;
+    if (!(run->text = av_strdup(text)))
+        return AVERROR(ENOMEM);
+    run->fontsize = s->fontsize;
 
-        ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+    return 0;
+}
+
+typedef struct TextLayer {
+    FFDrawColor *color;
+    const TextMask *mask;
+    int x, y;                       ///< position of the mask in the frame
+} TextLayer;
+
+typedef struct ThreadData {
+    AVFrame *frame;
+    TextLayer layers[3];
+    int nb_layers;
+    int top, bottom;                ///< rows of the frame covered by the layers
+} ThreadData;
+
+static int slice_start(DrawTextContext *s, const ThreadData *td, int jobnr, int nb_jobs)
+{
+    int y;
+
+    if (!jobnr)
+        return td->top;
+    if (jobnr == nb_jobs)
+        return td->bottom;
+    /* keep the slices on chroma row boundaries so that no two jobs blend
+     * the same subsampled row */
+    y = td->top + (td->bottom - td->top) * jobnr / nb_jobs;
+    return FFMAX(y & ~((1 << s->dc.vsub_max) - 1), td->top);
+}
+
+/**
+ * Blend the lines [y0, y1) of a layer mask, skipping the spans of tiles
+ * without coverage. The lines are taken in groups matching the chroma
+ * subsampling, so the result is the same as blending the whole mask.
+ */
+static void blend_layer(DrawTextContext *s, AVFrame *frame, const TextLayer *l,
+                        int y0, int y1)
+{
+    const TextMask *m = l->mask;
+    const int nb_tiles = (m->w + TILE_W - 1) / TILE_W;
+    const int step = 1 << s->dc.vsub_max;
+    int y, yend, t, t0, i;
+
+    for (y = y0; y < y1; y = yend) {
+        yend = FFMIN(((l->y + y + step) & ~(step - 1)) - l->y, y1);
+        for (t = 0; t < nb_tiles; ) {
+            for (t0 = t; t < nb_tiles; t++) {
+                for (i = y; i < yend && !m->tiles[i * nb_tiles + t]; i++)
+                    ;
+                if (i == yend)
+                    break;
+            }
+            if (t > t0) {
+                int x0 = t0 * TILE_W;
+                int x1 = FFMIN(t * TILE_W, m->w);
+
+                ff_blend_mask(&s->dc, l->color,
+                              frame->data, frame->linesize, frame->width, frame->height,
+                              m->data + y * m->w + x0, m->w, x1 - x0, yend - y,
+                              3, 0, l->x + x0, l->y + y);
+            }
+            t++;
+        }
+    }
+}
+
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int start = slice_start(s, td, jobnr,     nb_jobs);
+    const int end   = slice_start(s, td, jobnr + 1, nb_jobs);
+    int i;
+
+    for (i = 0; i < td->nb_layers; i++) {
+        const TextLayer *l = &td->layers[i];
+        int y0 = FFMAX(start - l->y, 0);
+        int y1 = FFMIN(end   - l->y, l->mask->h);
+
+        if (y0 < y1)
+            blend_layer(s, td->frame, l, y0, y1);
     }
 
     return 0;
 }
 
+static void add_layer(ThreadData *td, FFDrawColor *color, const TextMask *mask,
+                      int x, int y)
+{
+    TextLayer *l = &td->layers[td->nb_layers];
+
+    if (!mask->data)
+        return;
+    l->color = color;
+    l->mask  = mask;
+    l->x = x + mask->x;
+    l->y = y + mask->y;
+    td->top    = FFMIN(td->top,    l->y);
+    td->bottom = FFMAX(td->bottom, l->y + mask->h);
+    td->nb_layers++;
+}
 
 static void update_color_with_alpha(DrawTextContext *s, FFDrawColor *color, const FFDrawColor incolor)
 {
@@ -1286,18 +1628,10 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 {
     DrawTextContext *s = ctx->priv;
     AVFilterLink *inlink = ctx->inputs[0];
-
-    uint32_t code = 0, prev_code = 0;
-    int x = 0, y = 0, i = 0, ret;
-    int max_text_line_w = 0, len;
+    TextRun *run = &s->run;
+    ThreadData td = { 0 };
+    int ret, nb_jobs;
     int box_w, box_h;
-    char *text;
-    uint8_t *p;
-    int y_min = 32000, y_max = -32000;
-    int x_min = 32000, x_max = -32000;
-    FT_Vector delta;
-    Glyph *glyph = NULL, *prev_glyph = NULL;
-    Glyph dummy = { 0 };
 
     time_t now = time(0);
     struct tm ltime;
@@ -1336,13 +1670,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
     if (!av_bprint_is_complete(bp))
         return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
-    if ((len = s->expanded_text.len) > s->nb_positions) {
-        if (!(s->positions =
-              av_realloc(s->positions, len*sizeof(*s->positions))))
-            return AVERROR(ENOMEM);
-        s->nb_positions = len;
-    }
 
     if (s->fontcolor_expr[0]) {
         /* If expression is set, evaluate and replace the static value */
@@ -1358,83 +1685,24 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
     }
 
-    x = 0;
-    y = 0;
-
     if ((ret = update_fontsize(ctx)) < 0)
         return ret;
 
-    /* load and cache glyphs */
-    for (i = 0, p = text; *p; i++) {
-        GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid;);
-continue_on_invalid:
-
-        /* get glyph */
-        dummy.code = code;
-        dummy.fontsize = s->fontsize;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-        if (!glyph) {
-            ret = load_glyph(ctx, &glyph, code);
-            if (ret < 0)
-                return ret;
-        }
-
-        y_min = FFMIN(glyph->bbox.yMin, y_min);
-        y_max = FFMAX(glyph->bbox.yMax, y_max);
-        x_min = FFMIN(glyph->bbox.xMin, x_min);
-        x_max = FFMAX(glyph->bbox.xMax, x_max);
-    }
-    s->max_glyph_h = y_max - y_min;
-    s->max_glyph_w = x_max - x_min;
-
-    /* compute and save position for each glyph */
-    glyph = NULL;
-    for (i = 0, p = text; *p; i++) {
-        GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid2;);
-continue_on_invalid2:
-
-        /* skip the \n in the sequence \r\n */
-        if (prev_code == '\r' && code == '\n')
-            continue;
-
-        prev_code = code;
-        if (is_newline(code)) {
-
-            max_text_line_w = FFMAX(max_text_line_w, x);
-            y += s->max_glyph_h + s->line_spacing;
-            x = 0;
-            continue;
-        }
-
-        /* get glyph */
-        prev_glyph = glyph;
-        dummy.code = code;
-        dummy.fontsize = s->fontsize;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-
-        /* kerning */
-        if (s->use_kerning && prev_glyph && glyph->code) {
-            FT_Get_Kerning(s->face, prev_glyph->code, glyph->code,
-                           ft_kerning_default, &delta);
-            x += delta.x >> 6;
-        }
-
-        /* save position */
-        s->positions[i].x = x + glyph->bitmap_left;
-        s->positions[i].y = y - glyph->bitmap_top + y_max;
-        if (code == '\t') x  = (x / s->tabsize + 1)*s->tabsize;
-        else              x += glyph->advance;
+    if ((ret = update_run(ctx)) < 0) {
+        free_run(run);
+        return ret;
     }
 
-    max_text_line_w = FFMAX(x, max_text_line_w);
+    s->max_glyph_w = run->max_glyph_w;
+    s->max_glyph_h = run->max_glyph_h;
 
-    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = max_text_line_w;
-    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = y + s->max_glyph_h;
+    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = run->text_w;
+    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = run->text_h;
 
     s->var_values[VAR_MAX_GLYPH_W] = s->max_glyph_w;
     s->var_values[VAR_MAX_GLYPH_H] = s->max_glyph_h;
-    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = y_max;
-    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = y_min;
+    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = run->ascent;
+    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = run->descent;
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
@@ -1449,8 +1717,8 @@ continue_on_invalid2:
     update_color_with_alpha(s, &bordercolor, s->bordercolor);
     update_color_with_alpha(s, &boxcolor   , s->boxcolor   );
 
-    box_w = max_text_line_w;
-    box_h = y + s->max_glyph_h;
+    box_w = run->text_w;
+    box_h = run->text_h;
 
     if (s->fix_bounds) {
 
@@ -1485,20 +1753,25 @@ continue_on_invalid2:
                            s->x - s->boxborderw, s->y - s->boxborderw,
                            box_w + s->boxborderw * 2, box_h + s->boxborderw * 2);
 
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
-    }
+    /* the shadow, the border and the glyphs are each blended as one mask */
+    td.frame  = frame;
+    td.top    = INT_MAX;
+    td.bottom = INT_MIN;
+    if (s->shadowx || s->shadowy)
+        add_layer(&td, &shadowcolor, &run->fill,
+                  s->x + s->shadowx, s->y + s->shadowy);
+    if (s->borderw)
+        add_layer(&td, &bordercolor, &run->border, s->x, s->y);
+    add_layer(&td, &fontcolor, &run->fill, s->x, s->y);
+
+    td.top    = FFMAX(td.top, 0);
+    td.bottom = FFMIN(td.bottom, height);
+    if (td.top >= td.bottom)
+        return 0;
 
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
-    }
-    if ((ret = draw_glyphs(s, frame, width, height,
-                           &fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    nb_jobs = FFMIN(ff_filter_get_nb_threads(ctx),
+                    FFMAX((td.bottom - td.top) >> (5 + s->dc.vsub_max), 1));
+    ctx->internal->execute(ctx, blend_slice, &td, NULL, nb_jobs);
 
     return 0;
 }
@@ -1574,5 +1847,5 @@ AVFilter ff_vf_drawtext = {
     .inputs        = avfilter_vf_drawtext_inputs,
     .outputs       = avfilter_vf_drawtext_outputs,
     .process_command = command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -53,6 +53,9 @@ typedef struct GEQContext {
     uint8_t *dst;               ///< reference pointer to the 8bits output
     uint16_t *dst16;            ///< reference pointer to the 16bits output
     double values[VAR_VARS_NB]; ///< expression values
+    double *xs;                 ///< X of each pixel of a line
+    double *lines;              ///< one line of results for each thread
+    int lines_stride;
     int hsub, vsub;             ///< chroma subsampling
     int planes;                 ///< number of planes
     int interpolation;
@@ -357,6 +360,16 @@ static int geq_config_props(AVFilterLink *inlink)
     geq->vsub = desc->log2_chroma_h;
     geq->bps = desc->comp[0].depth;
     geq->planes = desc->nb_components;
+
+    av_freep(&geq->xs);
+    av_freep(&geq->lines);
+    geq->lines_stride = FFALIGN(inlink->w, 8);
+    geq->xs    = av_malloc_array(inlink->w, sizeof(*geq->xs));
+    geq->lines = av_malloc_array(MAX_NB_THREADS, geq->lines_stride * sizeof(*geq->lines));
+    if (!geq->xs || !geq->lines)
+        return AVERROR(ENOMEM);
+    for (int x = 0; x < inlink->w; x++)
+        geq->xs[x] = x;
     return 0;
 }
 
@@ -377,9 +390,12 @@ static int slice_geq_filter(AVFilterContext *ctx, void *arg, int jobnr, int nb_j
     const int linesize = td->linesize;
     const int slice_start = (height *  jobnr) / nb_jobs;
     const int slice_end = (height * (jobnr+1)) / nb_jobs;
-    int x, y;
+    const double *arrays[VAR_VARS_NB] = { [VAR_X] = geq->xs };
+    double *line = geq->lines + jobnr * geq->lines_stride;
+    int x, y, ret;
 
     double values[VAR_VARS_NB];
+    values[VAR_X] = 0;
     values[VAR_W] = geq->values[VAR_W];
     values[VAR_H] = geq->values[VAR_H];
     values[VAR_N] = geq->values[VAR_N];
@@ -391,21 +407,24 @@ static int slice_geq_filter(AVFilterContext *ctx, void *arg, int jobnr, int nb_j
         uint8_t *ptr = geq->dst + linesize * slice_start;
         for (y = slice_start; y < slice_end; y++) {
             values[VAR_Y] = y;
+            ret = av_expr_eval_batch(geq->e[plane][jobnr], line, width, values, arrays, geq);
+            if (ret < 0)
+                return ret;
 
-            for (x = 0; x < width; x++) {
-                values[VAR_X] = x;
-                ptr[x] = av_expr_eval(geq->e[plane][jobnr], values, geq);
-            }
+            for (x = 0; x < width; x++)
+                ptr[x] = line[x];
             ptr += linesize;
         }
     } else {
         uint16_t *ptr16 = geq->dst16 + (linesize/2) * slice_start;
         for (y = slice_start; y < slice_end; y++) {
             values[VAR_Y] = y;
-            for (x = 0; x < width; x++) {
-                values[VAR_X] = x;
-                ptr16[x] = av_expr_eval(geq->e[plane][jobnr], values, geq);
-            }
+            ret = av_expr_eval_batch(geq->e[plane][jobnr], line, width, values, arrays, geq);
+            if (ret < 0)
+                return ret;
+
+            for (x = 0; x < width; x++)
+                ptr16[x] = line[x];
             ptr16 += linesize/2;
         }
     }
@@ -415,7 +434,7 @@ static int slice_geq_filter(AVFilterContext *ctx, void *arg, int jobnr, int nb_j
 
 static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    int plane;
+    int plane, i, ret[MAX_NB_THREADS];
     AVFilterContext *ctx = inlink->dst;
     const int nb_threads = FFMIN(MAX_NB_THREADS, ff_filter_get_nb_threads(ctx));
     GEQContext *geq = ctx->priv;
@@ -455,7 +474,14 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         if (geq->needs_sum[plane])
             calculate_sums(geq, plane, width, height);
 
-        ctx->internal->execute(ctx, slice_geq_filter, &td, NULL, FFMIN(height, nb_threads));
+        ctx->internal->execute(ctx, slice_geq_filter, &td, ret, FFMIN(height, nb_threads));
+        for (i = 0; i < FFMIN(height, nb_threads); i++) {
+            if (ret[i] < 0) {
+                av_frame_free(&geq->picref);
+                av_frame_free(&out);
+                return ret[i];
+            }
+        }
     }
 
     av_frame_free(&geq->picref);
@@ -471,7 +497,9 @@ static av_cold void geq_uninit(AVFilterContext *ctx)
         for (int j = 0; j < MAX_NB_THREADS; j++)
             av_expr_free(geq->e[i][j]);
     for (i = 0; i < NB_PLANES; i++)
-        av_freep(&geq->pixel_sums);
+        av_freep(&geq->pixel_sums[i]);
+    av_freep(&geq->xs);
+    av_freep(&geq->lines);
 }
 
 static const AVFilterPad geq_inputs[] = {
@@ -35,6 +35,7 @@
 struct color_ref {
     uint32_t color;
     uint64_t count;
+    uint64_t first;     // position of the first occurrence in the stream
 };
 
 /* Store a range of colors */
@@ -69,7 +70,10 @@ typedef struct PaletteGenContext {
     int stats_mode;
 
     AVFrame *prev_frame;                    // previous frame used for the diff stats_mode
-    struct hist_node histogram[HIST_SIZE];  // histogram/hashtable of the colors
+    struct hist_node *histogram;            // histogram/hashtable of the colors, one per slice job
+    int nb_histograms;
+    int *job_ret;
+    uint64_t nb_pixels;                     // number of pixels already accounted for
     struct color_ref **refs;                // references of all the colors used in the stream
     int nb_refs;                            // number of color references (or number of different colors)
     struct range_box boxes[256];            // define the segmentation of the colorspace (the final palette)
@@ -403,9 +407,10 @@ static inline unsigned color_hash(uint32_t color)
 }
 
 /**
- * Locate the color in the hash table and increment its counter.
+ * Locate the color in the hash table and increase its counter.
+ * pos is where the color was seen, used only if it is a new one.
  */
-static int color_inc(struct hist_node *hist, uint32_t color)
+static int color_inc(struct hist_node *hist, uint32_t color, int count, uint64_t pos)
 {
     int i;
     const unsigned hash = color_hash(color);
@@ -415,7 +420,7 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     for (i = 0; i < node->nb_entries; i++) {
         e = &node->entries[i];
         if (e->color == color) {
-            e->count++;
+            e->count += count;
             return 0;
         }
     }
@@ -425,52 +430,141 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     if (!e)
         return AVERROR(ENOMEM);
     e->color = color;
-    e->count = 1;
+    e->count = count;
+    e->first = pos;
     return 1;
 }
 
 /**
  * Update histogram when pixels differ from previous frame.
+ * Runs of the same color are accounted for at once.
  */
 static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+                                 const AVFrame *f1, const AVFrame *f2,
+                                 int slice_start, int slice_end, uint64_t pos)
 {
-    int x, y, ret, nb_diff_colors = 0;
+    int x, y, ret;
 
-    for (y = 0; y < f1->height; y++) {
+    for (y = slice_start; y < slice_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
         const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
 
         for (x = 0; x < f1->width; x++) {
+            int n = 1;
+
             if (p[x] == q[x])
                 continue;
-            ret = color_inc(hist, p[x]);
+            while (x + n < f1->width && p[x + n] == p[x] && q[x + n] != p[x])
+                n++;
+            ret = color_inc(hist, p[x], n, pos + (uint64_t)y*f1->width + x);
             if (ret < 0)
                 return ret;
-            nb_diff_colors += ret;
+            x += n - 1;
         }
     }
-    return nb_diff_colors;
+    return 0;
 }
 
 /**
  * Simple histogram of the frame.
+ * Runs of the same color are accounted for at once.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int update_histogram_frame(struct hist_node *hist, const AVFrame *f,
+                                  int slice_start, int slice_end, uint64_t pos)
 {
-    int x, y, ret, nb_diff_colors = 0;
+    int x, y, ret;
 
-    for (y = 0; y < f->height; y++) {
+    for (y = slice_start; y < slice_end; y++) {
         const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
 
         for (x = 0; x < f->width; x++) {
-            ret = color_inc(hist, p[x]);
+            int n = 1;
+
+            while (x + n < f->width && p[x + n] == p[x])
+                n++;
+            ret = color_inc(hist, p[x], n, pos + (uint64_t)y*f->width + x);
             if (ret < 0)
                 return ret;
-            nb_diff_colors += ret;
+            x += n - 1;
         }
     }
-    return nb_diff_colors;
+    return 0;
+}
+
+typedef struct ThreadData {
+    const AVFrame *in, *prev;
+} ThreadData;
+
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    struct hist_node *hist = s->histogram + jobnr * HIST_SIZE;
+    const int slice_start = (td->in->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->in->height * (jobnr+1)) / nb_jobs;
+
+    return td->prev ? update_histogram_diff(hist, td->prev, td->in, slice_start, slice_end, s->nb_pixels)
+                    : update_histogram_frame(hist, td->in, slice_start, slice_end, s->nb_pixels);
+}
+
+static int cmp_first(const void *a, const void *b)
+{
+    const struct color_ref *ref1 = a;
+    const struct color_ref *ref2 = b;
+    return FFDIFFSIGN(ref1->first, ref2->first);
+}
+
+/**
+ * Merge the histograms of all the slice jobs into the first one, with the
+ * colors of each hash bucket in the order they first appeared, as if a
+ * single job had seen the whole stream. Also count the colors.
+ */
+static int merge_histograms(PaletteGenContext *s)
+{
+    int i, j, k, n;
+
+    s->nb_refs = 0;
+    for (j = 0; j < HIST_SIZE; j++) {
+        struct hist_node *node = &s->histogram[j];
+
+        for (n = 1; n < s->nb_histograms; n++) {
+            struct hist_node *src = &s->histogram[n * HIST_SIZE + j];
+
+            for (i = 0; i < src->nb_entries; i++) {
+                const struct color_ref *ref = &src->entries[i];
+                struct color_ref *e;
+
+                for (k = 0; k < node->nb_entries; k++)
+                    if (node->entries[k].color == ref->color)
+                        break;
+                if (k < node->nb_entries) {
+                    e = &node->entries[k];
+                    e->count += ref->count;
+                    e->first  = FFMIN(e->first, ref->first);
+                } else {
+                    e = av_dynarray2_add((void**)&node->entries, &node->nb_entries,
+                                         sizeof(*node->entries), (const uint8_t *)ref);
+                    if (!e)
+                        return AVERROR(ENOMEM);
+                }
+            }
+            av_freep(&src->entries);
+            src->nb_entries = 0;
+        }
+        if (s->nb_histograms > 1 && node->nb_entries > 1)
+            AV_QSORT(node->entries, node->nb_entries, struct color_ref, cmp_first);
+        s->nb_refs += node->nb_entries;
+    }
+    return 0;
+}
+
+static void reset_histograms(PaletteGenContext *s)
+{
+    int i;
+
+    for (i = 0; i < s->nb_histograms * HIST_SIZE; i++)
+        av_freep(&s->histogram[i].entries);
+    memset(s->histogram, 0, s->nb_histograms * HIST_SIZE * sizeof(*s->histogram));
 }
 
 /**
@@ -480,30 +574,40 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    int ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                            : update_histogram_frame(s->histogram, in);
+    ThreadData td = { .in = in, .prev = s->prev_frame };
+    int ret;
 
-    if (ret > 0)
-        s->nb_refs += ret;
+    ctx->internal->execute(ctx, update_histogram_slice, &td, s->job_ret,
+                           FFMIN(s->nb_histograms, in->height));
+    s->nb_pixels += (uint64_t)in->width * in->height;
+    for (ret = 0; ret < FFMIN(s->nb_histograms, in->height); ret++) {
+        if (s->job_ret[ret] < 0) {
+            ret = s->job_ret[ret];
+            av_frame_free(&in);
+            return ret;
+        }
+    }
+    ret = 0;
 
     if (s->stats_mode == STATS_MODE_DIFF_FRAMES) {
         av_frame_free(&s->prev_frame);
         s->prev_frame = in;
     } else if (s->stats_mode == STATS_MODE_SINGLE_FRAMES) {
         AVFrame *out;
-        int i;
 
+        if ((ret = merge_histograms(s)) < 0) {
+            av_frame_free(&in);
+            return ret;
+        }
         out = get_palette_frame(ctx);
         out->pts = in->pts;
         av_frame_free(&in);
         ret = ff_filter_frame(ctx->outputs[0], out);
-        for (i = 0; i < HIST_SIZE; i++)
-            av_freep(&s->histogram[i].entries);
+        reset_histograms(s);
         av_freep(&s->refs);
         s->nb_refs = 0;
         s->nb_boxes = 0;
         memset(s->boxes, 0, sizeof(s->boxes));
-        memset(s->histogram, 0, sizeof(s->histogram));
     } else {
         av_frame_free(&in);
     }
@@ -522,7 +626,12 @@ static int request_frame(AVFilterLink *outlink)
     int r;
 
     r = ff_request_frame(inlink);
-    if (r == AVERROR_EOF && !s->palette_pushed && s->nb_refs && s->stats_mode != STATS_MODE_SINGLE_FRAMES) {
+    if (r == AVERROR_EOF && !s->palette_pushed && s->stats_mode != STATS_MODE_SINGLE_FRAMES) {
+        int ret = merge_histograms(s);
+        if (ret < 0)
+            return ret;
+        if (!s->nb_refs)
+            return r;
         r = ff_filter_frame(outlink, get_palette_frame(ctx));
         s->palette_pushed = 1;
         return r;
@@ -530,23 +639,46 @@ static int request_frame(AVFilterLink *outlink)
     return r;
 }
 
+static void free_histograms(PaletteGenContext *s)
+{
+    int i;
+
+    if (s->histogram)
+        for (i = 0; i < s->nb_histograms * HIST_SIZE; i++)
+            av_freep(&s->histogram[i].entries);
+    av_freep(&s->histogram);
+    av_freep(&s->job_ret);
+    s->nb_histograms = 0;
+}
+
 /**
  * The output is one simple 16x16 squared-pixels palette.
  */
 static int config_output(AVFilterLink *outlink)
 {
+    AVFilterContext *ctx = outlink->src;
+    PaletteGenContext *s = ctx->priv;
+    int nb_histograms = ff_filter_get_nb_threads(ctx);
+
     outlink->w = outlink->h = 16;
     outlink->sample_aspect_ratio = av_make_q(1, 1);
+
+    free_histograms(s);
+    s->histogram = av_mallocz_array(nb_histograms, HIST_SIZE * sizeof(*s->histogram));
+    s->job_ret   = av_mallocz_array(nb_histograms, sizeof(*s->job_ret));
+    if (!s->histogram || !s->job_ret) {
+        free_histograms(s);
+        return AVERROR(ENOMEM);
+    }
+    s->nb_histograms = nb_histograms;
     return 0;
 }
 
 static av_cold void uninit(AVFilterContext *ctx)
 {
-    int i;
     PaletteGenContext *s = ctx->priv;
 
-    for (i = 0; i < HIST_SIZE; i++)
-        av_freep(&s->histogram[i].entries);
+    free_histograms(s);
     av_freep(&s->refs);
     av_frame_free(&s->prev_frame);
 }
@@ -579,4 +711,5 @@ AVFilter ff_vf_palettegen = {
     .inputs        = palettegen_inputs,
     .outputs       = palettegen_outputs,
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -23,10 +23,13 @@
  * Use a palette to downsample an input video stream.
  */
 
+#include <stdatomic.h>
+
 #include "libavutil/bprint.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "libavutil/qsort.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "filters.h"
 #include "framesync.h"
@@ -75,16 +78,24 @@ struct cache_node {
     int nb_entries;
 };
 
+#define GRID_BITS 5
+#define GRID_SIZE (1<<(3*GRID_BITS))
+
 struct PaletteUseContext;
 
-typedef int (*set_frame_func)(struct PaletteUseContext *s, AVFrame *out, AVFrame *in,
-                              int x_start, int y_start, int width, int height);
+typedef int (*set_frame_func)(struct PaletteUseContext *s, struct cache_node *cache,
+                              AVFrame *out, AVFrame *in,
+                              int x_start, int y_start, int width, int height,
+                              int slice_start, int slice_end);
 
 typedef struct PaletteUseContext {
     const AVClass *class;
     FFFrameSync fs;
-    struct cache_node cache[CACHE_SIZE];    /* lookup cache */
+    struct cache_node *cache;               /* lookup caches, one per slice job */
+    int nb_caches;
     struct color_node map[AVPALETTE_COUNT]; /* 3D-Tree (KD-Tree with K=3) for reverse colormap */
+    int16_t grid[GRID_SIZE];                /* palette entry for each color cell with a single possible nearest color, -1 otherwise */
+    int use_grid;
     uint32_t palette[AVPALETTE_COUNT];
     int transparency_index; /* index in the palette of transparency. -1 if there is no transparency in the palette. */
     int trans_thresh;
@@ -98,6 +109,18 @@ typedef struct PaletteUseContext {
     AVFrame *last_in;
     AVFrame *last_out;
 
+    /* wavefront state for error diffusion across slice jobs */
+    atomic_int *row_progress;   /* pixels of each row with their error fully diffused */
+    atomic_int next_row;
+    atomic_int nb_waiters;
+    int wavefront;
+    int *job_ret;
+#if HAVE_THREADS
+    pthread_mutex_t progress_mutex;
+    pthread_cond_t  progress_cond;
+    int progress_init;
+#endif
+
     /* debug options */
     char *dot_filename;
     int color_search_method;
@@ -338,7 +361,8 @@ end:
  * Note: a, r, g, and b are the components of color, but are passed as well to avoid
  * recomputing them (they are generally computed by the caller for other uses).
  */
-static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
+static av_always_inline int color_get(PaletteUseContext *s, struct cache_node *cache,
+                                      uint32_t color,
                                       uint8_t a, uint8_t r, uint8_t g, uint8_t b,
                                       const enum color_search_method search_method)
 {
@@ -348,7 +372,7 @@ static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
     const uint8_t ghash = g & ((1<<NBITS)-1);
     const uint8_t bhash = b & ((1<<NBITS)-1);
     const unsigned hash = rhash<<(NBITS*2) | ghash<<NBITS | bhash;
-    struct cache_node *node = &s->cache[hash];
+    struct cache_node *node = &cache[hash];
     struct cached_color *e;
 
     // first, check for transparency
@@ -356,6 +380,14 @@ static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
         return s->transparency_index;
     }
 
+    if (s->use_grid && a >= s->trans_thresh) {
+        const int id = s->grid[(r >> (8 - GRID_BITS)) << (2 * GRID_BITS) |
+                               (g >> (8 - GRID_BITS)) <<      GRID_BITS  |
+                               (b >> (8 - GRID_BITS))];
+        if (id >= 0)
+            return id;
+    }
+
     for (i = 0; i < node->nb_entries; i++) {
         e = &node->entries[i];
         if (e->color == color)
@@ -372,7 +404,7 @@ static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
     return e->pal_entry;
 }
 
-static av_always_inline int get_dst_color_err(PaletteUseContext *s,
+static av_always_inline int get_dst_color_err(PaletteUseContext *s, struct cache_node *cache,
                                               uint32_t c, int *er, int *eg, int *eb,
                                               const enum color_search_method search_method)
 {
@@ -381,7 +413,7 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     const uint8_t g = c >>  8 & 0xff;
     const uint8_t b = c       & 0xff;
     uint32_t dstc;
-    const int dstx = color_get(s, c, a, r, g, b, search_method);
+    const int dstx = color_get(s, cache, c, a, r, g, b, search_method);
     if (dstx < 0)
         return dstx;
     dstc = s->palette[dstx];
@@ -391,24 +423,72 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     return dstx;
 }
 
-static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFrame *in,
+/**
+ * Wait until at least min_progress pixels of row y are done and return the
+ * progress seen.
+ */
+static int wait_row(PaletteUseContext *s, int y, int min_progress)
+{
+    int progress = atomic_load(&s->row_progress[y]);
+
+#if HAVE_THREADS
+    if (progress < min_progress) {
+        pthread_mutex_lock(&s->progress_mutex);
+        atomic_fetch_add(&s->nb_waiters, 1);
+        while ((progress = atomic_load(&s->row_progress[y])) < min_progress)
+            pthread_cond_wait(&s->progress_cond, &s->progress_mutex);
+        atomic_fetch_sub(&s->nb_waiters, 1);
+        pthread_mutex_unlock(&s->progress_mutex);
+    }
+#endif
+    return progress;
+}
+
+static void report_row(PaletteUseContext *s, int y, int progress)
+{
+    atomic_store(&s->row_progress[y], progress);
+#if HAVE_THREADS
+    if (atomic_load(&s->nb_waiters)) {
+        pthread_mutex_lock(&s->progress_mutex);
+        pthread_cond_broadcast(&s->progress_cond);
+        pthread_mutex_unlock(&s->progress_mutex);
+    }
+#endif
+}
+
+static av_always_inline int set_frame(PaletteUseContext *s, struct cache_node *cache,
+                                      AVFrame *out, AVFrame *in,
                                       int x_start, int y_start, int w, int h,
+                                      int slice_start, int slice_end,
                                       enum dithering_mode dither,
                                       const enum color_search_method search_method)
 {
     int x, y;
     const int src_linesize = in ->linesize[0] >> 2;
     const int dst_linesize = out->linesize[0];
-    uint32_t *src = ((uint32_t *)in ->data[0]) + y_start*src_linesize;
-    uint8_t  *dst =              out->data[0]  + y_start*dst_linesize;
+    uint32_t *src = ((uint32_t *)in ->data[0]) + slice_start*src_linesize;
+    uint8_t  *dst =              out->data[0]  + slice_start*dst_linesize;
+    /* With the rows spread over several jobs, a pixel is processed once the
+     * row above has diffused all its error into it and into the pixels on
+     * its right that it diffuses into as well. */
+    const int wavefront = s->wavefront && dither >= DITHERING_HECKBERT;
+    const int lag = dither == DITHERING_SIERRA2  ? 5 :
+                    dither == DITHERING_HECKBERT ? 2 : 3;
 
     w += x_start;
     h += y_start;
 
-    for (y = y_start; y < h; y++) {
+    for (y = slice_start; y < slice_end; y++) {
+        int avail = wavefront && y > y_start ? x_start : w;
+
         for (x = x_start; x < w; x++) {
             int er, eg, eb;
 
+            if (x >= avail) {
+                const int p = wait_row(s, y - 1, FFMIN(x - x_start + lag, w - x_start));
+                avail = p == w - x_start ? w : x_start + p - lag + 1;
+            }
+
             if (dither == DITHERING_BAYER) {
                 const int d = s->ordered_dither[(y & 7)<<3 | (x & 7)];
                 const uint8_t a8 = src[x] >> 24 & 0xff;
@@ -418,7 +498,8 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = av_clip_uint8(r8 + d);
                 const uint8_t g = av_clip_uint8(g8 + d);
                 const uint8_t b = av_clip_uint8(b8 + d);
-                const int color = color_get(s, src[x], a8, r, g, b, search_method);
+                const uint32_t color_new = (unsigned)a8 << 24 | r << 16 | g << 8 | b;
+                const int color = color_get(s, cache, color_new, a8, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -426,7 +507,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_HECKBERT) {
                 const int right = x < w - 1, down = y < h - 1;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -438,7 +519,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_FLOYD_STEINBERG) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -452,7 +533,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_SIERRA2) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2,                    left2 = x > x_start + 1;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -471,7 +552,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_SIERRA2_4A) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -486,13 +567,18 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = src[x] >> 16 & 0xff;
                 const uint8_t g = src[x] >>  8 & 0xff;
                 const uint8_t b = src[x]       & 0xff;
-                const int color = color_get(s, src[x], a, r, g, b, search_method);
+                const int color = color_get(s, cache, src[x], a, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
                 dst[x] = color;
             }
+
+            if (wavefront && !((x - x_start + 1) & 31))
+                report_row(s, y, x - x_start + 1);
         }
+        if (wavefront)
+            report_row(s, y, w - x_start);
         src += src_linesize;
         dst += dst_linesize;
     }
@@ -729,6 +815,50 @@ static int cmp_pal_entry(const void *a, const void *b)
     return c1 - c2;
 }
 
+/**
+ * Fill the grid of color cells. A cell gets a palette entry when that entry
+ * is strictly the nearest for every color of the cell, so the lookup gives
+ * the same answer as any exact search of the tree.
+ */
+static void load_grid(PaletteUseContext *s, int nb_nodes)
+{
+    const int cell = 1 << (8 - GRID_BITS);
+    int r, g, b, i;
+
+    for (r = 0; r < 1 << GRID_BITS; r++) {
+        for (g = 0; g < 1 << GRID_BITS; g++) {
+            for (b = 0; b < 1 << GRID_BITS; b++) {
+                const int lo[3] = { r * cell, g * cell, b * cell };
+                int min_dist[AVPALETTE_COUNT];
+                int best_max = INT_MAX, best = -1, nb_candidates = 0;
+
+                for (i = 0; i < nb_nodes; i++) {
+                    const uint8_t *v = s->map[i].val + 1;
+                    int k, dmin = 0, dmax = 0;
+
+                    for (k = 0; k < 3; k++) {
+                        const int d0 = v[k] - lo[k];
+                        const int d1 = v[k] - (lo[k] + cell - 1);
+                        const int far = FFMAX(FFABS(d0), FFABS(d1));
+                        const int near = d0 < 0 ? d0 : d1 > 0 ? d1 : 0;
+                        dmin += near * near;
+                        dmax += far  * far;
+                    }
+                    min_dist[i] = dmin;
+                    best_max = FFMIN(best_max, dmax);
+                }
+                for (i = 0; i < nb_nodes; i++) {
+                    if (min_dist[i] <= best_max) {
+                        best = s->map[i].palette_id;
+                        nb_candidates++;
+                    }
+                }
+                s->grid[r << (2 * GRID_BITS) | g << GRID_BITS | b] = nb_candidates == 1 ? best : -1;
+            }
+        }
+    }
+}
+
 static void load_colormap(PaletteUseContext *s)
 {
     int i, nb_used = 0;
@@ -766,6 +896,9 @@ static void load_colormap(PaletteUseContext *s)
 
     colormap_insert(s->map, color_used, &nb_used, s->palette, s->trans_thresh, &box);
 
+    if (s->use_grid)
+        load_grid(s, nb_used);
+
     if (s->dot_filename)
         disp_tree(s->map, s->dot_filename);
 
@@ -894,6 +1027,67 @@ static void set_processing_window(enum diff_mode diff_mode,
     *hp = height;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int x, y, w, h;
+} ThreadData;
+
+static int set_frame_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteUseContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    struct cache_node *cache = s->cache + jobnr * CACHE_SIZE;
+    int ret;
+
+    if (s->dither == DITHERING_NONE || s->dither == DITHERING_BAYER) {
+        const int slice_start = td->y + (td->h *  jobnr   ) / nb_jobs;
+        const int slice_end   = td->y + (td->h * (jobnr+1)) / nb_jobs;
+
+        return s->set_frame(s, cache, td->out, td->in, td->x, td->y, td->w, td->h,
+                            slice_start, slice_end);
+    }
+
+    /* Error diffusion: the rows are taken in order, each one trailing the one
+     * above. A job only waits for a row already taken by a running job, so
+     * this cannot deadlock whatever the number of jobs running at once. */
+    for (;;) {
+        const int y = atomic_fetch_add(&s->next_row, 1);
+
+        if (y >= td->y + td->h)
+            return 0;
+        ret = s->set_frame(s, cache, td->out, td->in, td->x, td->y, td->w, td->h,
+                           y, y + 1);
+        if (ret < 0) {
+            report_row(s, y, td->w);
+            return ret;
+        }
+    }
+}
+
+static int set_frame_threaded(AVFilterContext *ctx, AVFrame *out, AVFrame *in,
+                              int x, int y, int w, int h)
+{
+    PaletteUseContext *s = ctx->priv;
+    ThreadData td = { .in = in, .out = out, .x = x, .y = y, .w = w, .h = h };
+    const int nb_jobs = FFMIN(s->nb_caches, h);
+    int i, ret = 0;
+
+    if (nb_jobs <= 1)
+        return s->set_frame(s, s->cache, out, in, x, y, w, h, y, y + h);
+
+    for (i = y; i < y + h; i++)
+        atomic_init(&s->row_progress[i], 0);
+    atomic_init(&s->next_row, y);
+    s->wavefront = 1;
+    ctx->internal->execute(ctx, set_frame_slice, &td, s->job_ret, nb_jobs);
+    s->wavefront = 0;
+
+    for (i = 0; i < nb_jobs; i++)
+        if (s->job_ret[i] < 0)
+            ret = s->job_ret[i];
+    return ret;
+}
+
 static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
 {
     int x, y, w, h, ret;
@@ -923,7 +1117,7 @@ static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
     ff_dlog(ctx, "%dx%d rect: (%d;%d) -> (%d,%d) [area:%dx%d]\n",
             w, h, x, y, x+w, y+h, in->width, in->height);
 
-    ret = s->set_frame(s, out, in, x, y, w, h);
+    ret = set_frame_threaded(ctx, out, in, x, y, w, h);
     if (ret < 0) {
         av_frame_free(&out);
         *outf = NULL;
@@ -936,6 +1130,19 @@ static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
     return 0;
 }
 
+static void free_caches(PaletteUseContext *s)
+{
+    int i;
+
+    if (s->cache)
+        for (i = 0; i < s->nb_caches * CACHE_SIZE; i++)
+            av_freep(&s->cache[i].entries);
+    av_freep(&s->cache);
+    av_freep(&s->row_progress);
+    av_freep(&s->job_ret);
+    s->nb_caches = 0;
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     int ret;
@@ -952,6 +1159,18 @@ static int config_output(AVFilterLink *outlink)
     outlink->w = ctx->inputs[0]->w;
     outlink->h = ctx->inputs[0]->h;
 
+    free_caches(s);
+    s->nb_caches = ff_filter_get_nb_threads(ctx);
+    s->cache     = av_mallocz_array(s->nb_caches, CACHE_SIZE * sizeof(*s->cache));
+    if (!s->cache)
+        return AVERROR(ENOMEM);
+    if (s->nb_caches > 1) {
+        s->row_progress = av_malloc_array(outlink->h, sizeof(*s->row_progress));
+        s->job_ret      = av_malloc_array(s->nb_caches, sizeof(*s->job_ret));
+        if (!s->row_progress || !s->job_ret)
+            return AVERROR(ENOMEM);
+    }
+
     outlink->time_base = ctx->inputs[0]->time_base;
     if ((ret = ff_framesync_configure(&s->fs)) < 0)
         return ret;
@@ -984,9 +1203,9 @@ static void load_palette(PaletteUseContext *s, const AVFrame *palette_frame)
     if (s->new) {
         memset(s->palette, 0, sizeof(s->palette));
         memset(s->map, 0, sizeof(s->map));
-        for (i = 0; i < CACHE_SIZE; i++)
+        for (i = 0; i < s->nb_caches * CACHE_SIZE; i++)
             av_freep(&s->cache[i].entries);
-        memset(s->cache, 0, sizeof(s->cache));
+        memset(s->cache, 0, s->nb_caches * CACHE_SIZE * sizeof(*s->cache));
     }
 
     i = 0;
@@ -1034,10 +1253,13 @@ static int load_apply_palette(FFFrameSync *fs)
 }
 
 #define DEFINE_SET_FRAME(color_search, name, value)                             \
-static int set_frame_##name(PaletteUseContext *s, AVFrame *out, AVFrame *in,    \
-                            int x_start, int y_start, int w, int h)             \
+static int set_frame_##name(PaletteUseContext *s, struct cache_node *cache,     \
+                            AVFrame *out, AVFrame *in,                          \
+                            int x_start, int y_start, int w, int h,             \
+                            int slice_start, int slice_end)                     \
 {                                                                               \
-    return set_frame(s, out, in, x_start, y_start, w, h, value, color_search);  \
+    return set_frame(s, cache, out, in, x_start, y_start, w, h,                 \
+                     slice_start, slice_end, value, color_search);              \
 }
 
 #define DEFINE_SET_FRAME_COLOR_SEARCH(color_search, color_search_macro)                                 \
@@ -1089,6 +1311,20 @@ static av_cold int init(AVFilterContext *ctx)
 
     s->set_frame = set_frame_lut[s->color_search_method][s->dither];
 
+    /* the grid costs a full search of the palette per cell, only worth it
+     * when the palette is kept for the whole stream */
+    s->use_grid = !s->new && s->color_search_method != COLOR_SEARCH_BRUTEFORCE;
+
+#if HAVE_THREADS
+    if (pthread_mutex_init(&s->progress_mutex, NULL))
+        return AVERROR(ENOMEM);
+    if (pthread_cond_init(&s->progress_cond, NULL)) {
+        pthread_mutex_destroy(&s->progress_mutex);
+        return AVERROR(ENOMEM);
+    }
+    s->progress_init = 1;
+#endif
+
     if (s->dither == DITHERING_BAYER) {
         int i;
         const int delta = 1 << (5 - s->bayer_scale); // to avoid too much luma
@@ -1108,14 +1344,18 @@ static int activate(AVFilterContext *ctx)
 
 static av_cold void uninit(AVFilterContext *ctx)
 {
-    int i;
     PaletteUseContext *s = ctx->priv;
 
     ff_framesync_uninit(&s->fs);
-    for (i = 0; i < CACHE_SIZE; i++)
-        av_freep(&s->cache[i].entries);
+    free_caches(s);
     av_frame_free(&s->last_in);
     av_frame_free(&s->last_out);
+#if HAVE_THREADS
+    if (s->progress_init) {
+        pthread_mutex_destroy(&s->progress_mutex);
+        pthread_cond_destroy(&s->progress_cond);
+    }
+#endif
 }
 
 static const AVFilterPad paletteuse_inputs[] = {
@@ -1150,4 +1390,5 @@ AVFilter ff_vf_paletteuse = {
     .inputs        = paletteuse_inputs,
     .outputs       = paletteuse_outputs,
     .priv_class    = &paletteuse_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
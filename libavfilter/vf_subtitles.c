@@ -44,6 +44,16 @@
 #include "formats.h"
 #include "video.h"
 
+/**
+ * Coverage of consecutive ASS images of the same color, merged so that
+ * they are blended in one pass.
+ */
+typedef struct AssLayer {
+    uint8_t *mask;
+    int x, y, w, h;
+    FFDrawColor color;
+} AssLayer;
+
 typedef struct AssContext {
     const AVClass *class;
     ASS_Library  *library;
@@ -60,6 +70,10 @@ typedef struct AssContext {
     int original_w, original_h;
     int shaping;
     FFDrawContext draw;
+    AssLayer *layers;          ///< layers of the last rendered image
+    int nb_layers;
+    int layers_valid;          ///< layers hold the last image rendered by libass
+    int top, bottom;           ///< rows covered by the layers
 } AssContext;
 
 #define OFFSET(x) offsetof(AssContext, x)
@@ -121,10 +135,23 @@ static av_cold int init(AVFilterContext *ctx)
     return 0;
 }
 
+static void free_layers(AssContext *ass)
+{
+    int i;
+
+    for (i = 0; i < ass->nb_layers; i++)
+        av_freep(&ass->layers[i].mask);
+    av_freep(&ass->layers);
+    ass->nb_layers = 0;
+    ass->layers_valid = 0;
+}
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     AssContext *ass = ctx->priv;
 
+    free_layers(ass);
+
     if (ass->track)
         ass_free_track(ass->track);
     if (ass->renderer)
@@ -143,6 +170,7 @@ static int config_input(AVFilterLink *inlink)
     AssContext *ass = inlink->dst->priv;
 
     ff_draw_init(&ass->draw, inlink->format, ass->alpha ? FF_DRAW_PROCESS_ALPHA : 0);
+    ass->layers_valid = 0;
 
     ass_set_frame_size  (ass->renderer, inlink->w, inlink->h);
     if (ass->original_w && ass->original_h)
@@ -160,19 +188,130 @@ static int config_input(AVFilterLink *inlink)
 #define AB(c)  (((c)>>8) &0xFF)
 #define AA(c)  ((0xFF-(c)) &0xFF)
 
-static void overlay_ass_image(AssContext *ass, AVFrame *picref,
-                              const ASS_Image *image)
+static int images_overlap(const ASS_Image *a, const ASS_Image *b)
 {
-    for (; image; image = image->next) {
+    int x0 = FFMAX(a->dst_x, b->dst_x), x1 = FFMIN(a->dst_x + a->w, b->dst_x + b->w);
+    int y0 = FFMAX(a->dst_y, b->dst_y), y1 = FFMIN(a->dst_y + a->h, b->dst_y + b->h);
+    int x, y;
+
+    for (y = y0; y < y1; y++) {
+        const uint8_t *pa = a->bitmap + (y - a->dst_y) * a->stride - a->dst_x;
+        const uint8_t *pb = b->bitmap + (y - b->dst_y) * b->stride - b->dst_x;
+
+        for (x = x0; x < x1; x++)
+            if (pa[x] && pb[x])
+                return 1;
+    }
+    return 0;
+}
+
+/**
+ * Merge the runs of consecutive images of the same color into layers. An
+ * image overlapping one already in the run starts a new layer, so that
+ * overlapping drawings keep being blended one over the other.
+ */
+static int build_layers(AssContext *ass, const ASS_Image *image)
+{
+    free_layers(ass);
+    ass->top    = INT_MAX;
+    ass->bottom = INT_MIN;
+
+    while (image) {
+        const ASS_Image *first = image, *img;
+        int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
         uint8_t rgba_color[] = {AR(image->color), AG(image->color), AB(image->color), AA(image->color)};
-        FFDrawColor color;
-        ff_draw_color(&ass->draw, &color, rgba_color);
-        ff_blend_mask(&ass->draw, &color,
-                      picref->data, picref->linesize,
-                      picref->width, picref->height,
-                      image->bitmap, image->stride, image->w, image->h,
-                      3, 0, image->dst_x, image->dst_y);
+        AssLayer *layer;
+        int x, y;
+
+        for (; image && image->color == first->color; image = image->next) {
+            for (img = first; img != image && !images_overlap(img, image); img = img->next)
+                ;
+            if (img != image)
+                break;
+            if (image->w <= 0 || image->h <= 0)
+                continue;
+            x0 = FFMIN(x0, image->dst_x);
+            y0 = FFMIN(y0, image->dst_y);
+            x1 = FFMAX(x1, image->dst_x + image->w);
+            y1 = FFMAX(y1, image->dst_y + image->h);
+        }
+        if (x0 >= x1)
+            continue;
+        if ((int64_t)(x1 - x0) * (y1 - y0) > INT_MAX)
+            return AVERROR(EINVAL);
+
+        layer = av_realloc_array(ass->layers, ass->nb_layers + 1, sizeof(*ass->layers));
+        if (!layer)
+            return AVERROR(ENOMEM);
+        ass->layers = layer;
+        layer = &ass->layers[ass->nb_layers];
+        layer->x = x0;
+        layer->y = y0;
+        layer->w = x1 - x0;
+        layer->h = y1 - y0;
+        layer->mask = av_mallocz(layer->w * layer->h);
+        if (!layer->mask)
+            return AVERROR(ENOMEM);
+        ff_draw_color(&ass->draw, &layer->color, rgba_color);
+        ass->nb_layers++;
+
+        for (img = first; img != image; img = img->next) {
+            for (y = 0; y < img->h; y++) {
+                const uint8_t *src = img->bitmap + y * img->stride;
+                uint8_t *dst = layer->mask + (img->dst_y - y0 + y) * layer->w +
+                               img->dst_x - x0;
+
+                for (x = 0; x < img->w; x++)
+                    dst[x] |= src[x];
+            }
+        }
+
+        ass->top    = FFMIN(ass->top,    y0);
+        ass->bottom = FFMAX(ass->bottom, y1);
     }
+
+    ass->layers_valid = 1;
+    return 0;
+}
+
+static int slice_start(AssContext *ass, int top, int bottom, int jobnr, int nb_jobs)
+{
+    int y;
+
+    if (!jobnr)
+        return top;
+    if (jobnr == nb_jobs)
+        return bottom;
+    /* keep the slices on chroma row boundaries so that no two jobs blend
+     * the same subsampled row */
+    y = top + (bottom - top) * jobnr / nb_jobs;
+    return FFMAX(y & ~((1 << ass->draw.vsub_max) - 1), top);
+}
+
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AssContext *ass = ctx->priv;
+    AVFrame *picref = arg;
+    const int top    = FFMAX(ass->top, 0);
+    const int bottom = FFMIN(ass->bottom, picref->height);
+    const int start  = slice_start(ass, top, bottom, jobnr,     nb_jobs);
+    const int end    = slice_start(ass, top, bottom, jobnr + 1, nb_jobs);
+    int i;
+
+    for (i = 0; i < ass->nb_layers; i++) {
+        AssLayer *layer = &ass->layers[i];
+        int y0 = FFMAX(start - layer->y, 0);
+        int y1 = FFMIN(end   - layer->y, layer->h);
+
+        if (y0 < y1)
+            ff_blend_mask(&ass->draw, &layer->color,
+                          picref->data, picref->linesize,
+                          picref->width, picref->height,
+                          layer->mask + y0 * layer->w, layer->w, layer->w, y1 - y0,
+                          3, 0, layer->x, layer->y + y0);
+    }
+
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
@@ -184,11 +323,26 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
     double time_ms = picref->pts * av_q2d(inlink->time_base) * 1000;
     ASS_Image *image = ass_render_frame(ass->renderer, ass->track,
                                         time_ms, &detect_change);
+    int ret, top, bottom;
 
     if (detect_change)
         av_log(ctx, AV_LOG_DEBUG, "Change happened at time ms:%f\n", time_ms);
 
-    overlay_ass_image(ass, picref, image);
+    /* the layers are only rebuilt when libass reports a change */
+    if (detect_change || !ass->layers_valid) {
+        if ((ret = build_layers(ass, image)) < 0) {
+            free_layers(ass);
+            av_frame_free(&picref);
+            return ret;
+        }
+    }
+
+    top    = FFMAX(ass->top, 0);
+    bottom = FFMIN(ass->bottom, picref->height);
+    if (top < bottom)
+        ctx->internal->execute(ctx, blend_slice, picref, NULL,
+                               FFMIN(ff_filter_get_nb_threads(ctx),
+                                     FFMAX((bottom - top) >> (4 + ass->draw.vsub_max), 1)));
 
     return ff_filter_frame(outlink, picref);
 }
@@ -256,6 +410,7 @@ AVFilter ff_vf_ass = {
     .inputs        = ass_inputs,
     .outputs       = ass_outputs,
     .priv_class    = &ass_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif
 
@@ -494,5 +649,6 @@ AVFilter ff_vf_subtitles = {
     .inputs        = ass_inputs,
     .outputs       = ass_outputs,
     .priv_class    = &subtitles_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif
@@ -814,6 +814,45 @@ const char *avio_enum_protocols(void **opaque, int output);
  */
 const AVClass *avio_protocol_get_class(const char *name);
 
+/**
+ * Caller-provided I/O callbacks backing the "callback" protocol.
+ *
+ * All callbacks operate on buffers owned by libavformat and follow the
+ * URLProtocol conventions: they return the number of bytes transferred,
+ * AVERROR_EOF at the end of the stream or a negative AVERROR code on error.
+ * Callbacks that are not needed may be NULL; a stream without a seek
+ * callback is treated as non-seekable.
+ */
+typedef struct AVIOCallbacks {
+    /**
+     * Opaque pointer passed to every callback.
+     */
+    void *opaque;
+    int (*read)(void *opaque, uint8_t *buf, int size);
+    int (*write)(void *opaque, const uint8_t *buf, int size);
+    /**
+     * Seek like lseek(); whence may also be AVSEEK_SIZE, in which case the
+     * total size of the stream should be returned, or a negative value if
+     * it is unknown.
+     */
+    int64_t (*seek)(void *opaque, int64_t offset, int whence);
+    /**
+     * Called once when the URL is closed.
+     */
+    int (*close)(void *opaque);
+} AVIOCallbacks;
+
+/**
+ * Register callbacks under the given name, so that the URL "callback:name"
+ * reads from and writes to them. Registering a name again replaces the
+ * previous callbacks.
+ *
+ * @param name name of the stream, without the "callback:" prefix
+ * @param cb   callbacks to copy, or NULL to unregister name
+ * @return >= 0 on success, a negative AVERROR code on failure
+ */
+int avio_register_callbacks(const char *name, const AVIOCallbacks *cb);
+
 /**
  * Pause and resume playing - only meaningful if using a network streaming
  * protocol (e.g. MMS).
@@ -0,0 +1,88 @@
+/*
+ * Callback protocol: stream data through caller-provided callbacks
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/avstring.h"
+#include "libavutil/error.h"
+#include "avio.h"
+#include "url.h"
+
+typedef struct CallbackContext {
+    AVIOCallbacks cb;
+} CallbackContext;
+
+static int callback_open(URLContext *h, const char *filename, int flags)
+{
+    CallbackContext *c = h->priv_data;
+    int ret;
+
+    av_strstart(filename, "callback:", &filename);
+
+    if ((ret = ff_io_callbacks_get(filename, &c->cb)) < 0) {
+        av_log(h, AV_LOG_ERROR, "No callbacks registered for '%s'\n", filename);
+        return ret;
+    }
+    if ((flags & AVIO_FLAG_READ  && !c->cb.read) ||
+        (flags & AVIO_FLAG_WRITE && !c->cb.write)) {
+        av_log(h, AV_LOG_ERROR, "Callbacks for '%s' do not support %s\n",
+               filename, flags & AVIO_FLAG_WRITE ? "writing" : "reading");
+        return AVERROR(EINVAL);
+    }
+
+    h->is_streamed = !c->cb.seek;
+    return 0;
+}
+
+static int callback_read(URLContext *h, unsigned char *buf, int size)
+{
+    CallbackContext *c = h->priv_data;
+    int ret = c->cb.read(c->cb.opaque, buf, size);
+    return ret ? ret : AVERROR_EOF;
+}
+
+static int callback_write(URLContext *h, const unsigned char *buf, int size)
+{
+    CallbackContext *c = h->priv_data;
+    return c->cb.write(c->cb.opaque, buf, size);
+}
+
+static int64_t callback_seek(URLContext *h, int64_t pos, int whence)
+{
+    CallbackContext *c = h->priv_data;
+
+    if (!c->cb.seek)
+        return AVERROR(ENOSYS);
+    return c->cb.seek(c->cb.opaque, pos, whence);
+}
+
+static int callback_close(URLContext *h)
+{
+    CallbackContext *c = h->priv_data;
+    return c->cb.close ? c->cb.close(c->cb.opaque) : 0;
+}
+
+const URLProtocol ff_callback_protocol = {
+    .name           = "callback",
+    .url_open       = callback_open,
+    .url_read       = callback_read,
+    .url_write      = callback_write,
+    .url_seek       = callback_seek,
+    .url_close      = callback_close,
+    .priv_data_size = sizeof(CallbackContext),
+};
@@ -33,6 +33,9 @@
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include <sys/stat.h>
 #include <stdlib.h>
 #include "os_support.h"
@@ -74,6 +77,10 @@ typedef struct FileContext {
     int blocksize;
     int follow;
     int seekable;
+    int use_mmap;
+    uint8_t *map;       ///< mapping of the whole file in mmap mode, NULL otherwise
+    int64_t map_size;
+    int64_t pos;        ///< read position in mmap mode
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
@@ -84,6 +91,7 @@ static const AVOption file_options[] = {
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { "seekable", "Sets if the file is seekable", offsetof(FileContext, seekable), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 0, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
+    { "mmap", "map the file in memory and read from the mapping", offsetof(FileContext, use_mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { NULL }
 };
 
@@ -111,6 +119,14 @@ static int file_read(URLContext *h, unsigned char *buf, int size)
     FileContext *c = h->priv_data;
     int ret;
     size = FFMIN(size, c->blocksize);
+    if (c->map) {
+        if (c->pos >= c->map_size)
+            return AVERROR_EOF;
+        size = FFMIN(size, c->map_size - c->pos);
+        memcpy(buf, c->map + c->pos, size);
+        c->pos += size;
+        return size;
+    }
     ret = read(c->fd, buf, size);
     if (ret == 0 && c->follow)
         return AVERROR(EAGAIN);
@@ -205,6 +221,29 @@ static int file_move(URLContext *h_src, URLContext *h_dst)
 
 #if CONFIG_FILE_PROTOCOL
 
+#if HAVE_MMAP
+static void file_map(URLContext *h, const struct stat *st)
+{
+    FileContext *c = h->priv_data;
+    void *ptr;
+
+    if (!S_ISREG(st->st_mode) || h->is_streamed || c->follow ||
+        st->st_size <= 0 || st->st_size > SIZE_MAX) {
+        av_log(h, AV_LOG_VERBOSE, "Cannot map this file, reading it instead\n");
+        return;
+    }
+
+    ptr = mmap(NULL, st->st_size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (ptr == MAP_FAILED) {
+        av_log(h, AV_LOG_WARNING, "mmap() failed: %s, reading the file instead\n",
+               av_err2str(AVERROR(errno)));
+        return;
+    }
+    c->map      = ptr;
+    c->map_size = st->st_size;
+}
+#endif
+
 static int file_open(URLContext *h, const char *filename, int flags)
 {
     FileContext *c = h->priv_data;
@@ -243,6 +282,11 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (c->seekable >= 0)
         h->is_streamed = !c->seekable;
 
+#if HAVE_MMAP
+    if (c->use_mmap && !(flags & AVIO_FLAG_WRITE) && !fstat(fd, &st))
+        file_map(h, &st);
+#endif
+
     return 0;
 }
 
@@ -252,6 +296,17 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
     FileContext *c = h->priv_data;
     int64_t ret;
 
+    if (c->map) {
+        switch (whence) {
+        case AVSEEK_SIZE: return c->map_size;
+        case SEEK_CUR:    pos += c->pos;       break;
+        case SEEK_END:    pos += c->map_size;  break;
+        }
+        if (pos < 0)
+            return AVERROR(EINVAL);
+        return c->pos = pos;
+    }
+
     if (whence == AVSEEK_SIZE) {
         struct stat st;
         ret = fstat(c->fd, &st);
@@ -266,6 +321,10 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
+#if HAVE_MMAP
+    if (c->map)
+        munmap(c->map, c->map_size);
+#endif
     return close(c->fd);
 }
 
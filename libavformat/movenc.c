@@ -24,6 +24,14 @@
 #include <stdint.h>
 #include <inttypes.h>
 
+#include "config.h"
+#if HAVE_IO_H
+#include <io.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include "movenc.h"
 #include "avformat.h"
 #include "avio_internal.h"
@@ -54,10 +62,13 @@
 #include "libavutil/dovi_meta.h"
 #include "libavutil/color_utils.h"
 #include "hevc.h"
+#include "os_support.h"
 #include "rtpenc.h"
 #include "mov_chan.h"
 #include "vpcc.h"
 
+#define MDAT_CHUNK_SIZE (1 << 20)
+
 static const AVOption options[] = {
     { "movflags", "MOV muxer flags", offsetof(MOVMuxContext, flags), AV_OPT_TYPE_FLAGS, {.i64 = 0}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "rtphint", "Add RTP hint tracks", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_RTP_HINT}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
@@ -69,6 +80,7 @@ static const AVOption options[] = {
     { "frag_custom", "Flush fragments on caller requests", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_CUSTOM}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "isml", "Create a live smooth streaming feed (for pushing to a publishing point)", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_ISML}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "faststart", "Run a second pass to put the index (moov atom) at the beginning of the file", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FASTSTART}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
+    { "faststart_buffered", "Buffer the media data to write the index (moov atom) at the beginning of the file in a single pass", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FASTSTART_BUFFERED}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "omit_tfhd_offset", "Omit the base data offset in tfhd atoms", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_OMIT_TFHD_OFFSET}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "disable_chpl", "Disable Nero chapter atom", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_DISABLE_CHPL}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "default_base_moof", "Set the default-base-is-moof flag in tfhd atoms", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_DEFAULT_BASE_MOOF}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
@@ -107,6 +119,7 @@ static const AVOption options[] = {
     { "wallclock", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = MOV_PRFT_SRC_WALLCLOCK}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "prft"},
     { "pts", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = MOV_PRFT_SRC_PTS}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "prft"},
     { "empty_hdlr_name", "write zero-length name string in hdlr atoms within mdia and minf atoms", offsetof(MOVMuxContext, empty_hdlr_name), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
+    { "mdat_buffer_size", "maximum media data kept in memory by faststart_buffered before spilling to a temporary file, 0 for no limit", offsetof(MOVMuxContext, mdat_buffer_size), AV_OPT_TYPE_INT64, {.i64 = 0}, 0, INT64_MAX, AV_OPT_FLAG_ENCODING_PARAM},
     { NULL },
 };
 
@@ -5461,6 +5474,8 @@ int ff_mov_write_packet(AVFormatContext *s, AVPacket *pkt)
             }
             pb = mov->mdat_buf;
         }
+    } else if (mov->mdat_store) {
+        pb = mov->mdat_store;
     }
 
     if (par->codec_id == AV_CODEC_ID_AMR_NB) {
@@ -6177,6 +6192,17 @@ static void mov_free(AVFormatContext *s)
     }
 
     av_freep(&mov->tracks);
+
+    if (mov->mdat_store) {
+        av_freep(&mov->mdat_store->buffer);
+        avio_context_free(&mov->mdat_store);
+    }
+    for (i = 0; i < mov->nb_mdat_chunks; i++)
+        av_freep(&mov->mdat_chunks[i]);
+    av_freep(&mov->mdat_chunks);
+    if (mov->spill_fd >= 0)
+        close(mov->spill_fd);
+    mov->spill_fd = -1;
 }
 
 static uint32_t rgb_to_yuv(uint32_t rgb)
@@ -6252,6 +6278,7 @@ static int mov_init(AVFormatContext *s)
     int i, ret;
 
     mov->fc = s;
+    mov->spill_fd = -1;
 
     /* Default mode == MP4 */
     mov->mode = MODE_MP4;
@@ -6299,6 +6326,18 @@ static int mov_init(AVFormatContext *s)
         mov->flags &= ~FF_MOV_FLAG_SKIP_SIDX;
     }
 
+    if (mov->flags & FF_MOV_FLAG_FASTSTART_BUFFERED) {
+        if (mov->flags & FF_MOV_FLAG_FRAGMENT) {
+            av_log(s, AV_LOG_ERROR, "faststart_buffered is not supported with fragmentation\n");
+            return AVERROR(EINVAL);
+        }
+        if (mov->flags & FF_MOV_FLAG_FASTSTART || mov->reserved_moov_size) {
+            av_log(s, AV_LOG_WARNING, "faststart_buffered is set; ignoring faststart and moov_size\n");
+            mov->flags &= ~FF_MOV_FLAG_FASTSTART;
+            mov->reserved_moov_size = 0;
+        }
+    }
+
     if (mov->flags & FF_MOV_FLAG_FASTSTART) {
         mov->reserved_moov_size = -1;
     }
@@ -6349,7 +6388,8 @@ static int mov_init(AVFormatContext *s)
     /* Non-seekable output is ok if using fragmentation. If ism_lookahead
      * is enabled, we don't support non-seekable output at all. */
     if (!(s->pb->seekable & AVIO_SEEKABLE_NORMAL) &&
-        (!(mov->flags & FF_MOV_FLAG_FRAGMENT) || mov->ism_lookahead)) {
+        (!(mov->flags & (FF_MOV_FLAG_FRAGMENT | FF_MOV_FLAG_FASTSTART_BUFFERED)) ||
+         mov->ism_lookahead)) {
         av_log(s, AV_LOG_ERROR, "muxer does not support non seekable output\n");
         return AVERROR(EINVAL);
     }
@@ -6582,6 +6622,54 @@ static int mov_init(AVFormatContext *s)
     return 0;
 }
 
+/**
+ * Write callback of the faststart_buffered media data store: the data is
+ * kept in memory in chunks of MDAT_CHUNK_SIZE, then in a temporary file
+ * once mdat_buffer_size is reached.
+ */
+static int mdat_store_write(void *opaque, uint8_t *buf, int buf_size)
+{
+    AVFormatContext *s = opaque;
+    MOVMuxContext *mov = s->priv_data;
+    int size = buf_size;
+
+    while (size > 0) {
+        int offset, n;
+
+        if (mov->spill_fd >= 0) {
+            n = write(mov->spill_fd, buf, size);
+            if (n < 0) {
+                av_log(s, AV_LOG_ERROR, "Failed to write the media data to the temporary file\n");
+                return AVERROR(errno);
+            }
+        } else if (mov->mdat_buffer_size && mov->mdat_chunks_size >= mov->mdat_buffer_size) {
+            char *filename;
+
+            mov->spill_fd = avpriv_tempfile("ffmovmdat", &filename, 0, s);
+            if (mov->spill_fd < 0)
+                return mov->spill_fd;
+            unlink(filename);
+            av_free(filename);
+            continue;
+        } else {
+            offset = mov->mdat_chunks_size % MDAT_CHUNK_SIZE;
+            if (!offset) {
+                uint8_t *chunk = av_malloc(MDAT_CHUNK_SIZE);
+                if (!chunk || av_dynarray_add_nofree(&mov->mdat_chunks, &mov->nb_mdat_chunks, chunk) < 0) {
+                    av_free(chunk);
+                    return AVERROR(ENOMEM);
+                }
+            }
+            n = FFMIN(size, MDAT_CHUNK_SIZE - offset);
+            memcpy(mov->mdat_chunks[mov->nb_mdat_chunks - 1] + offset, buf, n);
+            mov->mdat_chunks_size += n;
+        }
+        buf  += n;
+        size -= n;
+    }
+    return buf_size;
+}
+
 static int mov_write_header(AVFormatContext *s)
 {
     AVIOContext *pb = s->pb;
@@ -6660,6 +6748,15 @@ static int mov_write_header(AVFormatContext *s)
                             FF_MOV_FLAG_FRAG_EVERY_FRAME)) &&
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
+    } else if (mov->flags & FF_MOV_FLAG_FASTSTART_BUFFERED) {
+        uint8_t *buf = av_malloc(32768);
+        if (!buf)
+            return AVERROR(ENOMEM);
+        mov->mdat_store = avio_alloc_context(buf, 32768, 1, s, NULL, mdat_store_write, NULL);
+        if (!mov->mdat_store) {
+            av_free(buf);
+            return AVERROR(ENOMEM);
+        }
     } else {
         if (mov->flags & FF_MOV_FLAG_FASTSTART)
             mov->reserved_header_pos = avio_tell(pb);
@@ -6859,6 +6956,83 @@ end:
     return ret;
 }
 
+/*
+ * faststart_buffered: the moov atom goes right after the header, followed
+ * by the media data from the store. The layout is the same as after the
+ * faststart second pass.
+ */
+static int mov_write_buffered_mdat(AVFormatContext *s)
+{
+    MOVMuxContext *mov = s->priv_data;
+    AVIOContext *pb = s->pb;
+    AVIOContext *moov_buf;
+    uint8_t *moov;
+    int64_t pos = avio_tell(pb);
+    int i, ret, moov_size;
+
+    avio_flush(mov->mdat_store);
+    if (mov->mdat_store->error < 0)
+        return mov->mdat_store->error;
+
+    /* the media data follows the moov and the 16 bytes of the free and
+     * mdat headers */
+    for (i = 0; i < mov->nb_streams; i++)
+        mov->tracks[i].data_offset = pos + 16;
+    if ((ret = compute_moov_size(s)) < 0)
+        return ret;
+
+    /* the atom sizes are updated by seeking back, which the output may not
+     * support, so build the moov in memory */
+    if ((ret = avio_open_dyn_buf(&moov_buf)) < 0)
+        return ret;
+    ret = mov_write_moov_tag(moov_buf, mov, s);
+    moov_size = avio_close_dyn_buf(moov_buf, &moov);
+    if (ret >= 0)
+        avio_write(pb, moov, moov_size);
+    av_free(moov);
+    if (ret < 0)
+        return ret;
+
+    if (mov->mdat_size + 8 <= UINT32_MAX) {
+        avio_wb32(pb, 8);
+        ffio_wfourcc(pb, mov->mode == MODE_MOV ? "wide" : "free");
+        avio_wb32(pb, mov->mdat_size + 8);
+        ffio_wfourcc(pb, "mdat");
+    } else {
+        avio_wb32(pb, 1);
+        ffio_wfourcc(pb, "mdat");
+        avio_wb64(pb, mov->mdat_size + 16);
+    }
+
+    for (i = 0; i < mov->nb_mdat_chunks; i++) {
+        avio_write(pb, mov->mdat_chunks[i],
+                   FFMIN(MDAT_CHUNK_SIZE, mov->mdat_chunks_size - (int64_t)i * MDAT_CHUNK_SIZE));
+        av_freep(&mov->mdat_chunks[i]);
+    }
+
+    if (mov->spill_fd >= 0) {
+        uint8_t *buf = av_malloc(MDAT_CHUNK_SIZE);
+        int n;
+
+        if (!buf)
+            return AVERROR(ENOMEM);
+        if (lseek(mov->spill_fd, 0, SEEK_SET) < 0) {
+            av_free(buf);
+            return AVERROR(errno);
+        }
+        while ((n = read(mov->spill_fd, buf, MDAT_CHUNK_SIZE)) > 0)
+            avio_write(pb, buf, n);
+        ret = n < 0 ? AVERROR(errno) : 0;
+        av_free(buf);
+        if (ret < 0) {
+            av_log(s, AV_LOG_ERROR, "Failed to read back the buffered media data\n");
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
 static int mov_write_trailer(AVFormatContext *s)
 {
     MOVMuxContext *mov = s->priv_data;
@@ -6906,7 +7080,10 @@ static int mov_write_trailer(AVFormatContext *s)
         }
     }
 
-    if (!(mov->flags & FF_MOV_FLAG_FRAGMENT)) {
+    if (mov->mdat_store) {
+        if ((res = mov_write_buffered_mdat(s)) < 0)
+            return res;
+    } else if (!(mov->flags & FF_MOV_FLAG_FRAGMENT)) {
         moov_pos = avio_tell(pb);
 
         /* Write size of mdat tag */
@@ -235,6 +235,13 @@ typedef struct MOVMuxContext {
     int write_tmcd;
     MOVPrftBox write_prft;
     int empty_hdlr_name;
+
+    AVIOContext *mdat_store;    ///< media data buffered for faststart_buffered
+    uint8_t **mdat_chunks;
+    int nb_mdat_chunks;
+    int64_t mdat_chunks_size;   ///< bytes in mdat_chunks
+    int64_t mdat_buffer_size;   ///< in-memory limit of the store, 0 for none
+    int spill_fd;               ///< temporary file the store spills to, or -1
 } MOVMuxContext;
 
 #define FF_MOV_FLAG_RTP_HINT              (1 <<  0)
@@ -261,6 +268,7 @@ typedef struct MOVMuxContext {
 #define FF_MOV_FLAG_SKIP_SIDX             (1 << 21)
 #define FF_MOV_FLAG_CMAF                  (1 << 22)
 #define FF_MOV_FLAG_PREFER_ICC            (1 << 23)
+#define FF_MOV_FLAG_FASTSTART_BUFFERED    (1 << 24)
 
 int ff_mov_write_packet(AVFormatContext *s, AVPacket *pkt);
 
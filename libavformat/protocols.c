@@ -20,12 +20,14 @@
 
 #include "libavutil/avstring.h"
 #include "libavutil/mem.h"
+#include "libavutil/thread.h"
 
 #include "url.h"
 
 extern const URLProtocol ff_async_protocol;
 extern const URLProtocol ff_bluray_protocol;
 extern const URLProtocol ff_cache_protocol;
+extern const URLProtocol ff_callback_protocol;
 extern const URLProtocol ff_concat_protocol;
 extern const URLProtocol ff_crypto_protocol;
 extern const URLProtocol ff_data_protocol;
@@ -118,6 +120,64 @@ const AVClass *avio_protocol_get_class(const char *name)
     return NULL;
 }
 
+typedef struct IOCallbacksEntry {
+    char *name;
+    AVIOCallbacks cb;
+    struct IOCallbacksEntry *next;
+} IOCallbacksEntry;
+
+static IOCallbacksEntry *io_callbacks;
+static AVMutex io_callbacks_mutex = AV_MUTEX_INITIALIZER;
+
+int avio_register_callbacks(const char *name, const AVIOCallbacks *cb)
+{
+    IOCallbacksEntry **p, *entry;
+    int ret = 0;
+
+    ff_mutex_lock(&io_callbacks_mutex);
+    for (p = &io_callbacks; *p; p = &(*p)->next)
+        if (!strcmp((*p)->name, name))
+            break;
+
+    if (!cb) {
+        if ((entry = *p)) {
+            *p = entry->next;
+            av_free(entry->name);
+            av_free(entry);
+        }
+    } else if (*p) {
+        (*p)->cb = *cb;
+    } else if (!(entry = av_mallocz(sizeof(*entry))) ||
+               !(entry->name = av_strdup(name))) {
+        av_free(entry);
+        ret = AVERROR(ENOMEM);
+    } else {
+        entry->cb = *cb;
+        *p = entry;
+    }
+    ff_mutex_unlock(&io_callbacks_mutex);
+
+    return ret;
+}
+
+int ff_io_callbacks_get(const char *name, AVIOCallbacks *cb)
+{
+    IOCallbacksEntry *entry;
+    int ret = AVERROR(ENOENT);
+
+    ff_mutex_lock(&io_callbacks_mutex);
+    for (entry = io_callbacks; entry; entry = entry->next) {
+        if (!strcmp(entry->name, name)) {
+            *cb = entry->cb;
+            ret = 0;
+            break;
+        }
+    }
+    ff_mutex_unlock(&io_callbacks_mutex);
+
+    return ret;
+}
+
 const URLProtocol **ffurl_get_protocols(const char *whitelist,
                                         const char *blacklist)
 {
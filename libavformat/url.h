@@ -324,6 +324,14 @@ AVIODirEntry *ff_alloc_dir_entry(void);
 
 const AVClass *ff_urlcontext_child_class_next(const AVClass *prev);
 
+/**
+ * Look up callbacks registered with avio_register_callbacks().
+ *
+ * @return 0 and a copy of the callbacks in cb if name is registered,
+ *         AVERROR(ENOENT) otherwise
+ */
+int ff_io_callbacks_get(const char *name, AVIOCallbacks *cb);
+
 /**
  * Construct a list of protocols matching a given whitelist and/or blacklist.
  *
@@ -231,6 +231,9 @@ AVBufferPool *av_buffer_pool_init2(int size, void *opaque,
     pool->alloc     = av_buffer_alloc; // fallback
     pool->pool_free = pool_free;
 
+    atomic_init(&pool->pool, 0);
+    atomic_init(&pool->hits, 0);
+    atomic_init(&pool->misses, 0);
     atomic_init(&pool->refcount, 1);
 
     return pool;
@@ -247,24 +250,35 @@ AVBufferPool *av_buffer_pool_init(int size, AVBufferRef* (*alloc)(int size))
     pool->size     = size;
     pool->alloc    = alloc ? alloc : av_buffer_alloc;
 
+    atomic_init(&pool->pool, 0);
+    atomic_init(&pool->hits, 0);
+    atomic_init(&pool->misses, 0);
     atomic_init(&pool->refcount, 1);
 
     return pool;
 }
 
+static BufferPoolEntry *pool_entry(AVBufferPool *pool, unsigned index)
+{
+    int k = av_log2(index);
+    return &pool->segments[k][index - (1U << k)];
+}
+
 /*
  * This function gets called when the pool has been uninited and
  * all the buffers returned to it.
  */
 static void buffer_pool_free(AVBufferPool *pool)
 {
-    while (pool->pool) {
-        BufferPoolEntry *buf = pool->pool;
-        pool->pool = buf->next;
+    unsigned i;
 
+    /* all the entries are back on the stack at this point */
+    for (i = 1; i <= pool->nb_entries; i++) {
+        BufferPoolEntry *buf = pool_entry(pool, i);
         buf->free(buf->opaque, buf->data);
-        av_freep(&buf);
     }
+    for (i = 0; i < FF_ARRAY_ELEMS(pool->segments); i++)
+        av_freep(&pool->segments[i]);
     ff_mutex_destroy(&pool->mutex);
 
     if (pool->pool_free)
@@ -286,6 +300,49 @@ void av_buffer_pool_uninit(AVBufferPool **ppool)
         buffer_pool_free(pool);
 }
 
+/* a new stack head with the given entry on top and the tag of head bumped */
+static intptr_t pool_head(intptr_t head, unsigned index)
+{
+    uintptr_t tag = ((uintptr_t)head >> POOL_INDEX_BITS) + 1;
+    return (intptr_t)(tag << POOL_INDEX_BITS | index);
+}
+
+static void pool_push(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    intptr_t head = atomic_load_explicit(&pool->pool, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&buf->next, (uintptr_t)head & POOL_INDEX_MASK,
+                              memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->pool, &head,
+                                                    pool_head(head, buf->index),
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/* take the top entry off the pool stack, NULL only if the pool is empty */
+static BufferPoolEntry *pool_pop(AVBufferPool *pool)
+{
+    intptr_t head = atomic_load_explicit(&pool->pool, memory_order_acquire);
+    BufferPoolEntry *buf;
+    unsigned next;
+
+    do {
+        unsigned index = (uintptr_t)head & POOL_INDEX_MASK;
+        if (!index)
+            return NULL;
+        /* Entries are only freed with the pool, so buf stays valid even if
+         * another thread pops it first; the tag then makes the swap fail. */
+        buf  = pool_entry(pool, index);
+        next = atomic_load_explicit(&buf->next, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->pool, &head,
+                                                    pool_head(head, next),
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+
+    return buf;
+}
+
 static void pool_release_buffer(void *opaque, uint8_t *data)
 {
     BufferPoolEntry *buf = opaque;
@@ -294,15 +351,36 @@ static void pool_release_buffer(void *opaque, uint8_t *data)
     if(CONFIG_MEMORY_POISONING)
         memset(buf->data, FF_MEMORY_POISON, pool->size);
 
-    ff_mutex_lock(&pool->mutex);
-    buf->next = pool->pool;
-    pool->pool = buf;
-    ff_mutex_unlock(&pool->mutex);
+    pool_push(pool, buf);
 
     if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
 }
 
+/* add an entry to the pool, must be called with the mutex held */
+static BufferPoolEntry *pool_new_entry(AVBufferPool *pool)
+{
+    unsigned index;
+    BufferPoolEntry *buf;
+    int k;
+
+    if (pool->nb_entries == POOL_INDEX_MASK)
+        return NULL;
+    index = pool->nb_entries + 1;
+    k     = av_log2(index);
+    if (!pool->segments[k]) {
+        pool->segments[k] = av_mallocz_array(1U << k, sizeof(*pool->segments[k]));
+        if (!pool->segments[k])
+            return NULL;
+    }
+    pool->nb_entries = index;
+
+    buf = pool_entry(pool, index);
+    buf->index = index;
+    atomic_init(&buf->next, 0);
+    return buf;
+}
+
 /* allocate a new buffer and override its free() callback so that
  * it is returned to the pool on free */
 static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
@@ -317,7 +395,7 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
     if (!ret)
         return NULL;
 
-    buf = av_mallocz(sizeof(*buf));
+    buf = pool_new_entry(pool);
     if (!buf) {
         av_buffer_unref(&ret);
         return NULL;
@@ -339,19 +417,21 @@ AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
     AVBufferRef *ret;
     BufferPoolEntry *buf;
 
-    ff_mutex_lock(&pool->mutex);
-    buf = pool->pool;
+    buf = pool_pop(pool);
     if (buf) {
         ret = av_buffer_create(buf->data, pool->size, pool_release_buffer,
                                buf, 0);
-        if (ret) {
-            pool->pool = buf->next;
-            buf->next = NULL;
-        }
+        if (ret)
+            atomic_fetch_add_explicit(&pool->hits, 1, memory_order_relaxed);
+        else
+            pool_push(pool, buf);
     } else {
+        ff_mutex_lock(&pool->mutex);
         ret = pool_alloc_buffer(pool);
+        ff_mutex_unlock(&pool->mutex);
+        if (ret)
+            atomic_fetch_add_explicit(&pool->misses, 1, memory_order_relaxed);
     }
-    ff_mutex_unlock(&pool->mutex);
 
     if (ret)
         atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
@@ -365,3 +445,11 @@ void *av_buffer_pool_buffer_get_opaque(AVBufferRef *ref)
     av_assert0(buf);
     return buf->opaque;
 }
+
+void av_buffer_pool_get_stats(AVBufferPool *pool, uint64_t *hits, uint64_t *misses)
+{
+    if (hits)
+        *hits   = atomic_load_explicit(&pool->hits,   memory_order_relaxed);
+    if (misses)
+        *misses = atomic_load_explicit(&pool->misses, memory_order_relaxed);
+}
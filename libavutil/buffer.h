@@ -298,6 +298,16 @@ AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
  */
 void *av_buffer_pool_buffer_get_opaque(AVBufferRef *ref);
 
+/**
+ * Query how well the pool serves its users.
+ *
+ * @param hits   if not NULL, set to the number of av_buffer_pool_get() calls
+ *               that reused a buffer from the pool
+ * @param misses if not NULL, set to the number of av_buffer_pool_get() calls
+ *               that had to allocate a new buffer
+ */
+void av_buffer_pool_get_stats(AVBufferPool *pool, uint64_t *hits, uint64_t *misses);
+
 /**
  * @}
  */
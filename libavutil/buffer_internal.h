@@ -71,12 +71,48 @@ typedef struct BufferPoolEntry {
     void (*free)(void *opaque, uint8_t *data);
 
     AVBufferPool *pool;
-    struct BufferPoolEntry *next;
+
+    /* index of this entry in the pool, and of the next one on the stack */
+    unsigned index;
+    atomic_uint next;
 } BufferPoolEntry;
 
+/*
+ * The stack head packs the index of the top entry in the low half of the
+ * word and a tag bumped on every change in the high half, so that a pop
+ * racing with other pops and pushes of the same entry cannot succeed with
+ * a stale next index (ABA).
+ */
+#define POOL_INDEX_BITS (sizeof(intptr_t) * 4)
+#define POOL_INDEX_MASK (((uintptr_t)1 << POOL_INDEX_BITS) - 1)
+
 struct AVBufferPool {
+    /*
+     * Serializes the alloc callbacks and the creation of entries. Getting and
+     * returning pooled buffers does not take it.
+     */
     AVMutex mutex;
-    BufferPoolEntry *pool;
+
+    /*
+     * Entries, by 1-based index: segment k holds the 1 << k entries starting
+     * at index 1 << k. Segments are never moved, so an index can be resolved
+     * without the mutex once it has been published on the stack.
+     */
+    BufferPoolEntry *segments[POOL_INDEX_BITS];
+    unsigned nb_entries;
+
+    /*
+     * Treiber stack of the available entries, see POOL_INDEX_BITS.
+     * An index of 0 means the stack is empty.
+     */
+    atomic_intptr_t pool;
+
+    /*
+     * Number of av_buffer_pool_get() calls served from the pool, and that had
+     * to allocate a new buffer.
+     */
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
 
     /*
      * This is used to track when the pool is to be freed.
@@ -57,6 +57,8 @@ static int get_cpu_flags(void)
         return ff_get_cpu_flags_arm();
     if (ARCH_PPC)
         return ff_get_cpu_flags_ppc();
+    if (ARCH_WASM)
+        return ff_get_cpu_flags_wasm();
     if (ARCH_X86)
         return ff_get_cpu_flags_x86();
     return 0;
@@ -132,6 +134,8 @@ int av_parse_cpu_flags(const char *s)
         { "flags"   , NULL, 0, AV_OPT_TYPE_FLAGS, { .i64 = 0 }, INT64_MIN, INT64_MAX, .unit = "flags" },
 #if   ARCH_PPC
         { "altivec" , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_ALTIVEC  },    .unit = "flags" },
+#elif ARCH_WASM
+        { "simd128" , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_SIMD128  },    .unit = "flags" },
 #elif ARCH_X86
         { "mmx"     , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_MMX      },    .unit = "flags" },
         { "mmxext"  , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = CPUFLAG_MMXEXT       },    .unit = "flags" },
@@ -194,6 +198,8 @@ int av_parse_cpu_caps(unsigned *flags, const char *s)
         { "flags"   , NULL, 0, AV_OPT_TYPE_FLAGS, { .i64 = 0 }, INT64_MIN, INT64_MAX, .unit = "flags" },
 #if   ARCH_PPC
         { "altivec" , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_ALTIVEC  },    .unit = "flags" },
+#elif ARCH_WASM
+        { "simd128" , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_SIMD128  },    .unit = "flags" },
 #elif ARCH_X86
         { "mmx"     , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_MMX      },    .unit = "flags" },
         { "mmx2"    , NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_CPU_FLAG_MMX2     },    .unit = "flags" },
@@ -314,6 +320,8 @@ size_t av_cpu_max_align(void)
         return ff_get_cpu_max_align_arm();
     if (ARCH_PPC)
         return ff_get_cpu_max_align_ppc();
+    if (ARCH_WASM)
+        return ff_get_cpu_max_align_wasm();
     if (ARCH_X86)
         return ff_get_cpu_max_align_x86();
 
@@ -44,11 +44,13 @@
 int ff_get_cpu_flags_aarch64(void);
 int ff_get_cpu_flags_arm(void);
 int ff_get_cpu_flags_ppc(void);
+int ff_get_cpu_flags_wasm(void);
 int ff_get_cpu_flags_x86(void);
 
 size_t ff_get_cpu_max_align_aarch64(void);
 size_t ff_get_cpu_max_align_arm(void);
 size_t ff_get_cpu_max_align_ppc(void);
+size_t ff_get_cpu_max_align_wasm(void);
 size_t ff_get_cpu_max_align_x86(void);
 
 #endif /* AVUTIL_CPU_INTERNAL_H */
@@ -174,6 +174,7 @@ struct AVExpr {
     } a;
     struct AVExpr *param[3];
     double *var;
+    struct ExprProgram *prog;
 };
 
 static double etime(double v)
@@ -331,6 +332,255 @@ static double eval_expr(Parser *p, AVExpr *e)
     return NAN;
 }
 
+/*
+ * Compiled form of an expression, used by av_expr_eval_batch().
+ *
+ * The tree is flattened into an array of instructions in evaluation order,
+ * each one computing a block of EXPR_BLOCK results which later instructions
+ * read by index. Subtrees that depend neither on constants nor on user
+ * functions or time() are folded at compile time, and instructions whose
+ * operands do not vary over a call are run once per call instead of once
+ * per block. Expressions using the variables (ld, st, random, while, taylor,
+ * root) or print() depend on the evaluation order and are not compiled, they
+ * are evaluated element by element instead.
+ */
+#define EXPR_BLOCK 32
+
+typedef struct ExprInsn {
+    AVExpr *e;          ///< source node
+    int type;           ///< e->type, or e_value for a folded subtree
+    double value;       ///< result of a folded subtree
+    int src[3];         ///< instruction indices of the operands, -1 if absent
+    int uniform;        ///< same result for all the elements of the current call
+} ExprInsn;
+
+typedef struct ExprProgram {
+    ExprInsn *insn;
+    int nb_insn;
+    int scalar;         ///< not compiled, evaluate element by element
+    int nb_consts;      ///< number of constants referenced by the expression
+    double *consts;     ///< constants of the current element, scalar only
+    double *regs;       ///< nb_insn blocks of EXPR_BLOCK results
+} ExprProgram;
+
+static void free_program(ExprProgram **pprog)
+{
+    ExprProgram *prog = *pprog;
+
+    if (!prog)
+        return;
+    av_freep(&prog->insn);
+    av_freep(&prog->consts);
+    av_freep(&prog->regs);
+    av_freep(pprog);
+}
+
+/* count nodes and constants, return 0 if the result depends on evaluation order */
+static int scan_expr(const AVExpr *e, int *nb_nodes, int *nb_consts)
+{
+    int i, ret = 1;
+
+    if (!e)
+        return 1;
+    (*nb_nodes)++;
+    switch (e->type) {
+    case e_const:
+        *nb_consts = FFMAX(*nb_consts, e->const_index + 1);
+        break;
+    case e_ld:
+    case e_st:
+    case e_random:
+    case e_while:
+    case e_taylor:
+    case e_root:
+    case e_print:
+        ret = 0;
+        break;
+    }
+    for (i = 0; i < 3; i++)
+        ret &= scan_expr(e->param[i], nb_nodes, nb_consts);
+    return ret;
+}
+
+static int emit_insn(ExprProgram *prog, AVExpr *e)
+{
+    int first = prog->nb_insn, src[3] = { -1, -1, -1 };
+    int foldable, i;
+    ExprInsn *in;
+
+    foldable = e->type != e_const && e->type != e_func1 && e->type != e_func2 &&
+               !(e->type == e_func0 && e->a.func0 == etime);
+    for (i = 0; i < 3; i++) {
+        if (!e->param[i])
+            continue;
+        src[i] = emit_insn(prog, e->param[i]);
+        foldable &= prog->insn[src[i]].type == e_value;
+    }
+
+    /* the operands are dropped, the folded subtree has no state to touch */
+    if (foldable)
+        prog->nb_insn = first;
+    in = &prog->insn[prog->nb_insn];
+    in->e    = e;
+    in->type = foldable ? e_value : e->type;
+    if (foldable) {
+        Parser p = { 0 };
+        in->value = eval_expr(&p, e);
+    }
+    memcpy(in->src, src, sizeof(in->src));
+    return prog->nb_insn++;
+}
+
+static int compile_expr(AVExpr *e)
+{
+    ExprProgram *prog = av_mallocz(sizeof(*prog));
+    int nb_nodes = 0;
+
+    if (!prog)
+        return AVERROR(ENOMEM);
+
+    prog->scalar = !scan_expr(e, &nb_nodes, &prog->nb_consts);
+    if (prog->scalar) {
+        prog->consts = av_malloc_array(FFMAX(prog->nb_consts, 1), sizeof(*prog->consts));
+        if (!prog->consts)
+            goto fail;
+    } else {
+        prog->insn = av_malloc_array(nb_nodes, sizeof(*prog->insn));
+        if (!prog->insn)
+            goto fail;
+        emit_insn(prog, e);
+        prog->regs = av_malloc_array(prog->nb_insn, EXPR_BLOCK * sizeof(*prog->regs));
+        if (!prog->regs)
+            goto fail;
+    }
+
+    e->prog = prog;
+    return 0;
+fail:
+    free_program(&prog);
+    return AVERROR(ENOMEM);
+}
+
+static int insn_uniform(const ExprProgram *prog, const ExprInsn *in,
+                        const double * const *const_arrays)
+{
+    int i;
+
+    if (in->type == e_const)
+        return !const_arrays || !const_arrays[in->e->const_index];
+    if (in->type == e_func0 && in->e->a.func0 == etime)
+        return 0;
+    for (i = 0; i < 3; i++)
+        if (in->src[i] >= 0 && !prog->insn[in->src[i]].uniform)
+            return 0;
+    return 1;
+}
+
+/* same operations as eval_expr(), so that both give identical results */
+static void run_insn(const ExprProgram *prog, const ExprInsn *in, double *d,
+                     int n, int offset, const double *const_values,
+                     const double * const *const_arrays, void *opaque)
+{
+    const AVExpr *e = in->e;
+    const double s = e->value;
+    const double *a = in->src[0] >= 0 ? prog->regs + in->src[0] * EXPR_BLOCK : NULL;
+    const double *b = in->src[1] >= 0 ? prog->regs + in->src[1] * EXPR_BLOCK : NULL;
+    const double *c = in->src[2] >= 0 ? prog->regs + in->src[2] * EXPR_BLOCK : NULL;
+    int i;
+
+#define UNARY(expr)                                             \
+    for (i = 0; i < n; i++) {                                   \
+        const double x = a[i];                                  \
+        d[i] = expr;                                            \
+    }                                                           \
+    break
+#define BINARY(expr)                                            \
+    for (i = 0; i < n; i++) {                                   \
+        const double x = a[i], y = b[i];                        \
+        d[i] = expr;                                            \
+    }                                                           \
+    break
+
+    switch (in->type) {
+    case e_value:
+        for (i = 0; i < n; i++)
+            d[i] = in->value;
+        break;
+    case e_const: {
+        const double *v = in->uniform ? const_values + e->const_index
+                                      : const_arrays[e->const_index] + offset;
+        for (i = 0; i < n; i++)
+            d[i] = s * v[i];
+        break;
+    }
+    case e_func0:  UNARY(s * e->a.func0(x));
+    case e_func1:  UNARY(s * e->a.func1(opaque, x));
+    case e_func2:  BINARY(s * e->a.func2(opaque, x, y));
+    case e_squish: UNARY(1/(1+exp(4*x)));
+    case e_gauss:  UNARY(exp(-x*x/2)/sqrt(2*M_PI));
+    case e_isnan:  UNARY(s * !!isnan(x));
+    case e_isinf:  UNARY(s * !!isinf(x));
+    case e_floor:  UNARY(s * floor(x));
+    case e_ceil:   UNARY(s * ceil (x));
+    case e_trunc:  UNARY(s * trunc(x));
+    case e_round:  UNARY(s * round(x));
+    case e_sgn:    UNARY(s * FFDIFFSIGN(x, 0));
+    case e_sqrt:   UNARY(s * sqrt (x));
+    case e_not:    UNARY(s * (x == 0));
+    case e_if:
+        for (i = 0; i < n; i++)
+            d[i] = s * (a[i] ? b[i] : c ? c[i] : 0);
+        break;
+    case e_ifnot:
+        for (i = 0; i < n; i++)
+            d[i] = s * (!a[i] ? b[i] : c ? c[i] : 0);
+        break;
+    case e_clip:
+        for (i = 0; i < n; i++) {
+            if (isnan(b[i]) || isnan(c[i]) || isnan(a[i]) || b[i] > c[i])
+                d[i] = NAN;
+            else
+                d[i] = s * av_clipd(a[i], b[i], c[i]);
+        }
+        break;
+    case e_between:
+        for (i = 0; i < n; i++)
+            d[i] = s * (a[i] >= b[i] && a[i] <= c[i]);
+        break;
+    case e_lerp:
+        for (i = 0; i < n; i++)
+            d[i] = a[i] + (b[i] - a[i]) * c[i];
+        break;
+    case e_mod:    BINARY(s * (x - floor((!CONFIG_FTRAPV || y) ? x / y : x * INFINITY) * y));
+    case e_gcd:    BINARY(s * av_gcd(x, y));
+    case e_max:    BINARY(s * (x >  y ?   x : y));
+    case e_min:    BINARY(s * (x <  y ?   x : y));
+    case e_eq:     BINARY(s * (x == y ? 1.0 : 0.0));
+    case e_gt:     BINARY(s * (x >  y ? 1.0 : 0.0));
+    case e_gte:    BINARY(s * (x >= y ? 1.0 : 0.0));
+    case e_lt:     BINARY(s * (x <  y ? 1.0 : 0.0));
+    case e_lte:    BINARY(s * (x <= y ? 1.0 : 0.0));
+    case e_pow:    BINARY(s * pow(x, y));
+    case e_mul:    BINARY(s * (x * y));
+    case e_div:    BINARY(s * ((!CONFIG_FTRAPV || y) ? (x / y) : x * INFINITY));
+    case e_add:    BINARY(s * (x + y));
+    case e_last:
+        for (i = 0; i < n; i++)
+            d[i] = s * b[i];
+        break;
+    case e_hypot:  BINARY(s * hypot(x, y));
+    case e_atan2:  BINARY(s * atan2(x, y));
+    case e_bitand: BINARY(isnan(x) || isnan(y) ? NAN : s * ((long int)x & (long int)y));
+    case e_bitor:  BINARY(isnan(x) || isnan(y) ? NAN : s * ((long int)x | (long int)y));
+    default:
+        for (i = 0; i < n; i++)
+            d[i] = NAN;
+    }
+
+#undef UNARY
+#undef BINARY
+}
+
 static int parse_expr(AVExpr **e, Parser *p);
 
 void av_expr_free(AVExpr *e)
@@ -340,6 +590,7 @@ void av_expr_free(AVExpr *e)
     av_expr_free(e->param[1]);
     av_expr_free(e->param[2]);
     av_freep(&e->var);
+    free_program(&e->prog);
     av_freep(&e);
 }
 
@@ -773,6 +1024,61 @@ double av_expr_eval(AVExpr *e, const double *const_values, void *opaque)
     return eval_expr(&p, e);
 }
 
+int av_expr_eval_batch(AVExpr *e, double *dst, int nb,
+                       const double *const_values,
+                       const double * const *const_arrays, void *opaque)
+{
+    ExprProgram *prog;
+    ExprInsn *root;
+    int i, j, ret;
+
+    if (!e->prog && (ret = compile_expr(e)) < 0)
+        return ret;
+    prog = e->prog;
+
+    if (prog->scalar) {
+        if (prog->nb_consts)
+            memcpy(prog->consts, const_values, prog->nb_consts * sizeof(*prog->consts));
+        for (i = 0; i < nb; i++) {
+            for (j = 0; const_arrays && j < prog->nb_consts; j++)
+                if (const_arrays[j])
+                    prog->consts[j] = const_arrays[j][i];
+            dst[i] = av_expr_eval(e, prog->consts, opaque);
+        }
+        return 0;
+    }
+
+    for (i = 0; i < prog->nb_insn; i++) {
+        ExprInsn *in = &prog->insn[i];
+        double *d = prog->regs + i * EXPR_BLOCK;
+
+        in->uniform = insn_uniform(prog, in, const_arrays);
+        if (in->uniform) {
+            run_insn(prog, in, d, 1, 0, const_values, const_arrays, opaque);
+            for (j = 1; j < EXPR_BLOCK; j++)
+                d[j] = d[0];
+        }
+    }
+
+    root = &prog->insn[prog->nb_insn - 1];
+    if (root->uniform) {
+        for (i = 0; i < nb; i++)
+            dst[i] = prog->regs[(prog->nb_insn - 1) * EXPR_BLOCK];
+        return 0;
+    }
+
+    for (j = 0; j < nb; j += EXPR_BLOCK) {
+        const int n = FFMIN(nb - j, EXPR_BLOCK);
+
+        for (i = 0; i < prog->nb_insn; i++)
+            if (!prog->insn[i].uniform)
+                run_insn(prog, &prog->insn[i], prog->regs + i * EXPR_BLOCK, n, j,
+                         const_values, const_arrays, opaque);
+        memcpy(dst + j, prog->regs + (prog->nb_insn - 1) * EXPR_BLOCK, n * sizeof(*dst));
+    }
+    return 0;
+}
+
 int av_expr_parse_and_eval(double *d, const char *s,
                            const char * const *const_names, const double *const_values,
                            const char * const *func1_names, double (* const *funcs1)(void *, double),
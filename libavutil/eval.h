@@ -86,6 +86,33 @@ int av_expr_parse(AVExpr **expr, const char *s,
  */
 double av_expr_eval(AVExpr *e, const double *const_values, void *opaque);
 
+/**
+ * Evaluate a previously parsed expression for a set of nb elements, for
+ * example the pixels of a line or the samples of a buffer.
+ *
+ * This gives the same results as calling av_expr_eval() for each element,
+ * but the expression is compiled on the first call and then evaluated for
+ * blocks of elements, which is considerably faster. The functions from
+ * funcs1 and funcs2 may be called in a different order and a different
+ * number of times than with av_expr_eval(), so they must not have side
+ * effects. The same AVExpr must not be evaluated from several threads at
+ * the same time.
+ *
+ * @param dst array of nb values where the results are stored
+ * @param nb number of elements to evaluate
+ * @param const_values an array of values for the identifiers from
+ * av_expr_parse() const_names, used for the constants shared by all the
+ * elements
+ * @param const_arrays NULL, or an array with one entry for each of the
+ * identifiers from av_expr_parse() const_names; a non-NULL entry points to
+ * nb values of that constant, one per element, and overrides const_values
+ * @param opaque a pointer which will be passed to all functions from funcs1 and funcs2
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int av_expr_eval_batch(AVExpr *e, double *dst, int nb,
+                       const double *const_values,
+                       const double * const *const_arrays, void *opaque);
+
 /**
  * Track the presence of variables and their number of occurrences in a parsed expression
  *
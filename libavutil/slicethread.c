@@ -18,12 +18,31 @@
 
 #include <stdatomic.h>
 #include "slicethread.h"
+#include "threadpool.h"
 #include "mem.h"
 #include "thread.h"
 #include "avassert.h"
 
 #if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
 
+typedef struct ThreadPool {
+    pthread_mutex_t mutex;
+    pthread_cond_t  work_cond;
+    pthread_t       *threads;
+    int             nb_threads;
+    int             finished;
+
+    /* contexts waiting for more threads to join their jobs, served in turn */
+    AVSliceThread   *queue_head;
+    AVSliceThread   *queue_tail;
+
+    /* the global reference plus one per attached context */
+    int             refcount;
+} ThreadPool;
+
+static ThreadPool *shared_pool;
+static AVMutex shared_pool_mutex = AV_MUTEX_INITIALIZER;
+
 typedef struct WorkerContext {
     AVSliceThread   *ctx;
     pthread_mutex_t mutex;
@@ -48,8 +67,174 @@ struct AVSliceThread {
     void            *priv;
     void            (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads);
     void            (*main_func)(void *priv);
+
+    /* shared pool mode, all protected by pool->mutex */
+    ThreadPool      *pool;
+    AVSliceThread   *next_queued;
+    int             queued;
+    int             next_slot;
+    int             running;
 };
 
+static void pool_run_jobs(AVSliceThread *ctx, int slot)
+{
+    unsigned nb_jobs = ctx->nb_jobs;
+    unsigned jobnr;
+
+    while ((jobnr = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel)) < nb_jobs)
+        ctx->worker_func(ctx->priv, jobnr, slot, nb_jobs, ctx->nb_active_threads);
+}
+
+static void pool_dequeue(ThreadPool *pool, AVSliceThread *ctx)
+{
+    AVSliceThread **p = &pool->queue_head, *prev = NULL;
+
+    while (*p != ctx) {
+        prev = *p;
+        p    = &prev->next_queued;
+    }
+    *p = ctx->next_queued;
+    if (pool->queue_tail == ctx)
+        pool->queue_tail = prev;
+    ctx->next_queued = NULL;
+    ctx->queued      = 0;
+}
+
+static void pool_enqueue(ThreadPool *pool, AVSliceThread *ctx)
+{
+    if (pool->queue_tail)
+        pool->queue_tail->next_queued = ctx;
+    else
+        pool->queue_head = ctx;
+    pool->queue_tail = ctx;
+    ctx->queued = 1;
+}
+
+/* Reserve a thread index in ctx and move ctx behind the other waiting
+ * contexts, or out of the queue once all its thread indices are taken. */
+static int pool_claim_slot(ThreadPool *pool, AVSliceThread *ctx)
+{
+    int slot = ctx->next_slot++;
+
+    pool_dequeue(pool, ctx);
+    if (ctx->next_slot < ctx->nb_active_threads)
+        pool_enqueue(pool, ctx);
+    return slot;
+}
+
+static void *attribute_align_arg pool_worker(void *v)
+{
+    ThreadPool *pool = v;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        AVSliceThread *ctx;
+        int slot;
+
+        while (!pool->queue_head && !pool->finished)
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+        if (pool->finished)
+            break;
+
+        ctx  = pool->queue_head;
+        slot = pool_claim_slot(pool, ctx);
+        ctx->running++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        pool_run_jobs(ctx, slot);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (!--ctx->running)
+            pthread_cond_signal(&ctx->done_cond);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static void pool_free(ThreadPool *pool)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->finished = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    av_freep(&pool->threads);
+    av_freep(&pool);
+}
+
+static void pool_unref(ThreadPool *pool)
+{
+    int refcount;
+
+    ff_mutex_lock(&shared_pool_mutex);
+    refcount = --pool->refcount;
+    ff_mutex_unlock(&shared_pool_mutex);
+
+    if (!refcount)
+        pool_free(pool);
+}
+
+int av_thread_pool_init(int nb_threads)
+{
+    ThreadPool *pool, *old;
+    int i, ret;
+
+    if (nb_threads < 0)
+        return AVERROR(EINVAL);
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return AVERROR(ENOMEM);
+    pool->threads = av_calloc(nb_threads, sizeof(*pool->threads));
+    if (!pool->threads) {
+        av_freep(&pool);
+        return AVERROR(ENOMEM);
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pool->refcount = 1;
+
+    for (i = 0; i < nb_threads; i++) {
+        if (ret = pthread_create(&pool->threads[i], NULL, pool_worker, pool)) {
+            pool_free(pool);
+            return AVERROR(ret);
+        }
+        pool->nb_threads++;
+    }
+
+    ff_mutex_lock(&shared_pool_mutex);
+    old         = shared_pool;
+    shared_pool = pool;
+    ff_mutex_unlock(&shared_pool_mutex);
+
+    if (old)
+        pool_unref(old);
+    return 0;
+}
+
+void av_thread_pool_uninit(void)
+{
+    ThreadPool *pool;
+
+    ff_mutex_lock(&shared_pool_mutex);
+    pool        = shared_pool;
+    shared_pool = NULL;
+    ff_mutex_unlock(&shared_pool_mutex);
+
+    if (pool)
+        pool_unref(pool);
+}
+
 static int run_jobs(AVSliceThread *ctx)
 {
     unsigned nb_jobs    = ctx->nb_jobs;
@@ -108,14 +293,25 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
             nb_threads = 1;
     }
 
-    nb_workers = nb_threads;
-    if (!main_func)
-        nb_workers--;
-
     *pctx = ctx = av_mallocz(sizeof(*ctx));
     if (!ctx)
         return AVERROR(ENOMEM);
 
+    ff_mutex_lock(&shared_pool_mutex);
+    if (shared_pool) {
+        ctx->pool = shared_pool;
+        ctx->pool->refcount++;
+        /* the calling thread runs jobs alongside the pool threads */
+        nb_threads = FFMIN(nb_threads, ctx->pool->nb_threads + 1);
+    }
+    ff_mutex_unlock(&shared_pool_mutex);
+
+    nb_workers = nb_threads;
+    if (!main_func)
+        nb_workers--;
+    if (ctx->pool)
+        nb_workers = 0;
+
     if (nb_workers && !(ctx->workers = av_calloc(nb_workers, sizeof(*ctx->workers)))) {
         av_freep(pctx);
         return AVERROR(ENOMEM);
@@ -161,11 +357,57 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return nb_threads;
 }
 
+static void pool_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
+{
+    ThreadPool *pool = ctx->pool;
+    int run_main = ctx->main_func && execute_main;
+
+    ctx->nb_jobs           = nb_jobs;
+    ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
+    atomic_store_explicit(&ctx->current_job, 0, memory_order_relaxed);
+
+    pthread_mutex_lock(&pool->mutex);
+    /* thread index 0 is the calling thread's, unless it runs main_func */
+    ctx->next_slot = !run_main;
+    if (ctx->next_slot < ctx->nb_active_threads) {
+        pool_enqueue(pool, ctx);
+        pthread_cond_broadcast(&pool->work_cond);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (run_main)
+        ctx->main_func(ctx->priv);
+    else
+        pool_run_jobs(ctx, 0);
+
+    /* run what the pool threads did not get to, then wait for them */
+    pthread_mutex_lock(&pool->mutex);
+    while (ctx->queued) {
+        int slot;
+
+        if (atomic_load_explicit(&ctx->current_job, memory_order_relaxed) >= nb_jobs) {
+            pool_dequeue(pool, ctx);
+            break;
+        }
+        slot = pool_claim_slot(pool, ctx);
+        pthread_mutex_unlock(&pool->mutex);
+        pool_run_jobs(ctx, slot);
+        pthread_mutex_lock(&pool->mutex);
+    }
+    while (ctx->running)
+        pthread_cond_wait(&ctx->done_cond, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     int nb_workers, i, is_last = 0;
 
     av_assert0(nb_jobs > 0);
+    if (ctx->pool) {
+        pool_execute(ctx, nb_jobs, execute_main);
+        return;
+    }
     ctx->nb_jobs           = nb_jobs;
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
@@ -208,6 +450,8 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
     nb_workers = ctx->nb_threads;
     if (!ctx->main_func)
         nb_workers--;
+    if (ctx->pool)
+        nb_workers = 0;
 
     ctx->finished = 1;
     for (i = 0; i < nb_workers; i++) {
@@ -227,6 +471,8 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
 
     pthread_cond_destroy(&ctx->done_cond);
     pthread_mutex_destroy(&ctx->done_mutex);
+    if (ctx->pool)
+        pool_unref(ctx->pool);
     av_freep(&ctx->workers);
     av_freep(pctx);
 }
@@ -252,4 +498,13 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
     av_assert0(!pctx || !*pctx);
 }
 
+int av_thread_pool_init(int nb_threads)
+{
+    return AVERROR(ENOSYS);
+}
+
+void av_thread_pool_uninit(void)
+{
+}
+
 #endif /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS32THREADS */
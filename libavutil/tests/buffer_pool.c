@@ -0,0 +1,137 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program gets and releases pooled buffers from several threads
+ * and checks that no get allocates or fails while the pool holds free
+ * buffers.
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/thread.h"
+
+#define NB_THREADS 8
+#define NB_HELD    4
+#define NB_ITER    20000
+#define POOL_SIZE  (NB_THREADS * NB_HELD)
+
+static atomic_int nb_allocated;
+static int fixed_size;
+
+static AVBufferRef *alloc_buffer(int size)
+{
+    /* like the hwcontext pools, refuse to grow past the initial size */
+    if (atomic_fetch_add(&nb_allocated, 1) >= POOL_SIZE && fixed_size)
+        return NULL;
+    return av_buffer_alloc(size);
+}
+
+static void *thread_main(void *arg)
+{
+    AVBufferPool *pool = arg;
+    AVBufferRef *bufs[NB_HELD];
+    int i, j;
+
+    for (i = 0; i < NB_ITER; i++) {
+        int nb = 1 + i % NB_HELD;
+
+        for (j = 0; j < nb; j++) {
+            bufs[j] = av_buffer_pool_get(pool);
+            if (!bufs[j])
+                return (void *)1;
+            bufs[j]->data[0] = j;
+        }
+        for (j = 0; j < nb; j++)
+            av_buffer_unref(&bufs[j]);
+    }
+    return NULL;
+}
+
+static int run(int fixed)
+{
+    AVBufferPool *pool;
+    AVBufferRef *bufs[POOL_SIZE];
+    pthread_t threads[NB_THREADS];
+    uint64_t hits, misses;
+    void *res;
+    int i, ret, err = 0;
+
+    fixed_size = fixed;
+    atomic_store(&nb_allocated, 0);
+
+    pool = av_buffer_pool_init(64, alloc_buffer);
+    if (!pool)
+        return 1;
+
+    /* preallocate the whole pool, as fixed-size pools do */
+    for (i = 0; i < POOL_SIZE; i++)
+        if (!(bufs[i] = av_buffer_pool_get(pool)))
+            return 1;
+    for (i = 0; i < POOL_SIZE; i++)
+        av_buffer_unref(&bufs[i]);
+
+    for (i = 0; i < NB_THREADS; i++) {
+        if ((ret = pthread_create(&threads[i], NULL, thread_main, pool))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(ret));
+            return 1;
+        }
+    }
+    for (i = 0; i < NB_THREADS; i++) {
+        pthread_join(threads[i], &res);
+        if (res)
+            err = 2;
+    }
+
+    /* a get failing to grow a fixed-size pool is not a miss */
+    for (i = 0; i < POOL_SIZE; i++)
+        if (!(bufs[i] = av_buffer_pool_get(pool)))
+            return 1;
+    if (fixed) {
+        AVBufferRef *extra = av_buffer_pool_get(pool);
+        if (extra) {
+            fprintf(stderr, "fixed-size pool grew\n");
+            av_buffer_unref(&extra);
+            err = 4;
+        }
+    }
+    for (i = 0; i < POOL_SIZE; i++)
+        av_buffer_unref(&bufs[i]);
+
+    av_buffer_pool_get_stats(pool, &hits, &misses);
+    if (misses != POOL_SIZE) {
+        fprintf(stderr, "%"PRIu64" misses, %d expected\n", misses, POOL_SIZE);
+        err = 3;
+    }
+
+    av_buffer_pool_uninit(&pool);
+    return err;
+}
+
+int main(void)
+{
+    int ret;
+
+    if ((ret = run(0)))
+        return ret;
+    return run(1);
+}
@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "libavutil/common.h"
 #include "libavutil/libm.h"
 #include "libavutil/eval.h"
 
@@ -37,6 +38,45 @@ static const char *const const_names[] = {
     0
 };
 
+static const char *const batch_const_names[] = {
+    "X",
+    "Y",
+    0
+};
+
+/* compare av_expr_eval_batch() against av_expr_eval() on each element */
+static void test_batch(const char *s)
+{
+    double xs[77], res[77], values[2] = { 0, 13 };
+    const double *arrays[2] = { xs, NULL };
+    AVExpr *e = NULL, *e2 = NULL;
+    int i, same = 1;
+
+    if (av_expr_parse(&e,  s, batch_const_names, NULL, NULL, NULL, NULL, 0, NULL) < 0 ||
+        av_expr_parse(&e2, s, batch_const_names, NULL, NULL, NULL, NULL, 0, NULL) < 0) {
+        printf("'%s' batch: parse failed\n", s);
+        goto end;
+    }
+    for (i = 0; i < FF_ARRAY_ELEMS(xs); i++)
+        xs[i] = i - 20.5;
+    if (av_expr_eval_batch(e, res, FF_ARRAY_ELEMS(res), values, arrays, NULL) < 0) {
+        printf("'%s' batch: failed\n", s);
+        goto end;
+    }
+    for (i = 0; i < FF_ARRAY_ELEMS(xs); i++) {
+        double d;
+        values[0] = xs[i];
+        d = av_expr_eval(e2, values, NULL);
+        if (memcmp(&d, &res[i], sizeof(d)) && !(isnan(d) && isnan(res[i])))
+            same = 0;
+    }
+    printf("'%s' batch: %s, %f %f\n", s, same ? "same" : "differs",
+           res[0], res[FF_ARRAY_ELEMS(res) - 1]);
+end:
+    av_expr_free(e);
+    av_expr_free(e2);
+}
+
 int main(int argc, char **argv)
 {
     int i;
@@ -140,6 +180,23 @@ int main(int argc, char **argv)
         "clip(0, 0/0, 1)",
         NULL
     };
+    static const char *const batch_exprs[] = {
+        "X*2+Y",
+        "-X^2/3+sin(Y)",
+        "if(gt(X,0), X, -Y)",
+        "ifnot(lt(X,0), X) + if(X, 1)",
+        "clip(X, -3, Y)",
+        "between(X, -5, 5)*lerp(1, 2, 0.25)",
+        "mod(X, 3)+floor(X/2)+ceil(X/3)-trunc(X/4)+round(X/5)+sgn(X)",
+        "bitand(X+100, 7)+bitor(Y, 1)+gcd(X+100, 6)",
+        "max(X, Y)-min(X, -Y)+hypot(X, Y)+atan2(X, Y)",
+        "squish(X/10)+gauss(X/10)+isnan(sqrt(X))+not(X)+isinf(1/X)",
+        "eq(X, 0.5)+gte(X, 0.5)+lte(X, 0.5)+lt(X, 0.5)",
+        "2*PI*E+sqrt(16); pow(2, 0.5)",
+        "Y*3",
+        "st(0, ld(0)+X); ld(0)",
+        NULL
+    };
     int ret;
 
     for (expr = exprs; *expr; expr++) {
@@ -168,6 +225,9 @@ int main(int argc, char **argv)
     if (ret < 0)
         printf("av_expr_parse_and_eval failed\n");
 
+    for (expr = batch_exprs; *expr; expr++)
+        test_batch(*expr);
+
     if (argc > 1 && !strcmp(argv[1], "-t")) {
         for (i = 0; i < 1050; i++) {
             START_TIMER;
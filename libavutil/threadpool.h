@@ -0,0 +1,55 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+/**
+ * @file
+ * Process-wide worker thread pool for slice threading.
+ *
+ * By default every slice-threaded codec and filter graph starts its own
+ * worker threads. Once a pool is set up with av_thread_pool_init(), the
+ * slice threading contexts created afterwards start no threads of their
+ * own and run their jobs on the pool's threads instead, so that the total
+ * number of threads stays bounded however many codecs and filter graphs
+ * are open. Contexts with pending jobs are served in turn, one thread at a
+ * time, so a context with many jobs cannot starve the others. The thread
+ * calling into a codec or filter keeps running jobs of its own context, so
+ * work always progresses even when all pool threads are busy.
+ *
+ * Frame threading is not affected: frame threads wait on each other's
+ * progress and keep their own threads.
+ */
+
+/**
+ * Create the shared pool, replacing the current one if any. Contexts already
+ * attached to a previous pool keep using it until they are freed.
+ *
+ * @param nb_threads number of worker threads, 0 for the number of CPUs
+ * @return 0 on success, a negative AVERROR on failure
+ */
+int av_thread_pool_init(int nb_threads);
+
+/**
+ * Stop attaching new contexts to the shared pool. The pool threads exit once
+ * the last context attached to the pool is freed.
+ */
+void av_thread_pool_uninit(void);
+
+#endif /* AVUTIL_THREADPOOL_H */
@@ -0,0 +1,358 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Portable 128-bit vector helpers.
+ *
+ * The vector types are GCC/Clang generic vectors, so the code written
+ * against them compiles to WebAssembly SIMD128 instructions with Emscripten
+ * and to the host SIMD instructions in a native build, which is how the
+ * kernels are tested with checkasm. The few operations generic vectors
+ * cannot express efficiently use the WebAssembly intrinsics when available.
+ */
+
+#ifndef AVUTIL_WASM_UTIL_SIMD128_H
+#define AVUTIL_WASM_UTIL_SIMD128_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+
+#if HAVE_SIMD128
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+/***********************************************************************
+ * Vector types
+ **********************************************************************/
+typedef int8_t   vec_s8  __attribute__((vector_size(16)));
+typedef uint8_t  vec_u8  __attribute__((vector_size(16)));
+typedef int16_t  vec_s16 __attribute__((vector_size(16)));
+typedef uint16_t vec_u16 __attribute__((vector_size(16)));
+typedef int32_t  vec_s32 __attribute__((vector_size(16)));
+typedef uint32_t vec_u32 __attribute__((vector_size(16)));
+typedef int64_t  vec_s64 __attribute__((vector_size(16)));
+typedef float    vec_f32 __attribute__((vector_size(16)));
+
+/* half vectors, the narrow side of widening and narrowing conversions */
+typedef uint8_t  vec_u8h  __attribute__((vector_size(8)));
+typedef int16_t  vec_s16h __attribute__((vector_size(8)));
+
+#define vec_shuffle(a, b, ...) __builtin_shufflevector(a, b, __VA_ARGS__)
+#define vec_convert(a, type)   __builtin_convertvector(a, type)
+
+/***********************************************************************
+ * Loads and stores, no alignment required
+ **********************************************************************/
+static av_always_inline vec_u8 vec_ld_u8(const uint8_t *p)
+{
+    vec_u8 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/** Load 8 bytes into the low half. */
+static av_always_inline vec_u8 vec_ld8_u8(const uint8_t *p)
+{
+    vec_u8 v = { 0 };
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static av_always_inline vec_s16 vec_ld_s16(const int16_t *p)
+{
+    vec_s16 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static av_always_inline vec_s16h vec_ld_s16h(const int16_t *p)
+{
+    vec_s16h v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/** Load 8 pixels, zero-extended to 16 bits. */
+static av_always_inline vec_s16 vec_ld_u8_s16(const uint8_t *p)
+{
+    vec_u8h v;
+    memcpy(&v, p, sizeof(v));
+    return vec_convert(v, vec_s16);
+}
+
+/** Load 4 pixels, zero-extended to 16 bits, in the low half. */
+static av_always_inline vec_s16 vec_ld4_u8_s16(const uint8_t *p)
+{
+    vec_u8h v = { 0 };
+    memcpy(&v, p, 4);
+    return vec_convert(v, vec_s16);
+}
+
+static av_always_inline vec_f32 vec_ld_f32(const float *p)
+{
+    vec_f32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static av_always_inline void vec_st_u8(uint8_t *p, vec_u8 v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static av_always_inline void vec_st_s16(int16_t *p, vec_s16 v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static av_always_inline void vec_st_f32(float *p, vec_f32 v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/** Store the low 8 bytes. */
+static av_always_inline void vec_st8_u8(uint8_t *p, vec_u8 v)
+{
+    memcpy(p, &v, 8);
+}
+
+/** Store the low 4 bytes. */
+static av_always_inline void vec_st4_u8(uint8_t *p, vec_u8 v)
+{
+    memcpy(p, &v, 4);
+}
+
+static av_always_inline vec_u8 vec_splat_u8(int x)
+{
+    return (vec_u8){ 0 } + (uint8_t)x;
+}
+
+static av_always_inline vec_s16 vec_splat_s16(int x)
+{
+    return (vec_s16){ 0 } + (int16_t)x;
+}
+
+static av_always_inline vec_s32 vec_splat_s32(int x)
+{
+    return (vec_s32){ 0 } + x;
+}
+
+static av_always_inline vec_f32 vec_splat_f32(float x)
+{
+    return (vec_f32){ 0 } + x;
+}
+
+/***********************************************************************
+ * Arithmetic
+ **********************************************************************/
+/** Select the lanes of a where mask is set, those of b elsewhere. */
+#define vec_sel(mask, a, b) (((a) & (mask)) | ((b) & ~(mask)))
+
+static av_always_inline vec_s16 vec_min_s16(vec_s16 a, vec_s16 b)
+{
+#ifdef __wasm_simd128__
+    return (vec_s16)wasm_i16x8_min((v128_t)a, (v128_t)b);
+#else
+    return vec_sel(a < b, a, b);
+#endif
+}
+
+static av_always_inline vec_s16 vec_max_s16(vec_s16 a, vec_s16 b)
+{
+#ifdef __wasm_simd128__
+    return (vec_s16)wasm_i16x8_max((v128_t)a, (v128_t)b);
+#else
+    return vec_sel(a > b, a, b);
+#endif
+}
+
+static av_always_inline vec_s16 vec_clip_s16(vec_s16 a, vec_s16 lo, vec_s16 hi)
+{
+    return vec_min_s16(vec_max_s16(a, lo), hi);
+}
+
+static av_always_inline vec_s16 vec_abs_s16(vec_s16 a)
+{
+#ifdef __wasm_simd128__
+    return (vec_s16)wasm_i16x8_abs((v128_t)a);
+#else
+    vec_s16 sign = a >> 15;
+    return (a ^ sign) - sign;
+#endif
+}
+
+/** Rounding average, (a + b + 1) >> 1. */
+static av_always_inline vec_u8 vec_avg_u8(vec_u8 a, vec_u8 b)
+{
+#ifdef __wasm_simd128__
+    return (vec_u8)wasm_u8x16_avgr((v128_t)a, (v128_t)b);
+#else
+    return (a | b) - ((a ^ b) >> 1);
+#endif
+}
+
+/***********************************************************************
+ * Widening and narrowing
+ **********************************************************************/
+static av_always_inline vec_s16 vec_lo_u8_s16(vec_u8 a)
+{
+    return vec_convert(vec_shuffle(a, a, 0, 1, 2, 3, 4, 5, 6, 7), vec_s16);
+}
+
+static av_always_inline vec_s16 vec_hi_u8_s16(vec_u8 a)
+{
+    return vec_convert(vec_shuffle(a, a, 8, 9, 10, 11, 12, 13, 14, 15), vec_s16);
+}
+
+static av_always_inline vec_s32 vec_lo_s16_s32(vec_s16 a)
+{
+    return vec_convert(vec_shuffle(a, a, 0, 1, 2, 3), vec_s32);
+}
+
+static av_always_inline vec_s32 vec_hi_s16_s32(vec_s16 a)
+{
+    return vec_convert(vec_shuffle(a, a, 4, 5, 6, 7), vec_s32);
+}
+
+/** Narrow to unsigned 8 bits with saturation, a in the low half. */
+static av_always_inline vec_u8 vec_packus_s16(vec_s16 a, vec_s16 b)
+{
+#ifdef __wasm_simd128__
+    return (vec_u8)wasm_u8x16_narrow_i16x8((v128_t)a, (v128_t)b);
+#else
+    const vec_s16 zero = { 0 }, max = zero + 255;
+    vec_u8h lo = vec_convert(vec_clip_s16(a, zero, max), vec_u8h);
+    vec_u8h hi = vec_convert(vec_clip_s16(b, zero, max), vec_u8h);
+    return vec_shuffle(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+#endif
+}
+
+/** Narrow to signed 16 bits with saturation, a in the low half. */
+static av_always_inline vec_s16 vec_packs_s32(vec_s32 a, vec_s32 b)
+{
+#ifdef __wasm_simd128__
+    return (vec_s16)wasm_i16x8_narrow_i32x4((v128_t)a, (v128_t)b);
+#else
+    const vec_s32 min = vec_splat_s32(INT16_MIN), max = vec_splat_s32(INT16_MAX);
+    a = vec_sel(a < min, min, a);
+    a = vec_sel(a > max, max, a);
+    b = vec_sel(b < min, min, b);
+    b = vec_sel(b > max, max, b);
+    return vec_convert(vec_shuffle(a, b, 0, 1, 2, 3, 4, 5, 6, 7), vec_s16);
+#endif
+}
+
+/***********************************************************************
+ * Interleaving, as the building blocks of transposes
+ **********************************************************************/
+static av_always_inline vec_u8 vec_mergel_u8(vec_u8 a, vec_u8 b)
+{
+    return vec_shuffle(a, b, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+}
+
+static av_always_inline vec_u8 vec_mergeh_u8(vec_u8 a, vec_u8 b)
+{
+    return vec_shuffle(a, b, 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+}
+
+static av_always_inline vec_s16 vec_mergel_s16(vec_s16 a, vec_s16 b)
+{
+    return vec_shuffle(a, b, 0, 8, 1, 9, 2, 10, 3, 11);
+}
+
+static av_always_inline vec_s16 vec_mergeh_s16(vec_s16 a, vec_s16 b)
+{
+    return vec_shuffle(a, b, 4, 12, 5, 13, 6, 14, 7, 15);
+}
+
+static av_always_inline vec_s32 vec_mergel_s32(vec_s32 a, vec_s32 b)
+{
+    return vec_shuffle(a, b, 0, 4, 1, 5);
+}
+
+static av_always_inline vec_s32 vec_mergeh_s32(vec_s32 a, vec_s32 b)
+{
+    return vec_shuffle(a, b, 2, 6, 3, 7);
+}
+
+static av_always_inline vec_s64 vec_mergel_s64(vec_s64 a, vec_s64 b)
+{
+    return vec_shuffle(a, b, 0, 2);
+}
+
+static av_always_inline vec_s64 vec_mergeh_s64(vec_s64 a, vec_s64 b)
+{
+    return vec_shuffle(a, b, 1, 3);
+}
+
+/**
+ * Transpose an 8x8 matrix of 16-bit elements held in 8 vectors.
+ */
+#define VEC_TRANSPOSE8_S16(a0, a1, a2, a3, a4, a5, a6, a7)                  \
+    do {                                                                    \
+        vec_s32 t0 = (vec_s32)vec_mergel_s16(a0, a1);                       \
+        vec_s32 t1 = (vec_s32)vec_mergeh_s16(a0, a1);                       \
+        vec_s32 t2 = (vec_s32)vec_mergel_s16(a2, a3);                       \
+        vec_s32 t3 = (vec_s32)vec_mergeh_s16(a2, a3);                       \
+        vec_s32 t4 = (vec_s32)vec_mergel_s16(a4, a5);                       \
+        vec_s32 t5 = (vec_s32)vec_mergeh_s16(a4, a5);                       \
+        vec_s32 t6 = (vec_s32)vec_mergel_s16(a6, a7);                       \
+        vec_s32 t7 = (vec_s32)vec_mergeh_s16(a6, a7);                       \
+        vec_s64 u0 = (vec_s64)vec_mergel_s32(t0, t2);                       \
+        vec_s64 u1 = (vec_s64)vec_mergeh_s32(t0, t2);                       \
+        vec_s64 u2 = (vec_s64)vec_mergel_s32(t1, t3);                       \
+        vec_s64 u3 = (vec_s64)vec_mergeh_s32(t1, t3);                       \
+        vec_s64 u4 = (vec_s64)vec_mergel_s32(t4, t6);                       \
+        vec_s64 u5 = (vec_s64)vec_mergeh_s32(t4, t6);                       \
+        vec_s64 u6 = (vec_s64)vec_mergel_s32(t5, t7);                       \
+        vec_s64 u7 = (vec_s64)vec_mergeh_s32(t5, t7);                       \
+        a0 = (vec_s16)vec_mergel_s64(u0, u4);                               \
+        a1 = (vec_s16)vec_mergeh_s64(u0, u4);                               \
+        a2 = (vec_s16)vec_mergel_s64(u1, u5);                               \
+        a3 = (vec_s16)vec_mergeh_s64(u1, u5);                               \
+        a4 = (vec_s16)vec_mergel_s64(u2, u6);                               \
+        a5 = (vec_s16)vec_mergeh_s64(u2, u6);                               \
+        a6 = (vec_s16)vec_mergel_s64(u3, u7);                               \
+        a7 = (vec_s16)vec_mergeh_s64(u3, u7);                               \
+    } while (0)
+
+/**
+ * Transpose a 4x4 matrix of 32-bit elements held in 4 vectors.
+ */
+#define VEC_TRANSPOSE4_S32(a0, a1, a2, a3)                                  \
+    do {                                                                    \
+        vec_s64 t0 = (vec_s64)vec_mergel_s32(a0, a1);                       \
+        vec_s64 t1 = (vec_s64)vec_mergeh_s32(a0, a1);                       \
+        vec_s64 t2 = (vec_s64)vec_mergel_s32(a2, a3);                       \
+        vec_s64 t3 = (vec_s64)vec_mergeh_s32(a2, a3);                       \
+        a0 = (vec_s32)vec_mergel_s64(t0, t2);                               \
+        a1 = (vec_s32)vec_mergeh_s64(t0, t2);                               \
+        a2 = (vec_s32)vec_mergel_s64(t1, t3);                               \
+        a3 = (vec_s32)vec_mergeh_s64(t1, t3);                               \
+    } while (0)
+
+#endif /* HAVE_SIMD128 */
+
+#endif /* AVUTIL_WASM_UTIL_SIMD128_H */
@@ -242,6 +242,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
      * and faster */
     const int dstW                   = c->dstW;
     const int dstH                   = c->dstH;
+    const int dstEnd                 = c->dst_slice_end ? c->dst_slice_end : dstH;
 
     const enum AVPixelFormat dstFormat = c->dstFormat;
     const int flags                  = c->flags;
@@ -334,7 +335,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
      * will not get executed. This is not really intended but works
      * currently, so people might do it. */
     if (srcSliceY == 0) {
-        dstY         = 0;
+        dstY         = c->dst_slice_start;
         lastInLumBuf = -1;
         lastInChrBuf = -1;
     }
@@ -366,7 +367,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         hout_slice->width = dstW;
     }
 
-    for (; dstY < dstH; dstY++) {
+    for (; dstY < dstEnd; dstY++) {
         const int chrDstY = dstY >> c->chrDstVSubSample;
         int use_mmx_vfilter= c->use_mmx_vfilter;
 
@@ -592,6 +593,8 @@ SwsFunc ff_getSwsFunc(SwsContext *c)
         ff_sws_init_swscale_aarch64(c);
     if (ARCH_ARM)
         ff_sws_init_swscale_arm(c);
+    if (ARCH_WASM)
+        ff_sws_init_swscale_wasm(c);
 
     return swscale;
 }
@@ -982,3 +985,52 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
     av_free(rgb0_tmp);
     return ret;
 }
+
+int sws_scale_dst_slice(struct SwsContext *c, const uint8_t *const src[],
+                        const int srcStride[], uint8_t *const dst[],
+                        const int dstStride[], int dstSliceY, int dstSliceH)
+{
+    const uint8_t *src2[4];
+    int i, ret;
+
+    if (!src || !srcStride || !dst || !dstStride)
+        return AVERROR(EINVAL);
+
+    if (dstSliceY < 0 || dstSliceH <= 0 || dstSliceY + dstSliceH > c->dstH ||
+        (dstSliceY & 15) ||
+        ((dstSliceH & 15) && dstSliceY + dstSliceH != c->dstH)) {
+        av_log(c, AV_LOG_ERROR, "Slice parameters %d, %d are invalid\n",
+               dstSliceY, dstSliceH);
+        return AVERROR(EINVAL);
+    }
+
+    /* Error diffusion carries state from one output line to the next and
+     * the cascaded and XYZ paths keep whole-picture intermediates. */
+    if (c->cascaded_context[0] || c->srcXYZ || c->dstXYZ ||
+        isBayer(c->srcFormat) || c->dither == SWS_DITHER_ED)
+        return AVERROR(ENOSYS);
+
+    if (c->swscale == swscale) {
+        c->dst_slice_start = dstSliceY;
+        c->dst_slice_end   = dstSliceY + dstSliceH;
+        ret = sws_scale(c, src, srcStride, 0, c->srcH, dst, dstStride);
+        c->dst_slice_start = 0;
+        c->dst_slice_end   = 0;
+        return ret;
+    }
+
+    if (!ff_sws_unscaled_slice_independent(c))
+        return AVERROR(ENOSYS);
+
+    /* unscaled converters map source rows to the same destination rows */
+    for (i = 0; i < 4; i++) {
+        int y = (i == 1 || i == 2) ? dstSliceY >> c->chrSrcVSubSample : dstSliceY;
+        src2[i] = src[i];
+        if (src[i] && !(i == 1 && usePal(c->srcFormat)))
+            src2[i] += y * srcStride[i];
+    }
+    c->sliceDir = 1;
+    ret = sws_scale(c, src2, srcStride, dstSliceY, dstSliceH, dst, dstStride);
+    c->sliceDir = 0;
+    return ret;
+}
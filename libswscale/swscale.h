@@ -218,6 +218,40 @@ int sws_scale(struct SwsContext *c, const uint8_t *const srcSlice[],
               const int srcStride[], int srcSliceY, int srcSliceH,
               uint8_t *const dst[], const int dstStride[]);
 
+/**
+ * Scale the whole source image in src and put only the rows
+ * [dstSliceY, dstSliceY + dstSliceH) of the result in dst.
+ *
+ * The output is identical to the corresponding rows of a single
+ * sws_scale() call over the whole picture, so several contexts created
+ * with the same parameters can produce disjoint slices of one picture
+ * in parallel. A context must not be used for slice-based sws_scale()
+ * calls at the same time.
+ *
+ * @param c          the scaling context previously created with
+ *                   sws_getContext()
+ * @param src        the array containing the pointers to the planes of
+ *                   the whole source image
+ * @param srcStride  the array containing the strides for each plane of
+ *                   the source image
+ * @param dst        the array containing the pointers to the planes of
+ *                   the whole destination image
+ * @param dstStride  the array containing the strides for each plane of
+ *                   the destination image
+ * @param dstSliceY  the first destination row to output, must be a
+ *                   multiple of 16
+ * @param dstSliceH  the number of destination rows to output, must be a
+ *                   multiple of 16 unless the slice ends at the bottom
+ *                   of the image
+ * @return           the number of rows output on success,
+ *                   AVERROR(ENOSYS) if the conversion cannot be split in
+ *                   independent slices (e.g. error diffusion dithering),
+ *                   another negative error code on failure
+ */
+int sws_scale_dst_slice(struct SwsContext *c, const uint8_t *const src[],
+                        const int srcStride[], uint8_t *const dst[],
+                        const int dstStride[], int dstSliceY, int dstSliceH);
+
 /**
  * @param dstRange flag indicating the while-black range of the output (1=jpeg / 0=mpeg)
  * @param srcRange flag indicating the while-black range of the input (1=jpeg / 0=mpeg)
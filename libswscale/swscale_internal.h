@@ -392,6 +392,8 @@ typedef struct SwsContext {
     int warned_unuseable_bilinear;
 
     int dstY;                     ///< Last destination vertical line output from last slice.
+    int dst_slice_start;          ///< First destination line to output, set by sws_scale_dst_slice().
+    int dst_slice_end;            ///< Destination line to stop at, 0 for the whole picture.
     int flags;                    ///< Flags passed by the user to select scaler algorithm, optimizations, subsampling, etc...
     void *yuvTable;             // pointer to the yuv->rgb table start so it can be freed()
     // alignment ensures the offset can be added in a single
@@ -856,6 +858,12 @@ void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
 void ff_get_unscaled_swscale_aarch64(SwsContext *c);
 
+/**
+ * @return 1 if the unscaled converter of c produces the same output rows
+ *         whatever the slices it is called with, 0 otherwise
+ */
+int ff_sws_unscaled_slice_independent(SwsContext *c);
+
 /**
  * Return function pointer to fastest main scaler path function depending
  * on architecture and available optimizations.
@@ -876,6 +884,7 @@ void ff_sws_init_swscale_vsx(SwsContext *c);
 void ff_sws_init_swscale_x86(SwsContext *c);
 void ff_sws_init_swscale_aarch64(SwsContext *c);
 void ff_sws_init_swscale_arm(SwsContext *c);
+void ff_sws_init_swscale_wasm(SwsContext *c);
 
 void ff_hyscale_fast_c(SwsContext *c, int16_t *dst, int dstWidth,
                        const uint8_t *src, int srcW, int xInc);
@@ -2178,6 +2178,13 @@ void ff_get_unscaled_swscale(SwsContext *c)
         ff_get_unscaled_swscale_aarch64(c);
 }
 
+int ff_sws_unscaled_slice_independent(SwsContext *c)
+{
+    /* these interpolate across rows or finish the last rows of a call in C */
+    return c->swscale != yvu9ToYv12Wrapper &&
+           c->swscale != bgr24ToYv12Wrapper;
+}
+
 /* Convert the palette to the same packed 32-bit format as the palette */
 void sws_convertPalette8ToPacked32(const uint8_t *src, uint8_t *dst,
                                    int num_pixels, const uint8_t *palette)
@@ -0,0 +1,85 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/wasm/util_simd128.h"
+#include "swscale_wasm.h"
+
+/* products of 4 taps of the filter, filterSize must be a multiple of 4 */
+static av_always_inline vec_s32 hscale_dot(const uint8_t *src, const int16_t *filter,
+                                           int filterSize)
+{
+    vec_s32 acc = vec_splat_s32(0);
+
+    for (int j = 0; j < filterSize; j += 4) {
+        vec_s32 f = vec_convert(vec_ld_s16h(filter + j), vec_s32);
+        acc += vec_lo_s16_s32(vec_ld4_u8_s16(src + j)) * f;
+    }
+    return acc;
+}
+
+static av_always_inline void hscale_8(int16_t *_dst, int dstW, const uint8_t *src,
+                                      const int16_t *filter, const int32_t *filterPos,
+                                      int filterSize, int shift, int max, int dst32)
+{
+    const vec_s32 maxv = vec_splat_s32(max);
+    int i;
+
+    for (i = 0; i + 3 < dstW; i += 4) {
+        vec_s32 a0 = hscale_dot(src + filterPos[i    ], filter + filterSize *  i,      filterSize);
+        vec_s32 a1 = hscale_dot(src + filterPos[i + 1], filter + filterSize * (i + 1), filterSize);
+        vec_s32 a2 = hscale_dot(src + filterPos[i + 2], filter + filterSize * (i + 2), filterSize);
+        vec_s32 a3 = hscale_dot(src + filterPos[i + 3], filter + filterSize * (i + 3), filterSize);
+        vec_s32 sum;
+
+        VEC_TRANSPOSE4_S32(a0, a1, a2, a3);
+        sum = (a0 + a1 + a2 + a3) >> shift;
+        sum = vec_sel(sum > maxv, maxv, sum);
+
+        if (dst32) {
+            memcpy((int32_t *)_dst + i, &sum, sizeof(sum));
+        } else {
+            vec_s16h d = vec_convert(sum, vec_s16h);
+            memcpy(_dst + i, &d, sizeof(d));
+        }
+    }
+    for (; i < dstW; i++) {
+        vec_s32 a = hscale_dot(src + filterPos[i], filter + filterSize * i, filterSize);
+        int val = FFMIN((a[0] + a[1] + a[2] + a[3]) >> shift, max);
+
+        if (dst32)
+            ((int32_t *)_dst)[i] = val;
+        else
+            _dst[i] = val;
+    }
+}
+
+void ff_hscale_8_to_15_simd128(struct SwsContext *c, int16_t *dst, int dstW,
+                               const uint8_t *src, const int16_t *filter,
+                               const int32_t *filterPos, int filterSize)
+{
+    hscale_8(dst, dstW, src, filter, filterPos, filterSize, 7, (1 << 15) - 1, 0);
+}
+
+void ff_hscale_8_to_19_simd128(struct SwsContext *c, int16_t *dst, int dstW,
+                               const uint8_t *src, const int16_t *filter,
+                               const int32_t *filterPos, int filterSize)
+{
+    hscale_8(dst, dstW, src, filter, filterPos, filterSize, 3, (1 << 19) - 1, 1);
+}
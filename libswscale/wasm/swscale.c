@@ -0,0 +1,43 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+#include "libavutil/attributes.h"
+#include "libavutil/wasm/cpu.h"
+#include "swscale_wasm.h"
+
+av_cold void ff_sws_init_swscale_wasm(SwsContext *c)
+{
+#if HAVE_SIMD128
+    int cpu_flags = av_get_cpu_flags();
+
+    if (have_simd128(cpu_flags) && c->srcBpc == 8) {
+        void (*hscale)(SwsContext *c, int16_t *dst, int dstW,
+                       const uint8_t *src, const int16_t *filter,
+                       const int32_t *filterPos, int filterSize) =
+            c->dstBpc <= 14 ? ff_hscale_8_to_15_simd128 : ff_hscale_8_to_19_simd128;
+
+        if (!(c->hLumFilterSize % 4))
+            c->hyScale = hscale;
+        if (!(c->hChrFilterSize % 4))
+            c->hcScale = hscale;
+    }
+#endif /* HAVE_SIMD128 */
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef SWSCALE_WASM_SWSCALE_WASM_H
+#define SWSCALE_WASM_SWSCALE_WASM_H
+
+#include <stdint.h>
+
+struct SwsContext;
+
+void ff_hscale_8_to_15_simd128(struct SwsContext *c, int16_t *dst, int dstW,
+                               const uint8_t *src, const int16_t *filter,
+                               const int32_t *filterPos, int filterSize);
+void ff_hscale_8_to_19_simd128(struct SwsContext *c, int16_t *dst, int dstW,
+                               const uint8_t *src, const int16_t *filter,
+                               const int32_t *filterPos, int filterSize);
+
+#endif /* SWSCALE_WASM_SWSCALE_WASM_H */
@@ -0,0 +1,156 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define BLOCK        24
+#define STRIDE       (BLOCK * 2)
+#define BUF_SIZE     (STRIDE * BLOCK)
+#define EDGE         8
+#define ITERATIONS   16
+
+/*
+ * Fill the block with a flat area on each side of the edge plus a little
+ * noise, so that the strong, normal and skipped cases are all reached
+ * depending on the random step, noise and filter parameters.
+ */
+static void fill_block(uint8_t *buf0, uint8_t *buf1, int bit_depth,
+                       int horizontal, int tc)
+{
+    int max   = (1 << bit_depth) - 1;
+    int shift = bit_depth - 8;
+    int base  = rnd() % 256;
+    int step  = ((int)(rnd() % (4 * tc + 3)) - 2 * tc - 1);
+    int noise = rnd() % 4;
+    int x, y;
+
+    for (y = 0; y < BLOCK; y++) {
+        for (x = 0; x < BLOCK; x++) {
+            int across = horizontal ? y : x;
+            int v = base + (across >= EDGE ? step : 0);
+
+            if (noise)
+                v += (int)(rnd() % (2 * noise + 1)) - noise;
+            v = av_clip(v << shift, 0, max);
+            if (bit_depth == 8) {
+                buf0[y * STRIDE + x] = buf1[y * STRIDE + x] = v;
+            } else {
+                AV_WN16A(buf0 + y * STRIDE + 2 * x, v);
+                AV_WN16A(buf1 + y * STRIDE + 2 * x, v);
+            }
+        }
+    }
+}
+
+static void check_deblock_luma(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    int offset = EDGE * STRIDE + EDGE * SIZEOF_PIXEL;
+    int dir, i;
+
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int beta, int32_t *tc,
+                 uint8_t *no_p, uint8_t *no_q);
+
+    memset(buf0, 0, BUF_SIZE);
+    memset(buf1, 0, BUF_SIZE);
+
+    for (dir = 0; dir < 2; dir++) {
+        if (!check_func(dir ? h->hevc_v_loop_filter_luma : h->hevc_h_loop_filter_luma,
+                        "hevc_%s_loop_filter_luma_%d", dir ? "v" : "h", bit_depth))
+            continue;
+
+        for (i = 0; i < ITERATIONS; i++) {
+            int32_t tc[2]  = { rnd() % 25, rnd() % 25 };
+            uint8_t no_p[2] = { !(rnd() % 4), !(rnd() % 4) };
+            uint8_t no_q[2] = { !(rnd() % 4), !(rnd() % 4) };
+            int beta = rnd() % 65;
+
+            fill_block(buf0, buf1, bit_depth, !dir, FFMAX(tc[0], tc[1]));
+            call_ref(buf0 + offset, STRIDE, beta, tc, no_p, no_q);
+            call_new(buf1 + offset, STRIDE, beta, tc, no_p, no_q);
+            if (memcmp(buf0, buf1, BUF_SIZE))
+                fail();
+        }
+        bench_new(buf1 + offset, STRIDE, 64, (int32_t[2]){ 24, 24 },
+                  (uint8_t[2]){ 0, 0 }, (uint8_t[2]){ 0, 0 });
+    }
+}
+
+static void check_deblock_chroma(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    int offset = EDGE * STRIDE + EDGE * SIZEOF_PIXEL;
+    int dir, i;
+
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int32_t *tc,
+                 uint8_t *no_p, uint8_t *no_q);
+
+    memset(buf0, 0, BUF_SIZE);
+    memset(buf1, 0, BUF_SIZE);
+
+    for (dir = 0; dir < 2; dir++) {
+        if (!check_func(dir ? h->hevc_v_loop_filter_chroma : h->hevc_h_loop_filter_chroma,
+                        "hevc_%s_loop_filter_chroma_%d", dir ? "v" : "h", bit_depth))
+            continue;
+
+        for (i = 0; i < ITERATIONS; i++) {
+            int32_t tc[2]  = { rnd() % 25, rnd() % 25 };
+            uint8_t no_p[2] = { !(rnd() % 4), !(rnd() % 4) };
+            uint8_t no_q[2] = { !(rnd() % 4), !(rnd() % 4) };
+
+            fill_block(buf0, buf1, bit_depth, !dir, FFMAX(tc[0], tc[1]));
+            call_ref(buf0 + offset, STRIDE, tc, no_p, no_q);
+            call_new(buf1 + offset, STRIDE, tc, no_p, no_q);
+            if (memcmp(buf0, buf1, BUF_SIZE))
+                fail();
+        }
+        bench_new(buf1 + offset, STRIDE, (int32_t[2]){ 24, 24 },
+                  (uint8_t[2]){ 0, 0 }, (uint8_t[2]){ 0, 0 });
+    }
+}
+
+void checkasm_check_hevc_deblock(void)
+{
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_deblock_luma(&h, bit_depth);
+    }
+    report("luma");
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_deblock_chroma(&h, bit_depth);
+    }
+    report("chroma");
+}
@@ -0,0 +1,311 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+static const uint32_t pixel_mask[3] = { 0xffffffff, 0x03ff03ff, 0x0fff0fff };
+static const int sizes[10] = { 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define SRC_STRIDE   (MAX_PB_SIZE + 16)
+#define SRC_OFFSET   ((3 * SRC_STRIDE + 4) * SIZEOF_PIXEL)
+#define SRC_SIZE     (SRC_STRIDE * (MAX_PB_SIZE + 8) * 2)
+#define DST_SIZE     (MAX_PB_SIZE * MAX_PB_SIZE * 2)
+
+#define randomize_buffers(buf0, buf1, size)                 \
+    do {                                                    \
+        uint32_t mask = pixel_mask[(bit_depth - 8) >> 1];   \
+        int k;                                              \
+        for (k = 0; k < size; k += 4) {                     \
+            uint32_t r = rnd() & mask;                      \
+            AV_WN32A(buf0 + k, r);                          \
+            AV_WN32A(buf1 + k, r);                          \
+        }                                                   \
+    } while (0)
+
+/* intermediate samples as produced by the put functions */
+#define randomize_src2(buf, size)                           \
+    do {                                                    \
+        int k;                                              \
+        for (k = 0; k < size; k++)                          \
+            buf[k] = (int)(rnd() & 0x7fff) - 8192;          \
+    } while (0)
+
+typedef struct PelTables {
+    const char *name;
+    int max_frac;
+    void (*(*put)[2][2])(int16_t *dst, uint8_t *src, ptrdiff_t srcstride,
+                         int height, intptr_t mx, intptr_t my, int width);
+    void (*(*uni)[2][2])(uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                         ptrdiff_t srcstride, int height,
+                         intptr_t mx, intptr_t my, int width);
+    void (*(*uni_w)[2][2])(uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                           ptrdiff_t srcstride, int height, int denom,
+                           int wx, int ox, intptr_t mx, intptr_t my, int width);
+    void (*(*bi)[2][2])(uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                        ptrdiff_t srcstride, int16_t *src2, int height,
+                        intptr_t mx, intptr_t my, int width);
+    void (*(*bi_w)[2][2])(uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                          ptrdiff_t srcstride, int16_t *src2, int height,
+                          int denom, int wx0, int wx1, int ox0, int ox1,
+                          intptr_t mx, intptr_t my, int width);
+} PelTables;
+
+static const char *const dir_names[2][2] = { { "pixels", "h" }, { "v", "hv" } };
+
+static void check_put(const PelTables *t, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, dst0, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, dst1, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    ptrdiff_t srcstride = SRC_STRIDE * SIZEOF_PIXEL;
+    int i, j, k;
+
+    declare_func(void, int16_t *dst, uint8_t *src, ptrdiff_t srcstride,
+                 int height, intptr_t mx, intptr_t my, int width);
+
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < 2; k++) {
+                int size = sizes[i];
+                intptr_t mx = 1 + rnd() % t->max_frac;
+                intptr_t my = 1 + rnd() % t->max_frac;
+
+                if (!check_func(t->put[i][j][k], "put_hevc_%s_%s%d_%d",
+                                t->name, dir_names[j][k], size, bit_depth))
+                    continue;
+
+                randomize_buffers(src0, src1, SRC_SIZE);
+                memset(dst0, 0, DST_SIZE);
+                memset(dst1, 0, DST_SIZE);
+                call_ref(dst0, src0 + SRC_OFFSET, srcstride, size, mx, my, size);
+                call_new(dst1, src1 + SRC_OFFSET, srcstride, size, mx, my, size);
+                if (memcmp(dst0, dst1, DST_SIZE))
+                    fail();
+                bench_new(dst1, src1 + SRC_OFFSET, srcstride, size, mx, my, size);
+            }
+        }
+    }
+}
+
+static void check_uni(const PelTables *t, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE]);
+    ptrdiff_t srcstride = SRC_STRIDE * SIZEOF_PIXEL;
+    ptrdiff_t dststride = MAX_PB_SIZE * SIZEOF_PIXEL;
+    int i, j, k;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                 ptrdiff_t srcstride, int height,
+                 intptr_t mx, intptr_t my, int width);
+
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < 2; k++) {
+                int size = sizes[i];
+                intptr_t mx = 1 + rnd() % t->max_frac;
+                intptr_t my = 1 + rnd() % t->max_frac;
+
+                if (!check_func(t->uni[i][j][k], "put_hevc_%s_uni_%s%d_%d",
+                                t->name, dir_names[j][k], size, bit_depth))
+                    continue;
+
+                randomize_buffers(src0, src1, SRC_SIZE);
+                memset(dst0, 0, DST_SIZE);
+                memset(dst1, 0, DST_SIZE);
+                call_ref(dst0, dststride, src0 + SRC_OFFSET, srcstride, size, mx, my, size);
+                call_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, size, mx, my, size);
+                if (memcmp(dst0, dst1, DST_SIZE))
+                    fail();
+                bench_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, size, mx, my, size);
+            }
+        }
+    }
+}
+
+static void check_uni_w(const PelTables *t, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE]);
+    ptrdiff_t srcstride = SRC_STRIDE * SIZEOF_PIXEL;
+    ptrdiff_t dststride = MAX_PB_SIZE * SIZEOF_PIXEL;
+    int i, j, k;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                 ptrdiff_t srcstride, int height, int denom,
+                 int wx, int ox, intptr_t mx, intptr_t my, int width);
+
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < 2; k++) {
+                int size = sizes[i];
+                intptr_t mx = 1 + rnd() % t->max_frac;
+                intptr_t my = 1 + rnd() % t->max_frac;
+                int denom = rnd() % 8;
+                int wx = (1 << denom) + (int)(rnd() % 256) - 128;
+                int ox = (int)(rnd() % 256) - 128;
+
+                if (!check_func(t->uni_w[i][j][k], "put_hevc_%s_uni_w_%s%d_%d",
+                                t->name, dir_names[j][k], size, bit_depth))
+                    continue;
+
+                randomize_buffers(src0, src1, SRC_SIZE);
+                memset(dst0, 0, DST_SIZE);
+                memset(dst1, 0, DST_SIZE);
+                call_ref(dst0, dststride, src0 + SRC_OFFSET, srcstride, size,
+                         denom, wx, ox, mx, my, size);
+                call_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, size,
+                         denom, wx, ox, mx, my, size);
+                if (memcmp(dst0, dst1, DST_SIZE))
+                    fail();
+                bench_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, size,
+                          denom, wx, ox, mx, my, size);
+            }
+        }
+    }
+}
+
+static void check_bi(const PelTables *t, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE]);
+    ptrdiff_t srcstride = SRC_STRIDE * SIZEOF_PIXEL;
+    ptrdiff_t dststride = MAX_PB_SIZE * SIZEOF_PIXEL;
+    int i, j, k;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                 ptrdiff_t srcstride, int16_t *src2, int height,
+                 intptr_t mx, intptr_t my, int width);
+
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < 2; k++) {
+                int size = sizes[i];
+                intptr_t mx = 1 + rnd() % t->max_frac;
+                intptr_t my = 1 + rnd() % t->max_frac;
+
+                if (!check_func(t->bi[i][j][k], "put_hevc_%s_bi_%s%d_%d",
+                                t->name, dir_names[j][k], size, bit_depth))
+                    continue;
+
+                randomize_buffers(src0, src1, SRC_SIZE);
+                randomize_src2(src2, MAX_PB_SIZE * MAX_PB_SIZE);
+                memset(dst0, 0, DST_SIZE);
+                memset(dst1, 0, DST_SIZE);
+                call_ref(dst0, dststride, src0 + SRC_OFFSET, srcstride, src2, size, mx, my, size);
+                call_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, src2, size, mx, my, size);
+                if (memcmp(dst0, dst1, DST_SIZE))
+                    fail();
+                bench_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, src2, size, mx, my, size);
+            }
+        }
+    }
+}
+
+static void check_bi_w(const PelTables *t, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [SRC_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE]);
+    ptrdiff_t srcstride = SRC_STRIDE * SIZEOF_PIXEL;
+    ptrdiff_t dststride = MAX_PB_SIZE * SIZEOF_PIXEL;
+    int i, j, k;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                 ptrdiff_t srcstride, int16_t *src2, int height,
+                 int denom, int wx0, int wx1, int ox0, int ox1,
+                 intptr_t mx, intptr_t my, int width);
+
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < 2; k++) {
+                int size = sizes[i];
+                intptr_t mx = 1 + rnd() % t->max_frac;
+                intptr_t my = 1 + rnd() % t->max_frac;
+                int denom = rnd() % 8;
+                int wx0 = (1 << denom) + (int)(rnd() % 256) - 128;
+                int wx1 = (1 << denom) + (int)(rnd() % 256) - 128;
+                int ox0 = (int)(rnd() % 256) - 128;
+                int ox1 = (int)(rnd() % 256) - 128;
+
+                if (!check_func(t->bi_w[i][j][k], "put_hevc_%s_bi_w_%s%d_%d",
+                                t->name, dir_names[j][k], size, bit_depth))
+                    continue;
+
+                randomize_buffers(src0, src1, SRC_SIZE);
+                randomize_src2(src2, MAX_PB_SIZE * MAX_PB_SIZE);
+                memset(dst0, 0, DST_SIZE);
+                memset(dst1, 0, DST_SIZE);
+                call_ref(dst0, dststride, src0 + SRC_OFFSET, srcstride, src2, size,
+                         denom, wx0, wx1, ox0, ox1, mx, my, size);
+                call_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, src2, size,
+                         denom, wx0, wx1, ox0, ox1, mx, my, size);
+                if (memcmp(dst0, dst1, DST_SIZE))
+                    fail();
+                bench_new(dst1, dststride, src1 + SRC_OFFSET, srcstride, src2, size,
+                          denom, wx0, wx1, ox0, ox1, mx, my, size);
+            }
+        }
+    }
+}
+
+void checkasm_check_hevc_pel(void)
+{
+    int bit_depth, pel;
+
+    for (pel = 0; pel < 2; pel++) {
+        for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+            HEVCDSPContext h;
+            PelTables t;
+
+            ff_hevc_dsp_init(&h, bit_depth);
+            if (!pel) {
+                t = (PelTables){ "qpel", 3, h.put_hevc_qpel, h.put_hevc_qpel_uni,
+                                 h.put_hevc_qpel_uni_w, h.put_hevc_qpel_bi,
+                                 h.put_hevc_qpel_bi_w };
+            } else {
+                t = (PelTables){ "epel", 7, h.put_hevc_epel, h.put_hevc_epel_uni,
+                                 h.put_hevc_epel_uni_w, h.put_hevc_epel_bi,
+                                 h.put_hevc_epel_bi_w };
+            }
+            check_put(&t, bit_depth);
+            check_uni(&t, bit_depth);
+            check_uni_w(&t, bit_depth);
+            check_bi(&t, bit_depth);
+            check_bi_w(&t, bit_depth);
+        }
+        report(pel ? "epel" : "qpel");
+    }
+}
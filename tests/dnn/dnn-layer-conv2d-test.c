@@ -21,9 +21,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include "libavutil/lfg.h"
+#include "libavutil/time.h"
 #include "libavfilter/dnn/dnn_backend_native_layer_conv2d.h"
 
 #define EPSON 0.00001
+#define CLAMP_TO_EDGE(x, w) ((x) < 0 ? 0 : ((x) >= (w) ? (w - 1) : (x)))
 
 static int test_with_same_dilate(void)
 {
@@ -114,7 +117,7 @@ static int test_with_same_dilate(void)
     operands[1].data = NULL;
 
     input_indexes[0] = 0;
-    dnn_execute_layer_conv2d(operands, input_indexes, 1, &params);
+    dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, NULL);
 
     output = operands[1].data;
     for (int i = 0; i < sizeof(expected_output) / sizeof(float); i++) {
@@ -214,7 +217,7 @@ static int test_with_valid(void)
     operands[1].data = NULL;
 
     input_indexes[0] = 0;
-    dnn_execute_layer_conv2d(operands, input_indexes, 1, &params);
+    dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, NULL);
 
     output = operands[1].data;
     for (int i = 0; i < sizeof(expected_output) / sizeof(float); i++) {
@@ -229,12 +232,189 @@ static int test_with_valid(void)
     return 0;
 }
 
+/* direct convolution, one output value at a time, as a reference */
+static void conv2d_ref(float *output, const float *input, int height, int width,
+                       const ConvolutionalParams *conv_params)
+{
+    int radius = conv_params->kernel_size >> 1;
+    int src_linesize = width * conv_params->input_num;
+    int filter_linesize = conv_params->kernel_size * conv_params->input_num;
+    int filter_size = conv_params->kernel_size * filter_linesize;
+    int pad_size = (conv_params->padding_method == VALID) ? (conv_params->kernel_size - 1) / 2 * conv_params->dilation : 0;
+
+    for (int y = pad_size; y < height - pad_size; ++y) {
+        for (int x = pad_size; x < width - pad_size; ++x) {
+            for (int n_filter = 0; n_filter < conv_params->output_num; ++n_filter) {
+                float sum = conv_params->has_bias ? conv_params->biases[n_filter] : 0.f;
+
+                for (int ch = 0; ch < conv_params->input_num; ++ch) {
+                    for (int kernel_y = 0; kernel_y < conv_params->kernel_size; ++kernel_y) {
+                        for (int kernel_x = 0; kernel_x < conv_params->kernel_size; ++kernel_x) {
+                            int y_pos = y + (kernel_y - radius) * conv_params->dilation;
+                            int x_pos = x + (kernel_x - radius) * conv_params->dilation;
+                            float input_pel;
+
+                            if (conv_params->padding_method == SAME_CLAMP_TO_EDGE) {
+                                y_pos = CLAMP_TO_EDGE(y_pos, height);
+                                x_pos = CLAMP_TO_EDGE(x_pos, width);
+                            }
+                            input_pel = (x_pos < 0 || x_pos >= width || y_pos < 0 || y_pos >= height) ? 0.0 :
+                                        input[y_pos * src_linesize + x_pos * conv_params->input_num + ch];
+                            sum += input_pel * conv_params->kernel[n_filter * filter_size + kernel_y * filter_linesize +
+                                                                   kernel_x * conv_params->input_num + ch];
+                        }
+                    }
+                }
+                switch (conv_params->activation) {
+                case RELU:       sum = FFMAX(sum, 0.0); break;
+                case TANH:       sum = 2.0f  / (1.0f + exp(-2.0f * sum)) - 1.0f; break;
+                case SIGMOID:    sum = 1.0f / (1.0f + exp(-sum)); break;
+                case LEAKY_RELU: sum = FFMAX(sum, 0.0) + 0.2 * FFMIN(sum, 0.0); break;
+                case NONE:       break;
+                }
+                *output++ = sum;
+            }
+        }
+    }
+}
+
+static const struct {
+    int height, width, input_num, output_num, kernel_size, dilation;
+    DNNConvPaddingParam padding_method;
+    DNNActivationFunc activation;
+    int has_bias;
+} random_tests[] = {
+    { 17, 23,  3,  5, 3, 1, SAME,               RELU,       1 },
+    { 16, 70,  1, 64, 5, 1, SAME,               TANH,       1 },
+    { 12,  9, 64, 32, 3, 1, SAME,               TANH,       1 },
+    {  9, 13, 32,  4, 3, 1, SAME_CLAMP_TO_EDGE, SIGMOID,    1 },
+    { 20, 21,  1, 64, 9, 1, VALID,              RELU,       1 },
+    { 11, 10, 64, 32, 1, 1, VALID,              RELU,       0 },
+    { 14, 15, 32,  1, 5, 2, SAME,               NONE,       1 },
+    {  8,  7,  3,  9, 3, 3, SAME_CLAMP_TO_EDGE, LEAKY_RELU, 0 },
+};
+
+/* layers of the espcn and srcnn models, for the benchmark */
+static const struct {
+    const char *name;
+    int input_num, output_num, kernel_size;
+    DNNActivationFunc activation;
+} bench_layers[] = {
+    { "espcn conv1", 1,  64, 5, TANH    },
+    { "espcn conv2", 64, 32, 3, TANH    },
+    { "espcn conv3", 32,  4, 3, SIGMOID },
+    { "srcnn conv1", 1,  64, 9, RELU    },
+    { "srcnn conv2", 64, 32, 1, RELU    },
+    { "srcnn conv3", 32,  1, 5, NONE    },
+};
+
+static float *random_floats(AVLFG *lfg, int nb)
+{
+    float *data = av_malloc_array(nb, sizeof(*data));
+
+    for (int i = 0; data && i < nb; i++)
+        data[i] = av_lfg_get(lfg) / (float)UINT32_MAX - 0.5f;
+    return data;
+}
+
+/* run the layer on random data and compare it with the direct convolution */
+static int test_random(AVLFG *lfg, ConvolutionalParams *params, int height, int width,
+                       int bench, const char *name)
+{
+    DnnOperand operands[2] = { { { 0 } } };
+    int32_t input_indexes[1] = { 0 };
+    int nb_out, ret = 0;
+    float *input, *ref;
+
+    params->kernel = random_floats(lfg, params->output_num * params->kernel_size *
+                                        params->kernel_size * params->input_num);
+    params->biases = random_floats(lfg, params->output_num);
+    input = random_floats(lfg, height * width * params->input_num);
+    ref = av_malloc_array(height * width, params->output_num * sizeof(*ref));
+    if (!params->kernel || !params->biases || !input || !ref) {
+        ret = 1;
+        goto end;
+    }
+
+    operands[0].data = input;
+    operands[0].dims[0] = 1;
+    operands[0].dims[1] = height;
+    operands[0].dims[2] = width;
+    operands[0].dims[3] = params->input_num;
+
+    if (dnn_execute_layer_conv2d(operands, input_indexes, 1, params, NULL)) {
+        ret = 1;
+        goto end;
+    }
+    conv2d_ref(ref, input, height, width, params);
+
+    nb_out = operands[1].dims[1] * operands[1].dims[2] * operands[1].dims[3];
+    for (int i = 0; i < nb_out; i++) {
+        float output = ((float *)operands[1].data)[i];
+        if (fabs(output - ref[i]) > EPSON * 10 * FFMAX(1, fabs(ref[i]))) {
+            printf("%dx%d %d->%d k%d: at index %d, output: %f, expected_output: %f\n",
+                   width, height, params->input_num, params->output_num,
+                   params->kernel_size, i, output, ref[i]);
+            ret = 1;
+            goto end;
+        }
+    }
+
+    if (bench) {
+        int64_t t0 = av_gettime_relative(), t1, t2;
+        dnn_execute_layer_conv2d(operands, input_indexes, 1, params, NULL);
+        t1 = av_gettime_relative();
+        conv2d_ref(ref, input, height, width, params);
+        t2 = av_gettime_relative();
+        printf("%s %dx%d: %7.1f ms, direct %7.1f ms\n", name, width, height,
+               (t1 - t0) / 1000.0, (t2 - t1) / 1000.0);
+    }
+
+end:
+    av_freep(&params->kernel);
+    av_freep(&params->biases);
+    av_freep(&operands[1].data);
+    av_free(input);
+    av_free(ref);
+    return ret;
+}
+
 int main(int argc, char **argv)
 {
+    ConvolutionalParams params = { 0 };
+    AVLFG lfg;
+
     if (test_with_valid())
         return 1;
     if (test_with_same_dilate())
         return 1;
 
+    av_lfg_init(&lfg, 0xdeadbeef);
+    for (int i = 0; i < FF_ARRAY_ELEMS(random_tests); i++) {
+        params.input_num      = random_tests[i].input_num;
+        params.output_num     = random_tests[i].output_num;
+        params.kernel_size    = random_tests[i].kernel_size;
+        params.dilation       = random_tests[i].dilation;
+        params.padding_method = random_tests[i].padding_method;
+        params.activation     = random_tests[i].activation;
+        params.has_bias       = random_tests[i].has_bias;
+        if (test_random(&lfg, &params, random_tests[i].height, random_tests[i].width, 0, NULL))
+            return 1;
+    }
+
+    if (argc > 1 && !strcmp(argv[1], "-b")) {
+        for (int i = 0; i < FF_ARRAY_ELEMS(bench_layers); i++) {
+            params.input_num      = bench_layers[i].input_num;
+            params.output_num     = bench_layers[i].output_num;
+            params.kernel_size    = bench_layers[i].kernel_size;
+            params.dilation       = 1;
+            params.padding_method = SAME;
+            params.activation     = bench_layers[i].activation;
+            params.has_bias       = 1;
+            if (test_random(&lfg, &params, 360, 640, 1, bench_layers[i].name))
+                return 1;
+        }
+    }
+
     return 0;
 }
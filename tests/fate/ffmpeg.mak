@@ -41,6 +41,10 @@ fate-ffmpeg-filter_colorkey: CMD = framecrc -idct simple -fflags +bitexact -flag
 FATE_FFMPEG-$(CONFIG_COLOR_FILTER) += fate-ffmpeg-lavfi
 fate-ffmpeg-lavfi: CMD = framecrc -lavfi color=d=1:r=5 -fflags +bitexact
 
+# same output as without the pipeline options
+FATE_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER SINE_FILTER HFLIP_FILTER VOLUME_FILTER MPEG4_ENCODER MP2_ENCODER) += fate-ffmpeg-pipeline
+fate-ffmpeg-pipeline: CMD = framecrc -pipeline_decode -pipeline_filter -pipeline_encode -f lavfi -i testsrc=s=160x120:r=25:d=2 -f lavfi -i sine=d=2 -vf hflip -af volume=0.5 -sws_flags +accurate_rnd+bitexact -c:v mpeg4 -c:a mp2 -flags +bitexact -dct fastint -idct simple -fflags +bitexact
+
 FATE_SAMPLES_FFMPEG-$(CONFIG_RAWVIDEO_DEMUXER) += fate-force_key_frames
 fate-force_key_frames: tests/data/vsynth_lena.yuv
 fate-force_key_frames: CMD = enc_dec \
@@ -60,6 +60,10 @@ FATE_LIBAVCODEC-$(CONFIG_IIRFILTER) += fate-iirfilter
 fate-iirfilter: libavcodec/tests/iirfilter$(EXESUF)
 fate-iirfilter: CMD = run libavcodec/tests/iirfilter$(EXESUF)
 
+FATE_LIBAVCODEC-$(CONFIG_GIF_ENCODER) += fate-lzwenc
+fate-lzwenc: libavcodec/tests/lzwenc$(EXESUF)
+fate-lzwenc: CMD = run libavcodec/tests/lzwenc$(EXESUF)
+
 FATE_LIBAVCODEC-$(CONFIG_MPEGVIDEO) += fate-mpeg12framerate
 fate-mpeg12framerate: libavcodec/tests/mpeg12framerate$(EXESUF)
 fate-mpeg12framerate: CMD = run libavcodec/tests/mpeg12framerate$(EXESUF)
@@ -124,3 +124,12 @@ fate-mov-faststart-4gb-overflow: CMP = oneline
 fate-mov-faststart-4gb-overflow: REF = bc875921f151871e787c4b4023269b29
 
 fate-mov-mp4-with-mov-in24-ver: CMD = run ffprobe$(PROGSSUF)$(EXESUF) -show_entries stream=codec_name -select_streams 1 $(TARGET_SAMPLES)/mov/mp4-with-mov-in24-ver.mp4
+
+# The md5 protocol cannot seek, and the moov is larger than the I/O buffer.
+# The output must be the same as with +faststart.
+FATE_MOV_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER MPEG4_ENCODER MP4_MUXER MD5_PROTOCOL) += fate-mov-faststart-buffered-pipe
+fate-mov-faststart-buffered-pipe: CMD = md5pipe -f lavfi -i testsrc=s=32x32:r=100:d=100 -sws_flags +accurate_rnd+bitexact -c:v mpeg4 -threads 1 -flags +bitexact -dct fastint -idct simple -fflags +bitexact -movflags +faststart_buffered -f mp4
+fate-mov-faststart-buffered-pipe: CMP = oneline
+fate-mov-faststart-buffered-pipe: REF = 9a9df52f4bd4c2dd46841fec44697b52
+
+FATE_FFMPEG += $(FATE_MOV_FFMPEG-yes)
@@ -25,11 +25,12 @@ FLAGS=(
   fftools/ffmpeg_opt.c fftools/ffmpeg_filter.c fftools/ffmpeg_hw.c fftools/cmdutils.c fftools/ffmpeg.c
   -s USE_SDL=2                                  # use SDL2
   -s INVOKE_RUN=0                               # not to run the main() in the beginning
-  -s EXIT_RUNTIME=1                             # exit runtime after execution
+  -s EXIT_RUNTIME=0                             # keep the runtime alive between ffmpeg_exec() calls
   -s MODULARIZE=1                               # use modularized version to be more flexible
   -s EXPORT_NAME="createFFmpegCore"             # assign export name for browser
-  -s EXPORTED_FUNCTIONS="[_main]"  # export main and proxy_main funcs
-  -s EXPORTED_RUNTIME_METHODS="[FS, cwrap, ccall, setValue, writeAsciiToMemory]"   # export preamble funcs
+  -s EXPORTED_FUNCTIONS="[_main, _ffmpeg_exec, _avio_register_callbacks, _ffmpeg_set_progress_callback]"  # export main, the re-entrant ffmpeg_exec, streaming I/O registration and progress reporting
+  -s EXPORTED_RUNTIME_METHODS="[FS, cwrap, ccall, setValue, writeAsciiToMemory, addFunction]"   # export preamble funcs
+  -s ALLOW_TABLE_GROWTH=1                       # allow addFunction() for callback: protocol I/O
   -s INITIAL_MEMORY=2146435072                  # 64 KB * 1024 * 16 * 2047 = 2146435072 bytes ~= 2 GB
   --pre-js wasm/src/pre.js
   --post-js wasm/src/post.js
@@ -9,6 +9,16 @@ if [[ "$FFMPEG_ST" == "yes" ]]; then
   EXTRA_CONF_FLAGS="--disable-multithread"
 fi
 
+# libvpx has no WebAssembly target, so its SIMD code paths are only
+# reached through the compiler: let it vectorize the generic C kernels
+# (DCT, quantizer, SAD/variance, loop filter) to 128-bit SIMD.
+VPX_CFLAGS="$CFLAGS"
+VPX_CXXFLAGS="$CXXFLAGS"
+if [[ "$FFMPEG_SIMD" == "yes" ]]; then
+  VPX_CFLAGS="$VPX_CFLAGS -msimd128"
+  VPX_CXXFLAGS="$VPX_CXXFLAGS -msimd128"
+fi
+
 CONF_FLAGS=(
   --prefix=$BUILD_DIR                                # install library in a build directory for FFmpeg to include
   --target=generic-gnu                               # target with miminal features
@@ -18,8 +28,8 @@ CONF_FLAGS=(
   --disable-docs                                     # not to build docs
   --disable-unit-tests                               # not to do unit tests
   --disable-dependency-tracking                      # speed up one-time build
-  --extra-cflags="$CFLAGS"                           # flags to use pthread and code optimization
-  --extra-cxxflags="$CXXFLAGS"                       # flags to use pthread and code optimization
+  --extra-cflags="$VPX_CFLAGS"                       # flags to use pthread, SIMD and code optimization
+  --extra-cxxflags="$VPX_CXXFLAGS"                   # flags to use pthread, SIMD and code optimization
   ${EXTRA_CONF_FLAGS-}
 )
 echo "CONF_FLAGS=${CONF_FLAGS[@]}"
@@ -39,11 +39,21 @@ fi
 CFLAGS_BASE="$OPTIM_FLAGS -I$BUILD_DIR/include"
 CFLAGS="$CFLAGS_BASE -s USE_PTHREADS=1"
 
+EXTRA_FFMPEG_CONF_FLAGS=""
+
 if [[ "$FFMPEG_ST" == "yes" ]]; then
   CFLAGS="$CFLAGS_BASE"
   EXTRA_FFMPEG_CONF_FLAGS="--disable-pthreads --disable-w32threads --disable-os2threads"
 fi
 
+# if no, we are building without WebAssembly SIMD, for
+# engines lacking support for it.
+FFMPEG_SIMD=${FFMPEG_SIMD:-yes}
+
+if [[ "$FFMPEG_SIMD" == "no" ]]; then
+  EXTRA_FFMPEG_CONF_FLAGS="$EXTRA_FFMPEG_CONF_FLAGS --disable-simd128"
+fi
+
 export CFLAGS=$CFLAGS
 export CXXFLAGS=$CFLAGS
 export LDFLAGS="$CFLAGS -L$BUILD_DIR/lib"
@@ -52,9 +62,8 @@ export EM_PKG_CONFIG_PATH=$EM_PKG_CONFIG_PATH
 
 FFMPEG_CONFIG_FLAGS_BASE=(
   --target-os=none        # use none to prevent any os specific configurations
-  --arch=x86_32           # use x86_32 to achieve minimal architectural optimization
+  --arch=wasm32           # wasm has native 64-bit integers and fast unaligned access
   --enable-cross-compile  # enable cross compile
-  --disable-x86asm        # disable x86 asm
   --disable-inline-asm    # disable inline asm
   --disable-stripping     # disable stripping
   --disable-programs      # disable programs build (incl. ffplay, ffprobe & ffmpeg)